@@ -0,0 +1,31 @@
+#ifndef BENCHMARK_NETWORKS_H
+#define BENCHMARK_NETWORKS_H
+
+#include "RoutingTable.h"
+#include "RandomStream.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Shared by the network benchmarks: a sparse random network in which every
+// node has the same number of random successors.
+inline constexpr int successors = 5;
+inline constexpr double stayProbability = 0.16;  // Per successor; each row exits with 0.2.
+
+// Routing of nodeCount nodes with successors random successors each.
+inline std::vector<RoutingEntry> randomRouting(int nodeCount, std::uint64_t seed) {
+    RandomStream rng(seed);
+    std::vector<RoutingEntry> entries;
+    entries.reserve(static_cast<std::size_t>(nodeCount) * successors);
+    for (int node = 0; node < nodeCount; node++) {
+        for (int k = 0; k < successors; k++)
+            entries.push_back({ node, static_cast<int>(rng() % nodeCount), stayProbability });
+    }
+    return entries;
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+#endif // BENCHMARK_NETWORKS_H
@@ -1,4 +1,5 @@
 #include "CANQueue.h" 
+#include "Checkpoint.h"
 #include <limits> 
 #include <iostream> // Optional: for logging (can be removed if not desired)
 
@@ -6,7 +7,7 @@
 static const double forwardDelay = 0.01;
 
 CANQueue::CANQueue(Simulation& sim, double arrivalRate, double serviceRate, int servers, int capacity)
-	: MMSQueue(sim, arrivalRate, serviceRate, servers), maxCapacity(capacity), blocked(false), downstream(nullptr) 
+	: MMSQueue(sim, arrivalRate, serviceRate, servers), maxCapacity(capacity), blocked(false), heldCustomers(0), downstream(nullptr), totalRejections(0) 
 { 
 	// Note: The base class MMSQueue initializes metrics and distributions. 
 }
@@ -17,6 +18,11 @@ bool CANQueue::isFull() const
 	return (this->getState() >= maxCapacity); 
 }
 
+EventHandle CANQueue::scheduleForwardAttempt(Simulation& sim, double time)
+{
+	return sim.scheduleEvent(time, StaticQueueEvent{ QueueEventType::ForwardAttempt, 0, getDispatchRef() });
+}
+
 void CANQueue::setDownstream(CANQueue* downstreamQueue) 
 { 
 	downstream = downstreamQueue; 
@@ -29,23 +35,174 @@ void CANQueue::handleExternalArrival(Simulation& sim)
 	if (this->getState() >= maxCapacity) {
 		// (Optional logging:)
 		// std::cout << "External arrival rejected at time " << currentTime << " (queue full)." << std::endl; 
+		totalRejections++;
+	}
+	else {
+		updateMetrics(currentTime);
+		totalArrivals++;
+		numInSystem++;
+		stateChanged(currentTime);
+		if (customers)
+			customers->arrive(currentTime);
+
+		// Only start new service if the queue is not blocked.
+		if (!blocked && busyServers < servers) {
+			startService(sim, currentTime);
+			if (aggregateDepartures)
+				updateAggregateDeparture(currentTime);
+		}
+	}
+
+	// Schedule the next external arrival (even if this arrival was rejected, new arrivals may come later).
+	double nextArrivalTime = currentTime + getNextInterarrivalTime();
+	if (std::isfinite(nextArrivalTime)) {
+		scheduleExternalArrival(sim, nextArrivalTime);
+	}
+}
+
+void CANQueue::handleInternalArrival(Simulation& sim)
+{
+	double currentTime = sim.getCurrentTime();
+	// Reject arrival if capacity is reached.
+	if (this->getState() >= maxCapacity) {
+		totalRejections++;
 		return;
 	}
 
 	updateMetrics(currentTime);
 	totalArrivals++;
 	numInSystem++;
+	stateChanged(currentTime);
+	if (customers)
+		customers->arrive(currentTime);
 
-	// Only start new service if the queue is not blocked.
+	// For an internal (routed) arrival, do not schedule the next external arrival.
 	if (!blocked && busyServers < servers) {
-		busyServers++;
-		double departureTime = currentTime + serviceDist(rng);
-		sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+		startService(sim, currentTime);
+		if (aggregateDepartures)
+			updateAggregateDeparture(currentTime);
 	}
+}
 
-	// Schedule the next external arrival (even if this arrival was rejected, new arrivals may come later).
-	double nextArrivalTime = currentTime + getNextInterarrivalTime();
-	if (std::isfinite(nextArrivalTime)) {
-		sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(nextArrivalTime, this));
+void CANQueue::handleDeparture(Simulation& sim)
+{
+	double currentTime = sim.getCurrentTime();
+	if (aggregateDepartures)
+		takeAggregateDeparture();
+
+	// Hold the finished customer (and its server) if the downstream queue is full.
+	if (downstream != nullptr && downstream->isFull()) {
+		heldCustomers++;
+		blocked = true;
+		if (customers) {
+			heldLine.pushBack(departingCustomer);
+			departingCustomer = CustomerTracker::noCustomer;
+		}
+		scheduleForwardAttempt(sim, currentTime + forwardDelay);
+		if (aggregateDepartures)
+			updateAggregateDeparture(currentTime);
+		return;
 	}
+
+	updateMetrics(currentTime);
+	totalDepartures++;
+	numInSystem--;
+	stateChanged(currentTime);
+	if (customers) {
+		customers->depart(departingCustomer, currentTime);
+		departingCustomer = CustomerTracker::noCustomer;
+	}
+	if (busyServers > 0) {
+		busyServers--;
+	}
+
+	if (downstream != nullptr) {
+		downstream->scheduleInternalArrival(sim, currentTime + forwardDelay);
+	}
+
+	// Start service for a waiting customer if a server is idle.
+	if (!blocked && numInSystem > busyServers && busyServers < servers) {
+		startService(sim, currentTime);
+	}
+	if (aggregateDepartures)
+		updateAggregateDeparture(currentTime);
+}
+
+void CANQueue::attemptForward(Simulation& sim)
+{
+	if (heldCustomers == 0) {
+		return;
+	}
+
+	double currentTime = sim.getCurrentTime();
+	if (downstream != nullptr && downstream->isFull()) {
+		// Still no room downstream; try again later.
+		scheduleForwardAttempt(sim, currentTime + forwardDelay);
+		return;
+	}
+
+	// Release one held customer; service resumes once nobody is held.
+	heldCustomers--;
+	blocked = (heldCustomers > 0);
+	updateMetrics(currentTime);
+	totalDepartures++;
+	numInSystem--;
+	stateChanged(currentTime);
+	if (customers)
+		customers->depart(heldLine.empty() ? CustomerTracker::noCustomer : heldLine.popFront(), currentTime);
+	if (busyServers > 0) {
+		busyServers--;
+	}
+
+	if (downstream != nullptr) {
+		downstream->scheduleInternalArrival(sim, currentTime + forwardDelay);
+	}
+
+	while (!blocked && numInSystem > busyServers && busyServers < servers) {
+		startService(sim, currentTime);
+	}
+	if (aggregateDepartures)
+		updateAggregateDeparture(currentTime);
+}
+
+int CANQueue::getTotalRejections() const
+{
+	return totalRejections;
+}
+
+void CANQueue::resetStatistics(double time)
+{
+	MMSQueue::resetStatistics(time);
+	totalRejections = 0;
+}
+
+void CANQueue::saveState(CheckpointWriter& out) const
+{
+	MMSQueue::saveState(out);
+	out.write(blocked);
+	out.write(heldCustomers);
+	out.write(totalRejections);
+}
+
+void CANQueue::restoreState(CheckpointReader& in)
+{
+	MMSQueue::restoreState(in);
+	blocked = in.read<bool>();
+	heldCustomers = in.read<int>();
+	totalRejections = in.read<int>();
+	if (customers)
+		trackUnknownCustomers();  // Again, now that heldCustomers is known.
+}
+
+bool CANQueue::acceptsEvent(QueueEventType type, int server) const
+{
+	return type == QueueEventType::ForwardAttempt || MMSQueue::acceptsEvent(type, server);
+}
+
+void CANQueue::trackUnknownCustomers()
+{
+	MMSQueue::trackUnknownCustomers();
+	heldLine.clear();
+	for (int i = 0; i < heldCustomers; i++)
+		heldLine.pushBack(customers->unknownInService());
 }
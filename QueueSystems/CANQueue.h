@@ -24,16 +24,58 @@ public: // Constructor: takes the simulation engine, arrival rate, service rate,
 	// This method should be called (or scheduled) when it is believed that the downstream queue may have freed space.
 	void attemptForward(Simulation& sim);
 
+	// Schedule a call to attemptForward.
+	EventHandle scheduleForwardAttempt(Simulation& sim, double time);
+
 	// Set (or change) the downstream queue pointer.
 	void setDownstream(CANQueue* downstreamQueue);
 
 	// Return true if this queue is full (i.e. state has reached maxCapacity).
 	bool isFull() const;
 
+	int getCapacity() const { return maxCapacity; }
+
+	// Arrivals (external and routed) turned away because the queue was full,
+	// since the last statistics reset.
+	int getTotalRejections() const;
+
+	// Also restarts the rejection count.
+	virtual void resetStatistics(double time) override;
+
+	// Checkpointing. The downstream link is part of the model's structure and is not saved.
+	virtual void saveState(CheckpointWriter& out) const override;
+	virtual void restoreState(CheckpointReader& in) override;
+	// Also accepts forward attempts.
+	virtual bool acceptsEvent(QueueEventType type, int server) const override;
+
+	// With customer tracking enabled, a customer's sojourn time runs until it
+	// is forwarded, so it includes the time spent held. Rejected arrivals are
+	// not tracked.
+
 	// (Inherited getState() returns the number of customers in the system.)
 private:
 	int maxCapacity; // Maximum number of customers the queue can hold. 
 	bool blocked; // True if a finished customer is currently held waiting for the downstream queue. 
+	int heldCustomers; // Number of finished customers held (each keeps its server busy). 
 	CANQueue* downstream; // Pointer to the downstream queue; may be nullptr if not set. };
+	RingQueue<CustomerTracker::Id> heldLine; // Tracked held customers, in the order they finished.
+	int totalRejections; // Arrivals rejected because the queue was full.
+
+protected:
+	virtual void trackUnknownCustomers() override;
+	// Servers holding a blocked customer are not serving.
+	virtual int servingServers() const override { return busyServers - heldCustomers; }
 };
+
+// Retries forwarding a held customer once the forwarding delay has elapsed.
+class ForwardAttemptEvent : public Event {
+public:
+	CANQueue* queue;
+	ForwardAttemptEvent(double time, CANQueue* q) : Event(time), queue(q) {}
+
+	virtual void process(Simulation& sim) override {
+		queue->attemptForward(sim);
+	}
+};
+
 #endif // CAN_QUEUE_H
\ No newline at end of file
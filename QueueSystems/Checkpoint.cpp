@@ -0,0 +1,255 @@
+#include "Checkpoint.h"
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "DD1Queue.h"
+#include "CANQueue.h"
+#include "JacksonNetwork.h"
+#include "CompactJacksonNetwork.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <unordered_map>
+#include <array>
+#include <algorithm>
+
+namespace {
+    const char checkpointMagic[8] = { 'Q', 'S', 'C', 'H', 'K', 'P', 'T', '\0' };
+    const std::uint32_t checkpointVersion = 8;
+
+    enum EntryKind : std::uint8_t { ModelEntry, NetworkEntry };
+
+    // A pending built-in queue event as stored in a checkpoint.
+    struct SavedEvent {
+        double time;
+        std::uint64_t sequence;
+        std::uint32_t model;   // Index into the registered models.
+        QueueEventType type;
+        int server;
+    };
+
+    // Events are written field by field: the struct has padding, which
+    // would otherwise put indeterminate bytes into the file.
+    void writeEvents(CheckpointWriter& out, const std::vector<SavedEvent>& events) {
+        out.write(static_cast<std::uint64_t>(events.size()));
+        for (const SavedEvent& event : events) {
+            out.write(event.time);
+            out.write(event.sequence);
+            out.write(event.model);
+            out.write(event.type);
+            out.write(event.server);
+        }
+    }
+
+    std::vector<SavedEvent> readEvents(CheckpointReader& in) {
+        std::uint64_t count = in.read<std::uint64_t>();
+        std::vector<SavedEvent> events;
+        for (std::uint64_t i = 0; i < count && in.good(); i++) {
+            SavedEvent event;
+            event.time = in.read<double>();
+            event.sequence = in.read<std::uint64_t>();
+            event.model = in.read<std::uint32_t>();
+            event.type = in.read<QueueEventType>();
+            event.server = in.read<int>();
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    QueueModel* baseOf(const QueueModelRef& ref) {
+        return std::visit([](auto* queue) -> QueueModel* { return queue; }, ref);
+    }
+
+    // Reject events the model could not process (e.g. a server index out of range).
+    bool validFor(const QueueModel* model, const SavedEvent& event) {
+        return model->acceptsEvent(event.type, event.server);
+    }
+}
+
+Checkpoint::Checkpoint() : skippedEvents(0) {}
+
+void Checkpoint::add(QueueModel& model) {
+    entries.push_back(Entry{ &model, nullptr });
+}
+
+void Checkpoint::add(JacksonNetwork& network) {
+    entries.push_back(Entry{ nullptr, &network });
+}
+
+std::vector<QueueModel*> Checkpoint::collectModels() const {
+    std::vector<QueueModel*> models;
+    for (const Entry& entry : entries) {
+        if (entry.model != nullptr) {
+            models.push_back(entry.model);
+            continue;
+        }
+        for (int node = 0; node < entry.network->getNodeCount(); node++) {
+            if (QueueModel* queue = entry.network->getNode(node))
+                models.push_back(queue);
+        }
+    }
+    return models;
+}
+
+std::vector<unsigned char> Checkpoint::saveToMemory(Simulation& sim) {
+    CheckpointWriter out;
+    out.write(checkpointMagic);
+    out.write(checkpointVersion);
+
+    out.write(sim.currentTime);
+    out.write(sim.eventsProcessed);
+    out.write(sim.nextSequence);
+    out.write(sim.randomStreams.getState());
+
+    out.write(static_cast<std::uint64_t>(entries.size()));
+    for (const Entry& entry : entries) {
+        if (entry.model != nullptr) {
+            out.write(ModelEntry);
+            entry.model->saveState(out);
+        }
+        else {
+            out.write(NetworkEntry);
+            entry.network->saveState(out);
+        }
+    }
+
+    std::unordered_map<const QueueModel*, std::uint32_t> modelIndex;
+    std::vector<QueueModel*> models = collectModels();
+    for (std::size_t i = 0; i < models.size(); i++)
+        modelIndex.emplace(models[i], static_cast<std::uint32_t>(i));
+
+    // Pending events in processing order, which is also a valid heap order.
+    std::vector<SavedEvent> events;
+    skippedEvents = 0;
+    std::visit([&](auto& eventSet) {
+        eventSet.forEach([&](const ScheduledEvent& entry) {
+            if (sim.eventPool.getSequence(entry.handle) != entry.sequence)
+                return;  // Left behind by a cancelled or rescheduled event.
+            // Queue events of either dispatch mode are saved alike.
+            StaticQueueEvent event;
+            if (sim.eventPool.holdsStatic(entry.handle))
+                event = sim.eventPool.getStatic(entry.handle);
+            else if (!describeQueueEvent(*sim.eventPool.get(entry.handle), event)) {
+                skippedEvents++;
+                return;
+            }
+            auto found = modelIndex.find(baseOf(event.queue));
+            if (found == modelIndex.end()) {
+                skippedEvents++;
+                return;
+            }
+            events.push_back(SavedEvent{ entry.eventTime, entry.sequence, found->second, event.type, event.server });
+        });
+    }, sim.eventQueue);
+    std::sort(events.begin(), events.end(), [](const SavedEvent& a, const SavedEvent& b) {
+        return a.time < b.time || (a.time == b.time && a.sequence < b.sequence);
+    });
+    writeEvents(out, events);
+
+    return out.getBuffer();
+}
+
+bool Checkpoint::save(Simulation& sim, const std::string& path) {
+    std::vector<unsigned char> bytes = saveToMemory(sim);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+bool Checkpoint::restore(Simulation& sim, const std::string& path) {
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+    return restore(sim, file.data(), file.size());
+}
+
+bool Checkpoint::restore(Simulation& sim, const unsigned char* data, std::size_t size) {
+    // Events are restored into an empty simulation only.
+    if (sim.getPendingEventCount() != 0 || data == nullptr)
+        return false;
+
+    CheckpointReader in(data, size);
+    auto magic = in.read<std::array<char, sizeof(checkpointMagic)>>();
+    if (!std::equal(magic.begin(), magic.end(), checkpointMagic) || in.read<std::uint32_t>() != checkpointVersion)
+        return false;
+
+    double currentTime = in.read<double>();
+    std::uint64_t eventsProcessed = in.read<std::uint64_t>();
+    std::uint64_t nextSequence = in.read<std::uint64_t>();
+    RandomStream::State streamState = in.read<RandomStream::State>();
+
+    if (!in.good() || in.read<std::uint64_t>() != entries.size())
+        return false;
+
+    // The models check their own state as they read it, so they are restored
+    // before the events are validated against them. Until everything has
+    // been accepted the simulation is left alone, and the models are put
+    // back from this snapshot if anything is rejected.
+    CheckpointWriter snapshot;
+    std::vector<bool> emptyNetworks;
+    for (const Entry& entry : entries) {
+        emptyNetworks.push_back(entry.network != nullptr && entry.network->getNodeCount() == 0);
+        if (entry.model != nullptr)
+            entry.model->saveState(snapshot);
+        else if (!emptyNetworks.back())
+            entry.network->saveState(snapshot);
+    }
+    RandomStream::State streamsBefore = sim.randomStreams.getState();  // Restored networks draw streams for new nodes.
+
+    std::vector<SavedEvent> events;
+    bool accepted = true;
+    for (const Entry& entry : entries) {
+        EntryKind kind = in.read<EntryKind>();
+        if (kind != (entry.model != nullptr ? ModelEntry : NetworkEntry)) {
+            accepted = false;
+            break;
+        }
+        if (entry.model != nullptr)
+            entry.model->restoreState(in);
+        else
+            entry.network->restoreState(in);
+        if (!in.good()) {
+            accepted = false;
+            break;
+        }
+    }
+    std::vector<QueueModel*> models = collectModels();
+    if (accepted) {
+        events = readEvents(in);
+        accepted = in.good();
+    }
+    for (std::size_t i = 0; accepted && i < events.size(); i++) {
+        const SavedEvent& event = events[i];
+        accepted = event.model < models.size() && event.sequence < nextSequence && validFor(models[event.model], event);
+    }
+    if (!accepted) {
+        CheckpointReader previous(snapshot.getBuffer().data(), snapshot.getBuffer().size());
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].model != nullptr)
+                entries[i].model->restoreState(previous);
+            else if (emptyNetworks[i])
+                entries[i].network->removeNodes();
+            else
+                entries[i].network->restoreState(previous);
+        }
+        sim.randomStreams.setState(streamsBefore);
+        return false;
+    }
+
+    sim.currentTime = currentTime;
+    sim.eventsProcessed = eventsProcessed;
+    sim.nextSequence = nextSequence;
+    sim.randomStreams.setState(streamState);
+    for (const SavedEvent& event : events) {
+        QueueModel* model = models[event.model];
+        StaticQueueEvent restored{ event.type, event.server, resolveQueueModelRef(model) };
+        EventHandle handle = sim.enqueue(event.time, sim.eventPool.createStatic(restored), event.sequence);
+        model->restoreEvent(restored, handle);
+    }
+    return true;
+}
+
+std::size_t Checkpoint::getSkippedEvents() const {
+    return skippedEvents;
+}
@@ -0,0 +1,155 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "RandomStream.h"
+#include "ExponentialVariates.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+class Simulation;
+class QueueModel;
+class JacksonNetwork;
+
+//----------------------------------------------------------------
+// CheckpointWriter: appends raw values to a byte buffer
+//----------------------------------------------------------------
+// Values are stored in the machine's native layout, so a checkpoint can
+// only be restored on the same kind of machine that wrote it.
+class CheckpointWriter {
+public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpointed values must be trivially copyable");
+        const unsigned char* raw = reinterpret_cast<const unsigned char*>(&value);
+        buffer.insert(buffer.end(), raw, raw + sizeof(T));
+    }
+
+    void write(const RandomStream& stream) { write(stream.getState()); }
+    void write(const ExponentialVariates& variates) { write(variates.getState()); }
+
+    template <typename T>
+    void writeVector(const std::vector<T>& values) {
+        write(static_cast<std::uint64_t>(values.size()));
+        for (const T& value : values)
+            write(value);
+    }
+
+    const std::vector<unsigned char>& getBuffer() const { return buffer; }
+
+private:
+    std::vector<unsigned char> buffer;
+};
+
+//----------------------------------------------------------------
+// CheckpointReader: reads values back from a (mapped) byte range
+//----------------------------------------------------------------
+// Reading past the end marks the reader as failed; later reads return
+// zero-initialized values, so callers only need to check good() once.
+class CheckpointReader {
+public:
+    CheckpointReader(const unsigned char* data, std::size_t size)
+        : data(data), size(size), offset(0), failed(false) {}
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "checkpointed values must be trivially copyable");
+        T value{};
+        if (failed || size - offset < sizeof(T)) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    void read(RandomStream& stream) { stream.setState(read<RandomStream::State>()); }
+    void read(ExponentialVariates& variates) { variates.setState(read<ExponentialVariates::State>()); }
+
+    template <typename T>
+    std::vector<T> readVector() {
+        std::uint64_t count = read<std::uint64_t>();
+        std::vector<T> values;
+        // A corrupt count cannot claim more elements than the bytes left.
+        if (failed || count > (size - offset) / sizeof(T)) {
+            failed = true;
+            return values;
+        }
+        values.reserve(static_cast<std::size_t>(count));
+        for (std::uint64_t i = 0; i < count; i++)
+            values.push_back(read<T>());
+        return values;
+    }
+
+    // Mark the checkpoint as unusable (e.g. it does not match the model).
+    void fail() { failed = true; }
+
+    bool good() const { return !failed; }
+
+private:
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t offset;
+    bool failed;
+};
+
+//----------------------------------------------------------------
+// Checkpoint: saves and restores a running simulation
+//----------------------------------------------------------------
+// A checkpoint holds the simulation clock, the pending events of the
+// built-in queue models and the state of every registered model (counters,
+// accumulators and random number streams; for a JacksonNetwork also the
+// nodes and the routing matrix). Model parameters such as rates are not
+// overwritten on restore, so a warmed-up state can be restored into a
+// variant of the model for a what-if experiment.
+//
+// To restore, create a fresh Simulation, build the same models (or, for a
+// JacksonNetwork, an empty network that the checkpoint fills in), register
+// them in the same order and call restore(). Do not call start(): the
+// pending arrivals come from the checkpoint.
+//
+// Other pending events (for example a MeasurementEvent) are not saved; see
+// getSkippedEvents(). Schedule them again after restoring.
+class Checkpoint {
+public:
+    Checkpoint();
+
+    // Register models in the order they are saved and restored.
+    void add(QueueModel& model);
+    void add(JacksonNetwork& network);
+
+    // Write a checkpoint file. Returns false if the file cannot be written.
+    bool save(Simulation& sim, const std::string& path);
+
+    // Serialize into memory.
+    std::vector<unsigned char> saveToMemory(Simulation& sim);
+
+    // Restore from a checkpoint file, which is memory-mapped. Returns false
+    // if the file is missing, corrupt or does not match the registered models;
+    // the simulation and the models are then left as they were (except that
+    // customers in tracked models have unknown times, as after a restore).
+    bool restore(Simulation& sim, const std::string& path);
+
+    // Restore from serialized bytes.
+    bool restore(Simulation& sim, const unsigned char* data, std::size_t size);
+
+    // Pending events left out of the last save because they do not belong to a built-in queue model.
+    std::size_t getSkippedEvents() const;
+
+private:
+    struct Entry {
+        QueueModel* model;
+        JacksonNetwork* network;
+    };
+
+    std::vector<Entry> entries;
+    std::size_t skippedEvents;
+
+    std::vector<QueueModel*> collectModels() const;
+};
+
+#endif // CHECKPOINT_H
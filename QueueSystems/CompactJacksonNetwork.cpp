@@ -0,0 +1,186 @@
+#include "CompactJacksonNetwork.h"
+#include "JacksonNetwork.h"
+#include "Checkpoint.h"
+#include <utility>
+#include <cmath>
+#include <limits>
+
+CompactJacksonNetwork::CompactJacksonNetwork(Simulation& sim)
+    : sim(sim), statisticsStart(0.0),
+    arrivalVariates(sim.nextRandomStream()), serviceVariates(sim.nextRandomStream()),
+    routingStream(sim.nextRandomStream())
+{
+}
+
+void CompactJacksonNetwork::reserve(int nodeCount) {
+    std::size_t n = static_cast<std::size_t>(nodeCount);
+    numInSystem.reserve(n);
+    busyServers.reserve(n);
+    servers.reserve(n);
+    arrivalMean.reserve(n);
+    serviceMean.reserve(n);
+    area.reserve(n);
+    lastEventTime.reserve(n);
+    totalArrivals.reserve(n);
+    totalDepartures.reserve(n);
+}
+
+int CompactJacksonNetwork::addMM1Queue(double arrivalRate, double serviceRate) {
+    return addMMSQueue(arrivalRate, serviceRate, 1);
+}
+
+int CompactJacksonNetwork::addMMSQueue(double arrivalRate, double serviceRate, int serverCount) {
+    int node = getNodeCount();
+    numInSystem.push_back(0);
+    busyServers.push_back(0);
+    servers.push_back(serverCount);
+    arrivalMean.push_back(arrivalRate > 0 ? 1.0 / arrivalRate : std::numeric_limits<double>::infinity());
+    serviceMean.push_back(1.0 / serviceRate);
+    area.push_back(0.0);
+    lastEventTime.push_back(sim.getCurrentTime());
+    totalArrivals.push_back(0);
+    totalDepartures.push_back(0);
+    return node;
+}
+
+void CompactJacksonNetwork::setRoutingMatrix(const std::vector<std::vector<double>>& matrix) {
+    routing = RoutingTable::fromDense(matrix);
+}
+
+void CompactJacksonNetwork::setRouting(const std::vector<RoutingEntry>& entries) {
+    routing = RoutingTable::fromEntries(getNodeCount(), entries);
+}
+
+void CompactJacksonNetwork::setRouting(RoutingTable table) {
+    routing = std::move(table);
+}
+
+EventHandle CompactJacksonNetwork::scheduleNodeEvent(QueueEventType type, int node, double time) {
+    return sim.scheduleEvent(time, StaticQueueEvent{ type, node, getDispatchRef() });
+}
+
+void CompactJacksonNetwork::start() {
+    double now = sim.getCurrentTime();
+    for (int node = 0; node < getNodeCount(); node++) {
+        if (std::isfinite(arrivalMean[node]))
+            scheduleNodeEvent(QueueEventType::ExternalArrival, node, now + arrivalVariates.next(arrivalMean[node]));
+    }
+}
+
+double CompactJacksonNetwork::getAverageNumberInSystem(int node) const {
+    double elapsed = lastEventTime[node] - statisticsStart;
+    return (elapsed > 0) ? area[node] / elapsed : 0.0;
+}
+
+double CompactJacksonNetwork::getArrivalRate(int node) const {
+    return std::isfinite(arrivalMean[node]) ? 1.0 / arrivalMean[node] : 0.0;
+}
+
+void CompactJacksonNetwork::resetStatistics(double time) {
+    for (int node = 0; node < getNodeCount(); node++) {
+        updateMetrics(node, time);
+        area[node] = 0.0;
+        totalArrivals[node] = 0;
+        totalDepartures[node] = 0;
+    }
+    statisticsStart = time;
+}
+
+void CompactJacksonNetwork::updateMetrics(int node, double currentTime) {
+    area[node] += numInSystem[node] * (currentTime - lastEventTime[node]);
+    lastEventTime[node] = currentTime;
+}
+
+void CompactJacksonNetwork::arrive(int node, double currentTime) {
+    updateMetrics(node, currentTime);
+    totalArrivals[node]++;
+    numInSystem[node]++;
+    if (busyServers[node] < servers[node]) {
+        busyServers[node]++;
+        scheduleNodeEvent(QueueEventType::Departure, node, currentTime + serviceVariates.next(serviceMean[node]));
+    }
+}
+
+void CompactJacksonNetwork::depart(int node, double currentTime) {
+    updateMetrics(node, currentTime);
+    totalDepartures[node]++;
+    numInSystem[node]--;
+    // The server takes the next waiting customer, if any.
+    if (numInSystem[node] >= busyServers[node])
+        scheduleNodeEvent(QueueEventType::Departure, node, currentTime + serviceVariates.next(serviceMean[node]));
+    else
+        busyServers[node]--;
+
+    if (node < routing.getRowCount()) {
+        int destination = routing.sample(node, routingStream.nextUniform());
+        if (destination >= 0 && destination < getNodeCount())
+            scheduleNodeEvent(QueueEventType::InternalArrival, destination, currentTime + epsilon);
+    }
+}
+
+void CompactJacksonNetwork::handleNodeEvent(Simulation& sim, QueueEventType type, int node) {
+    double currentTime = sim.getCurrentTime();
+    switch (type) {
+    case QueueEventType::ExternalArrival:
+        arrive(node, currentTime);
+        scheduleNodeEvent(QueueEventType::ExternalArrival, node, currentTime + arrivalVariates.next(arrivalMean[node]));
+        break;
+    case QueueEventType::InternalArrival:
+        arrive(node, currentTime);
+        break;
+    case QueueEventType::Departure:
+        depart(node, currentTime);
+        break;
+    default:
+        break;
+    }
+}
+
+void CompactJacksonNetwork::saveState(CheckpointWriter& out) const {
+    out.writeVector(numInSystem);
+    out.writeVector(busyServers);
+    out.writeVector(servers);
+    out.writeVector(arrivalMean);
+    out.writeVector(serviceMean);
+    out.writeVector(area);
+    out.writeVector(lastEventTime);
+    out.writeVector(totalArrivals);
+    out.writeVector(totalDepartures);
+    out.write(statisticsStart);
+    out.write(static_cast<std::uint64_t>(routing.getRowCount()));
+    out.writeVector(routing.getEntries());
+    out.write(arrivalVariates);
+    out.write(serviceVariates);
+    out.write(routingStream);
+}
+
+bool CompactJacksonNetwork::acceptsEvent(QueueEventType type, int node) const {
+    return node >= 0 && node < getNodeCount() && QueueModel::acceptsEvent(type, node);
+}
+
+void CompactJacksonNetwork::restoreState(CheckpointReader& in) {
+    numInSystem = in.readVector<std::int32_t>();
+    busyServers = in.readVector<std::int32_t>();
+    servers = in.readVector<std::int32_t>();
+    arrivalMean = in.readVector<double>();
+    serviceMean = in.readVector<double>();
+    area = in.readVector<double>();
+    lastEventTime = in.readVector<double>();
+    totalArrivals = in.readVector<std::uint32_t>();
+    totalDepartures = in.readVector<std::uint32_t>();
+    statisticsStart = in.read<double>();
+    std::uint64_t rows = in.read<std::uint64_t>();
+    std::vector<RoutingEntry> entries = in.readVector<RoutingEntry>();
+    in.read(arrivalVariates);
+    in.read(serviceVariates);
+    in.read(routingStream);
+
+    std::size_t n = numInSystem.size();
+    if (busyServers.size() != n || servers.size() != n || arrivalMean.size() != n || serviceMean.size() != n
+        || area.size() != n || lastEventTime.size() != n || totalArrivals.size() != n
+        || totalDepartures.size() != n || rows > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        in.fail();
+        return;
+    }
+    routing = RoutingTable(static_cast<int>(rows), entries);
+}
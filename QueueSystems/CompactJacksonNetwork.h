@@ -0,0 +1,122 @@
+#ifndef COMPACT_JACKSON_NETWORK_H
+#define COMPACT_JACKSON_NETWORK_H
+
+#include "Simulation.h"
+#include "QueueModel.h"
+#include "RoutingTable.h"
+#include "ExponentialVariates.h"
+#include <vector>
+#include <cstdint>
+
+// CompactJacksonNetwork simulates the same open network of M/M/1 and M/M/s
+// nodes as JacksonNetwork, with the node state stored as a structure of
+// arrays instead of one object per node. The network is a single
+// QueueModel; its events carry the node id in StaticQueueEvent::server.
+//
+// Each node's state (number in system, busy servers, servers, means,
+// time-weighted area, last event time and counters) takes 52 bytes in
+// contiguous arrays indexed by node id, so a million nodes need about
+// 50 MB plus the routing table, against well over a kilobyte per node for a
+// JacksonNetwork node object with its streams and variate buffers.
+//
+// What is given up for the size:
+// - All nodes share one stream of interarrival times, one of service times
+//   and one of routing draws, so runs with different configurations do not
+//   get per-node common random numbers.
+// - Nodes cannot be observed, tracked or have their servers changed.
+// Routed customers arrive after the same delay (epsilon) as in JacksonNetwork.
+class CompactJacksonNetwork : public QueueModel {
+public:
+    explicit CompactJacksonNetwork(Simulation& sim);
+
+    // Reserve room for the given number of nodes.
+    void reserve(int nodeCount);
+
+    // Add nodes; ids are numbered in order of addition.
+    int addMM1Queue(double arrivalRate, double serviceRate);
+    int addMMSQueue(double arrivalRate, double serviceRate, int servers);
+
+    // Same meaning as JacksonNetwork::setRoutingMatrix and both setRouting.
+    void setRoutingMatrix(const std::vector<std::vector<double>>& routingMatrix);
+    void setRouting(const std::vector<RoutingEntry>& entries);
+    void setRouting(RoutingTable table);
+    const RoutingTable& getRouting() const { return routing; }
+
+    // Schedule the first external arrival of every node.
+    void start();
+
+    int getNodeCount() const { return static_cast<int>(numInSystem.size()); }
+
+    // Per-node metrics, as for MMSQueue.
+    int getNumberInSystem(int node) const { return numInSystem[node]; }
+    double getAverageNumberInSystem(int node) const;
+    std::uint32_t getTotalArrivals(int node) const { return totalArrivals[node]; }
+    std::uint32_t getTotalDepartures(int node) const { return totalDepartures[node]; }
+    double getArrivalRate(int node) const;
+    double getServiceRate(int node) const { return 1.0 / serviceMean[node]; }
+    int getServers(int node) const { return servers[node]; }
+
+    // Restart every node's statistics at time; the state is kept.
+    void resetStatistics(double time);
+
+    // Bytes of per-node state (excluding the routing table).
+    static constexpr std::size_t bytesPerNode = 3 * sizeof(std::int32_t) + 4 * sizeof(double)
+        + 2 * sizeof(std::uint32_t);
+
+    // Process an event of one node. Called by the event dispatch.
+    void handleNodeEvent(Simulation& sim, QueueEventType type, int node);
+
+    // The QueueModel handlers have no node id; the network's events always
+    // go through handleNodeEvent.
+    virtual void handleExternalArrival(Simulation&) override {}
+    virtual void handleInternalArrival(Simulation&) override {}
+    virtual void handleDeparture(Simulation&) override {}
+
+    // Checkpointing: the node arrays, the routing entries and the streams.
+    // Restoring into an empty network creates the nodes.
+    virtual void saveState(CheckpointWriter& out) const override;
+    virtual void restoreState(CheckpointReader& in) override;
+    // The server field of an event holds the node index.
+    virtual bool acceptsEvent(QueueEventType type, int node) const override;
+
+private:
+    Simulation& sim;
+
+    // Per-node state, indexed by node id.
+    std::vector<std::int32_t> numInSystem;
+    std::vector<std::int32_t> busyServers;
+    std::vector<std::int32_t> servers;
+    std::vector<double> arrivalMean;  // Infinity for nodes without external arrivals.
+    std::vector<double> serviceMean;
+    std::vector<double> area;         // Time-weighted number in system since statisticsStart.
+    std::vector<double> lastEventTime;
+    std::vector<std::uint32_t> totalArrivals;
+    std::vector<std::uint32_t> totalDepartures;
+    double statisticsStart;
+
+    RoutingTable routing;
+    ExponentialVariates arrivalVariates;
+    ExponentialVariates serviceVariates;
+    RandomStream routingStream;
+
+    EventHandle scheduleNodeEvent(QueueEventType type, int node, double time);
+    void updateMetrics(int node, double currentTime);
+    void arrive(int node, double currentTime);
+    void depart(int node, double currentTime);
+};
+
+// Virtual-dispatch equivalent of a CompactJacksonNetwork event.
+class CompactNodeEvent : public Event {
+public:
+    CompactJacksonNetwork* network;
+    QueueEventType type;
+    int node;
+    CompactNodeEvent(double time, CompactJacksonNetwork* network, QueueEventType type, int node)
+        : Event(time), network(network), type(type), node(node) {}
+
+    virtual void process(Simulation& sim) override {
+        network->handleNodeEvent(sim, type, node);
+    }
+};
+
+#endif // COMPACT_JACKSON_NETWORK_H
@@ -0,0 +1,84 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "CompactJacksonNetwork.h"
+#include "ProductForm.h"
+#include "BenchmarkNetworks.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+namespace {
+    const double arrivalRate = 0.05, serviceRate = 1.0;
+    const double warmUp = 10.0;  // Statistics start after the network fills up.
+
+    // Build and run one backend; report build time, events per second and
+    // the mean over nodes of the average number in system.
+    template <typename Network>
+    void run(const char* label, int nodeCount, double endTime, const std::vector<RoutingEntry>& routing,
+        double analyticMean)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        Simulation sim(20241019);
+        Network network(sim);
+        for (int node = 0; node < nodeCount; node++)
+            network.addMM1Queue(arrivalRate, serviceRate);
+        network.setRouting(routing);
+        network.start();
+        double buildSeconds = secondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        sim.run(warmUp);
+        if constexpr (std::is_same<Network, CompactJacksonNetwork>::value) {
+            network.resetStatistics(warmUp);
+        }
+        else {
+            for (int node = 0; node < nodeCount; node++)
+                static_cast<MM1Queue*>(network.getNode(node))->resetStatistics(warmUp);
+        }
+        sim.run(endTime);
+        double runSeconds = secondsSince(begin);
+
+        double meanL = 0.0;
+        for (int node = 0; node < nodeCount; node++) {
+            if constexpr (std::is_same<Network, CompactJacksonNetwork>::value)
+                meanL += network.getAverageNumberInSystem(node);
+            else
+                meanL += static_cast<MM1Queue*>(network.getNode(node))->getAverageNumberInSystem();
+        }
+        meanL /= nodeCount;
+
+        std::cout << "  " << std::left << std::setw(16) << label << std::right
+                  << " build " << std::setw(7) << buildSeconds << " s, " << std::setw(9) << sim.getEventsProcessed()
+                  << " events at " << std::setw(6) << sim.getEventsProcessed() / runSeconds / 1.0e6
+                  << " M/s, mean L " << meanL << " (analytic " << analyticMean << ")\n";
+    }
+}
+
+int main() {
+    std::cout << std::setprecision(4);
+    std::cout << "Per-node state: JacksonMM1Queue object " << sizeof(JacksonMM1Queue)
+              << " bytes, JacksonMMSQueue object " << sizeof(JacksonMMSQueue)
+              << " bytes (plus heap vectors), CompactJacksonNetwork arrays "
+              << CompactJacksonNetwork::bytesPerNode << " bytes\n\n";
+
+    for (int nodeCount : { 10000, 100000, 1000000 }) {
+        std::vector<RoutingEntry> routing = randomRouting(nodeCount, 7);
+
+        std::vector<ProductFormNode> nodes(nodeCount, ProductFormNode{ arrivalRate, serviceRate, 1 });
+        NetworkSolution solution = solveProductForm(nodes, routing, epsilon);
+        double analyticMean = solution.averageNumberInNetwork / nodeCount;
+
+        double endTime = std::max(2.0e7 / nodeCount, 3.0 * warmUp);
+        std::cout << nodeCount << " nodes, " << routing.size() << " routes, T = " << endTime << ":\n";
+        if (nodeCount <= 100000)
+            run<JacksonNetwork>("JacksonNetwork", nodeCount, endTime, routing, analyticMean);
+        else
+            std::cout << "  JacksonNetwork   skipped (about " << double(nodeCount) * sizeof(JacksonMM1Queue) / 1.0e9
+                      << " GB of node objects)\n";
+        run<CompactJacksonNetwork>("Compact", nodeCount, endTime, routing, analyticMean);
+    }
+    return 0;
+}
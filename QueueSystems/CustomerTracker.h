@@ -0,0 +1,239 @@
+#ifndef CUSTOMER_TRACKER_H
+#define CUSTOMER_TRACKER_H
+
+#include "QuantileSketch.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <cmath>
+
+//----------------------------------------------------------------
+// RingQueue: first-in first-out queue in one growing array
+//----------------------------------------------------------------
+// Unlike std::deque it never gives memory back, so a queue that has
+// reached its working size no longer allocates.
+template <typename T>
+class RingQueue {
+public:
+    RingQueue() : head(0), count(0) {}
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    T& front() { return items[head]; }
+
+    void pushBack(const T& item) {
+        grow();
+        items[(head + count) & (items.size() - 1)] = item;
+        count++;
+    }
+
+    void pushFront(const T& item) {
+        grow();
+        head = (head + items.size() - 1) & (items.size() - 1);
+        items[head] = item;
+        count++;
+    }
+
+    T popFront() {
+        T item = items[head];
+        head = (head + 1) & (items.size() - 1);
+        count--;
+        return item;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<T> items;  // Size is zero or a power of two.
+    std::size_t head;
+    std::size_t count;
+
+    void grow() {
+        if (count < items.size())
+            return;
+        std::vector<T> larger(items.empty() ? 16 : items.size() * 2);
+        for (std::size_t i = 0; i < count; i++)
+            larger[i] = items[(head + i) & (items.size() - 1)];
+        items.swap(larger);
+        head = 0;
+    }
+};
+
+//----------------------------------------------------------------
+// CustomerPool: customer records as a structure of arrays
+//----------------------------------------------------------------
+// The record of a customer (see Old/Customer.cpp) is split into one array
+// per field and addressed by index. Records of departed customers go onto
+// a freelist and are reused, so the arrays only grow to the largest number
+// of customers that were present at the same time.
+class CustomerPool {
+public:
+    using Id = std::uint32_t;
+
+    static constexpr Id noCustomer = std::numeric_limits<Id>::max();
+
+    Id acquire(double arrivalTime, double originTime) {
+        Id id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+            arrivalTimes[id] = arrivalTime;
+            serviceStartTimes[id] = std::numeric_limits<double>::quiet_NaN();
+            originTimes[id] = originTime;
+        }
+        else {
+            id = static_cast<Id>(arrivalTimes.size());
+            arrivalTimes.push_back(arrivalTime);
+            serviceStartTimes.push_back(std::numeric_limits<double>::quiet_NaN());
+            originTimes.push_back(originTime);
+        }
+        return id;
+    }
+
+    void release(Id id) { freeIds.push_back(id); }
+
+    void clear() {
+        arrivalTimes.clear();
+        serviceStartTimes.clear();
+        originTimes.clear();
+        freeIds.clear();
+    }
+
+    // Time the customer arrived at this queue.
+    double& arrivalTime(Id id) { return arrivalTimes[id]; }
+    // Time the customer's first service began (NaN while waiting).
+    double& serviceStartTime(Id id) { return serviceStartTimes[id]; }
+    // Time the customer entered the network it belongs to.
+    double& originTime(Id id) { return originTimes[id]; }
+
+    // Number of records ever created.
+    std::size_t capacity() const { return arrivalTimes.size(); }
+    // Number of records in use.
+    std::size_t size() const { return arrivalTimes.size() - freeIds.size(); }
+
+private:
+    std::vector<double> arrivalTimes;
+    std::vector<double> serviceStartTimes;
+    std::vector<double> originTimes;
+    std::vector<Id> freeIds;
+};
+
+//----------------------------------------------------------------
+// CustomerTracker: waiting and sojourn times of a queue's customers
+//----------------------------------------------------------------
+// Used by the queue models when customer tracking is enabled. Arriving
+// customers join a first-come first-served waiting line; the model tells
+// the tracker when the next one starts service and which one departs.
+// Waiting times (arrival to first service start) and sojourn times
+// (arrival to departure) go into quantile sketches, so memory stays bounded
+// however many customers pass through.
+//
+// Customers whose arrival time is unknown (those already present when
+// tracking was enabled or a checkpoint was restored) are tracked with NaN
+// times and left out of the sketches.
+class CustomerTracker {
+public:
+    using Id = CustomerPool::Id;
+
+    static constexpr Id noCustomer = CustomerPool::noCustomer;
+
+    explicit CustomerTracker(int precisionBits = QuantileSketch::defaultPrecisionBits)
+        : waitingTimes(precisionBits), sojournTimes(precisionBits),
+        lastArrival(noCustomer), lastDepartureOrigin(std::numeric_limits<double>::quiet_NaN()) {}
+
+    // A customer arrives and joins the end of the waiting line. originTime
+    // is when it entered the network (its arrival time for a lone queue).
+    void arrive(double time, double originTime) {
+        lastArrival = customers.acquire(time, originTime);
+        waitingLine.pushBack(lastArrival);
+    }
+
+    void arrive(double time) { arrive(time, time); }
+
+    // Add a customer of unknown arrival time to the waiting line.
+    void arriveUnknown() {
+        double unknown = std::numeric_limits<double>::quiet_NaN();
+        waitingLine.pushBack(customers.acquire(unknown, unknown));
+    }
+
+    // Create a customer of unknown arrival time who is already in service.
+    Id unknownInService() {
+        double unknown = std::numeric_limits<double>::quiet_NaN();
+        return customers.acquire(unknown, unknown);
+    }
+
+    // Change the network entry time of the customer who arrived last.
+    void setLastArrivalOrigin(double originTime) {
+        if (lastArrival != noCustomer)
+            customers.originTime(lastArrival) = originTime;
+    }
+
+    // The customer at the head of the waiting line starts service. Returns
+    // its id, or noCustomer if the line is empty.
+    Id startService(double time) {
+        if (waitingLine.empty())
+            return noCustomer;
+        Id id = waitingLine.popFront();
+        double& start = customers.serviceStartTime(id);
+        if (std::isnan(start))
+            start = time;  // A preempted customer keeps its first start.
+        return id;
+    }
+
+    // Put a customer whose service was interrupted back at the head of the line.
+    void requeue(Id id) {
+        if (id != noCustomer)
+            waitingLine.pushFront(id);
+    }
+
+    // A customer leaves the queue: record its times and release its record.
+    void depart(Id id, double time) {
+        if (id == noCustomer) {
+            lastDepartureOrigin = std::numeric_limits<double>::quiet_NaN();
+            return;
+        }
+        double arrival = customers.arrivalTime(id);
+        waitingTimes.add(customers.serviceStartTime(id) - arrival);
+        sojournTimes.add(time - arrival);
+        lastDepartureOrigin = customers.originTime(id);
+        if (id == lastArrival)
+            lastArrival = noCustomer;
+        customers.release(id);
+    }
+
+    // Network entry time of the customer who departed last (NaN if unknown).
+    double getLastDepartureOrigin() const { return lastDepartureOrigin; }
+
+    // Forget every customer; the sketches are kept.
+    void clearCustomers() {
+        customers.clear();
+        waitingLine.clear();
+        lastArrival = noCustomer;
+    }
+
+    // Empty the sketches (e.g. at the end of the warm-up period). Customers
+    // in the queue are still recorded when they depart.
+    void resetStatistics() {
+        waitingTimes.reset();
+        sojournTimes.reset();
+    }
+
+    const QuantileSketch& getWaitingTimes() const { return waitingTimes; }
+    const QuantileSketch& getSojournTimes() const { return sojournTimes; }
+    const CustomerPool& getPool() const { return customers; }
+
+private:
+    CustomerPool customers;
+    RingQueue<Id> waitingLine;
+    QuantileSketch waitingTimes;
+    QuantileSketch sojournTimes;
+    Id lastArrival;
+    double lastDepartureOrigin;
+};
+
+#endif // CUSTOMER_TRACKER_H
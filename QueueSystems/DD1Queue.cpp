@@ -1,5 +1,6 @@
 #include "DD1Queue.h"
 #include "QueueEvents.h"
+#include "Checkpoint.h"
 
 DD1Queue::DD1Queue(Simulation& sim, double interarrivalTime, double serviceTime)
     : sim(sim), interarrivalTime(interarrivalTime), serviceTime(serviceTime),
@@ -11,7 +12,7 @@ DD1Queue::DD1Queue(Simulation& sim, double interarrivalTime, double serviceTime)
 // Schedule the first arrival event.
 void DD1Queue::start() {
     double firstArrivalTime = sim.getCurrentTime() + interarrivalTime;
-    sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(firstArrivalTime, this));
+    scheduleExternalArrival(sim, firstArrivalTime);
 }
 
 // Update time-weighted metrics.
@@ -27,13 +28,14 @@ void DD1Queue::handleExternalArrival(Simulation& sim)
 	updateMetrics(currentTime);
 	totalArrivals++;
 	numInSystem++;
+	stateChanged(currentTime);
 	// Schedule the next external arrival.
 	double nextArrivalTime = currentTime + interarrivalTime;
-	sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(nextArrivalTime, this));
+	scheduleExternalArrival(sim, nextArrivalTime);
 	// If server was idle, schedule a departure.
 	if (numInSystem == 1) {
 		double departureTime = currentTime + serviceTime;
-		sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+		scheduleDeparture(sim, departureTime);
 	}
 }
 
@@ -43,10 +45,11 @@ void DD1Queue::handleInternalArrival(Simulation& sim)
 	updateMetrics(currentTime);
 	totalArrivals++;
 	numInSystem++;
+	stateChanged(currentTime);
 	// Note: Do not schedule the next external arrival.
 	if (numInSystem == 1) {
 		double departureTime = currentTime + serviceTime;
-		sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+		scheduleDeparture(sim, departureTime);
 	}
 }
 
@@ -56,6 +59,7 @@ void DD1Queue::handleDeparture(Simulation& sim) {
     updateMetrics(currentTime);
     totalDepartures++;
     numInSystem--;
+    stateChanged(currentTime);
 
     // Notify observers (StateLogger) of the queue state change
     notifyObservers(currentTime);
@@ -63,7 +67,7 @@ void DD1Queue::handleDeparture(Simulation& sim) {
     // If there are still customers waiting, schedule the next departure.
     if (numInSystem > 0) {
         double departureTime = currentTime + serviceTime;
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        scheduleDeparture(sim, departureTime);
     }
 }
 
@@ -76,3 +80,24 @@ int DD1Queue::getTotalArrivals() const {
 int DD1Queue::getTotalDepartures() const {
     return totalDepartures;
 }
+
+// Time-average number in system since time 0, up to the last event.
+double DD1Queue::getAverageNumberInSystem() const {
+    return (lastEventTime > 0) ? cumulativeTimeWeightedCustomers / lastEventTime : 0.0;
+}
+
+void DD1Queue::saveState(CheckpointWriter& out) const {
+    out.write(numInSystem);
+    out.write(totalArrivals);
+    out.write(totalDepartures);
+    out.write(cumulativeTimeWeightedCustomers);
+    out.write(lastEventTime);
+}
+
+void DD1Queue::restoreState(CheckpointReader& in) {
+    numInSystem = in.read<int>();
+    totalArrivals = in.read<int>();
+    totalDepartures = in.read<int>();
+    cumulativeTimeWeightedCustomers = in.read<double>();
+    lastEventTime = in.read<double>();
+}
@@ -30,6 +30,11 @@ public:
     // Accessors for metrics.
     int getTotalArrivals() const;
     int getTotalDepartures() const;
+    double getAverageNumberInSystem() const;
+
+    // Checkpointing.
+    virtual void saveState(CheckpointWriter& out) const override;
+    virtual void restoreState(CheckpointReader& in) override;
 
 private:
     Simulation& sim;
@@ -0,0 +1,190 @@
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "QueueEvents.h"
+#include "ExponentialVariates.h"
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <vector>
+#include <limits>
+
+// The engine as it was before the event pool: every event a freshly
+// allocated shared_ptr in a std::priority_queue. The queue draws its times
+// as MM1Queue does now, so that only the event handling differs.
+namespace baseline {
+    class Simulation;
+
+    class Event {
+    public:
+        double eventTime;
+        Event(double time) : eventTime(time) {}
+        virtual ~Event() {}
+        virtual void process(Simulation& sim) = 0;
+    };
+
+    struct EventComparator {
+        bool operator()(const std::shared_ptr<Event>& e1, const std::shared_ptr<Event>& e2) {
+            return e1->eventTime > e2->eventTime;
+        }
+    };
+
+    class Simulation {
+    public:
+        Simulation() : currentTime(0.0), eventsProcessed(0) {}
+
+        double getCurrentTime() const { return currentTime; }
+        std::uint64_t getEventsProcessed() const { return eventsProcessed; }
+
+        void scheduleEvent(const std::shared_ptr<Event>& event) {
+            eventQueue.push(event);
+        }
+
+        void run(double endTime) {
+            while (!eventQueue.empty()) {
+                auto event = eventQueue.top();
+                if (event->eventTime > endTime)
+                    break;
+                eventQueue.pop();
+                currentTime = event->eventTime;
+                event->process(*this);
+                eventsProcessed++;
+            }
+        }
+
+    private:
+        double currentTime;
+        std::uint64_t eventsProcessed;
+        std::priority_queue<std::shared_ptr<Event>, std::vector<std::shared_ptr<Event>>, EventComparator> eventQueue;
+    };
+
+    class MM1Queue {
+    public:
+        MM1Queue(Simulation& sim, double arrivalRate, double serviceRate)
+            : sim(sim), arrivalMean(1.0 / arrivalRate), serviceMean(1.0 / serviceRate),
+            arrivalVariates(RandomStream(1)), serviceVariates(RandomStream(2)),
+            numInSystem(0), cumulativeTimeWeightedCustomers(0.0), lastEventTime(0.0) {}
+
+        void start();
+        void handleArrival();
+        void handleDeparture();
+
+        double getAverageNumberInSystem() const {
+            return lastEventTime > 0 ? cumulativeTimeWeightedCustomers / lastEventTime : 0.0;
+        }
+
+    private:
+        Simulation& sim;
+        double arrivalMean;
+        double serviceMean;
+        ExponentialVariates arrivalVariates;
+        ExponentialVariates serviceVariates;
+        int numInSystem;
+        double cumulativeTimeWeightedCustomers;
+        double lastEventTime;
+
+        void updateMetrics(double currentTime) {
+            cumulativeTimeWeightedCustomers += numInSystem * (currentTime - lastEventTime);
+            lastEventTime = currentTime;
+        }
+    };
+
+    class ArrivalEvent : public Event {
+    public:
+        MM1Queue* queue;
+        ArrivalEvent(double time, MM1Queue* q) : Event(time), queue(q) {}
+        virtual void process(Simulation&) override { queue->handleArrival(); }
+    };
+
+    class DepartureEvent : public Event {
+    public:
+        MM1Queue* queue;
+        DepartureEvent(double time, MM1Queue* q) : Event(time), queue(q) {}
+        virtual void process(Simulation&) override { queue->handleDeparture(); }
+    };
+
+    void MM1Queue::start() {
+        sim.scheduleEvent(std::make_shared<ArrivalEvent>(sim.getCurrentTime() + arrivalVariates.next(arrivalMean), this));
+    }
+
+    void MM1Queue::handleArrival() {
+        double currentTime = sim.getCurrentTime();
+        updateMetrics(currentTime);
+        numInSystem++;
+        sim.scheduleEvent(std::make_shared<ArrivalEvent>(currentTime + arrivalVariates.next(arrivalMean), this));
+        if (numInSystem == 1)
+            sim.scheduleEvent(std::make_shared<DepartureEvent>(currentTime + serviceVariates.next(serviceMean), this));
+    }
+
+    void MM1Queue::handleDeparture() {
+        double currentTime = sim.getCurrentTime();
+        updateMetrics(currentTime);
+        numInSystem--;
+        if (numInSystem > 0)
+            sim.scheduleEvent(std::make_shared<DepartureEvent>(currentTime + serviceVariates.next(serviceMean), this));
+    }
+}
+
+// M/M/1 queue that schedules every event through a freshly allocated
+// shared_ptr, which the current engine wraps in a pooled adapter event.
+class SharedPtrMM1Queue : public MM1Queue {
+public:
+    SharedPtrMM1Queue(Simulation& sim, double arrivalRate, double serviceRate)
+        : MM1Queue(sim, arrivalRate, serviceRate) {}
+
+    void start() {
+        sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(sim.getCurrentTime() + getNextInterarrivalTime(), this));
+    }
+
+    virtual void handleExternalArrival(Simulation& sim) override {
+        double currentTime = sim.getCurrentTime();
+        updateMetrics(currentTime);
+        totalArrivals++;
+        numInSystem++;
+        sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(currentTime + getNextInterarrivalTime(), this));
+        if (numInSystem == 1) {
+            sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(currentTime + serviceVariates.next(serviceMean), this));
+        }
+    }
+
+    virtual void handleDeparture(Simulation& sim) override {
+        double currentTime = sim.getCurrentTime();
+        updateMetrics(currentTime);
+        totalDepartures++;
+        numInSystem--;
+        if (numInSystem > 0) {
+            sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(currentTime + serviceVariates.next(serviceMean), this));
+        }
+    }
+};
+
+// Run the MainWorkingMM1Queue scenario (lambda = 5, mu = 10) and report throughput.
+template <typename Sim, typename Queue>
+void runScenario(const char* label, double endTime) {
+    Sim sim;
+    Queue queue(sim, 5.0, 10.0);
+    queue.start();
+
+    auto begin = std::chrono::steady_clock::now();
+    sim.run(endTime);
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    double events = static_cast<double>(sim.getEventsProcessed());
+    std::cout << label << ":\n";
+    std::cout << "  Events processed: " << sim.getEventsProcessed() << "\n";
+    std::cout << "  Wall time (s): " << seconds << "\n";
+    std::cout << "  Events/sec: " << events / seconds << "\n";
+    std::cout << "  Average Number in System: " << queue.getAverageNumberInSystem()
+              << " (theory 1)\n\n";
+}
+
+int main() {
+    double endTime = 2.0e6;
+
+    std::cout << "Event pool benchmark (M/M/1, lambda = 5, mu = 10, T = " << endTime << ")\n\n";
+    runScenario<baseline::Simulation, baseline::MM1Queue>("shared_ptr priority queue (before)", endTime);
+    runScenario<Simulation, SharedPtrMM1Queue>("shared_ptr through the pool adapter", endTime);
+    runScenario<Simulation, MM1Queue>("pooled events (after)", endTime);
+    return 0;
+}
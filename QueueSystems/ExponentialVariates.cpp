@@ -0,0 +1,160 @@
+#include "ExponentialVariates.h"
+#include <cstring>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(__AVX2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+// -log(u) follows the natural logarithm of fdlibm (e_log.c): write
+// u = 2^k * m with m in [sqrt(2)/2, sqrt(2)), f = m - 1 and s = f / (2 + f);
+// then log(m) = f - (f^2/2 - s * (f^2/2 + R(s^2))) with a minimax polynomial
+// R, and log(u) = k * ln2 + log(m). The uniforms from
+// RandomStream::nextUniform are at least 2^-53, so there are no zeros,
+// subnormals, infinities or NaNs to handle.
+
+namespace {
+    const double ln2Hi = 6.93147180369123816490e-01;
+    const double ln2Lo = 1.90821492927058770002e-10;
+    const double lg1 = 6.666666666666735130e-01;
+    const double lg2 = 3.999999999940941908e-01;
+    const double lg3 = 2.857142874366239149e-01;
+    const double lg4 = 2.222219843214978396e-01;
+    const double lg5 = 1.818357216161805012e-01;
+    const double lg6 = 1.531383769920937332e-01;
+    const double lg7 = 1.479819860511658591e-01;
+    const double sqrt2 = 1.41421356237309504880;
+
+    const long long mantissaMask = 0x000fffffffffffffLL;
+    const long long exponentOfOne = 0x3ff0000000000000LL;
+    const long long twoTo52Bits = 0x4330000000000000LL;
+    const double twoTo52 = 4503599627370496.0;
+
+    // Lane operations for each code path. The formula is written once, in
+    // negativeLog, so every path gives the same results.
+    struct ScalarLanes {
+        using Value = double;
+        static Value set(double x) { return x; }
+        static Value add(Value a, Value b) { return a + b; }
+        static Value sub(Value a, Value b) { return a - b; }
+        static Value mul(Value a, Value b) { return a * b; }
+        static Value div(Value a, Value b) { return a / b; }
+
+        // Split u into its exponent and its mantissa in [1, 2).
+        static void split(Value u, Value& exponent, Value& mantissa) {
+            std::uint64_t bits;
+            std::memcpy(&bits, &u, sizeof(bits));
+            exponent = static_cast<double>(static_cast<int>(bits >> 52) - 1023);
+            bits = (bits & mantissaMask) | exponentOfOne;
+            std::memcpy(&mantissa, &bits, sizeof(mantissa));
+        }
+
+        // Halve the mantissas above sqrt(2) and raise their exponents.
+        static void normalize(Value& exponent, Value& mantissa) {
+            if (mantissa > sqrt2) {
+                mantissa *= 0.5;
+                exponent += 1.0;
+            }
+        }
+    };
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QS_HAVE_SSE2_LANES
+    struct Sse2Lanes {
+        using Value = __m128d;
+        static Value set(double x) { return _mm_set1_pd(x); }
+        static Value add(Value a, Value b) { return _mm_add_pd(a, b); }
+        static Value sub(Value a, Value b) { return _mm_sub_pd(a, b); }
+        static Value mul(Value a, Value b) { return _mm_mul_pd(a, b); }
+        static Value div(Value a, Value b) { return _mm_div_pd(a, b); }
+
+        static void split(Value u, Value& exponent, Value& mantissa) {
+            // Put the exponent field into the mantissa of 2^52 and subtract 2^52.
+            __m128i bits = _mm_castpd_si128(u);
+            __m128i field = _mm_or_si128(_mm_srli_epi64(bits, 52), _mm_set1_epi64x(twoTo52Bits));
+            exponent = _mm_sub_pd(_mm_castsi128_pd(field), _mm_set1_pd(twoTo52 + 1023.0));
+            mantissa = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(mantissaMask)),
+                _mm_set1_epi64x(exponentOfOne)));
+        }
+
+        static void normalize(Value& exponent, Value& mantissa) {
+            Value above = _mm_cmpgt_pd(mantissa, _mm_set1_pd(sqrt2));
+            Value scale = _mm_sub_pd(_mm_set1_pd(1.0), _mm_and_pd(above, _mm_set1_pd(0.5)));
+            mantissa = _mm_mul_pd(mantissa, scale);
+            exponent = _mm_add_pd(exponent, _mm_and_pd(above, _mm_set1_pd(1.0)));
+        }
+    };
+#endif
+
+#if defined(__AVX2__)
+#define QS_HAVE_AVX2_LANES
+    struct Avx2Lanes {
+        using Value = __m256d;
+        static Value set(double x) { return _mm256_set1_pd(x); }
+        static Value add(Value a, Value b) { return _mm256_add_pd(a, b); }
+        static Value sub(Value a, Value b) { return _mm256_sub_pd(a, b); }
+        static Value mul(Value a, Value b) { return _mm256_mul_pd(a, b); }
+        static Value div(Value a, Value b) { return _mm256_div_pd(a, b); }
+
+        static void split(Value u, Value& exponent, Value& mantissa) {
+            __m256i bits = _mm256_castpd_si256(u);
+            __m256i field = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(twoTo52Bits));
+            exponent = _mm256_sub_pd(_mm256_castsi256_pd(field), _mm256_set1_pd(twoTo52 + 1023.0));
+            mantissa = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(mantissaMask)),
+                _mm256_set1_epi64x(exponentOfOne)));
+        }
+
+        static void normalize(Value& exponent, Value& mantissa) {
+            Value above = _mm256_cmp_pd(mantissa, _mm256_set1_pd(sqrt2), _CMP_GT_OQ);
+            Value scale = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_and_pd(above, _mm256_set1_pd(0.5)));
+            mantissa = _mm256_mul_pd(mantissa, scale);
+            exponent = _mm256_add_pd(exponent, _mm256_and_pd(above, _mm256_set1_pd(1.0)));
+        }
+    };
+#endif
+
+    template <typename Lanes>
+    inline typename Lanes::Value negativeLog(typename Lanes::Value u) {
+        using L = Lanes;
+        typename L::Value dk, m;
+        L::split(u, dk, m);
+        L::normalize(dk, m);
+        typename L::Value f = L::sub(m, L::set(1.0));
+        typename L::Value s = L::div(f, L::add(L::set(2.0), f));
+        typename L::Value z = L::mul(s, s);
+        typename L::Value w = L::mul(z, z);
+        typename L::Value t1 = L::mul(w, L::add(L::set(lg2), L::mul(w, L::add(L::set(lg4), L::mul(w, L::set(lg6))))));
+        typename L::Value t2 = L::mul(z, L::add(L::set(lg1), L::mul(w, L::add(L::set(lg3),
+            L::mul(w, L::add(L::set(lg5), L::mul(w, L::set(lg7))))))));
+        typename L::Value hfsq = L::mul(L::set(0.5), L::mul(f, f));
+        typename L::Value inner = L::add(L::mul(s, L::add(L::add(hfsq, t1), t2)), L::mul(dk, L::set(ln2Lo)));
+        return L::sub(L::sub(L::sub(hfsq, inner), f), L::mul(dk, L::set(ln2Hi)));
+    }
+}
+
+void standardExponentialsScalar(double* values, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++)
+        values[i] = negativeLog<ScalarLanes>(values[i]);
+}
+
+void standardExponentials(double* values, std::size_t count) {
+    std::size_t i = 0;
+#if defined(QS_HAVE_AVX2_LANES)
+    for (; i + 4 <= count; i += 4)
+        _mm256_storeu_pd(values + i, negativeLog<Avx2Lanes>(_mm256_loadu_pd(values + i)));
+#elif defined(QS_HAVE_SSE2_LANES)
+    for (; i + 2 <= count; i += 2)
+        _mm_storeu_pd(values + i, negativeLog<Sse2Lanes>(_mm_loadu_pd(values + i)));
+#endif
+    standardExponentialsScalar(values + i, count - i);
+}
+
+const char* standardExponentialsKernel() {
+#if defined(QS_HAVE_AVX2_LANES)
+    return "AVX2";
+#elif defined(QS_HAVE_SSE2_LANES)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,77 @@
+#ifndef EXPONENTIAL_VARIATES_H
+#define EXPONENTIAL_VARIATES_H
+
+#include "RandomStream.h"
+#include "ProfileScope.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Replace each uniform value u in (0, 1] by -log(u), a standard
+// exponential variate. Uses AVX2 when the build enables it (-mavx2 or
+// /arch:AVX2), SSE2 on other x86 builds and a scalar loop elsewhere. All
+// three evaluate the same polynomial, accurate to one unit in the last
+// place, so the variates do not depend on the instruction set. Defined in
+// ExponentialVariates.cpp.
+void standardExponentials(double* values, std::size_t count);
+
+// The scalar loop of standardExponentials, whatever the build supports.
+void standardExponentialsScalar(double* values, std::size_t count);
+
+// "AVX2", "SSE2" or "scalar": the code path standardExponentials takes.
+const char* standardExponentialsKernel();
+
+//----------------------------------------------------------------
+// ExponentialVariates: buffered exponential variates from one stream
+//----------------------------------------------------------------
+// Draws a block of uniforms from its RandomStream and turns them into
+// standard exponential variates in one pass of standardExponentials; next()
+// hands them out scaled by the requested mean. This replaces one
+// std::exponential_distribution call (and one log) per variate with a
+// vectorized loop per block. A queue owns one for its interarrival times
+// and one for its service times.
+class ExponentialVariates {
+public:
+    static constexpr std::size_t blockSize = 128;
+
+    // Everything needed to continue the sequence exactly, for checkpointing.
+    struct State {
+        RandomStream::State stream;
+        std::uint64_t position;
+        std::array<double, blockSize> block;
+    };
+
+    explicit ExponentialVariates(const RandomStream& stream) : rng(stream), position(blockSize) {}
+
+    // Exponential variate with the given mean (one over the rate).
+    double next(double mean) {
+        if (position == blockSize)
+            refill();
+        return block[position++] * mean;
+    }
+
+    State getState() const {
+        return State{ rng.getState(), static_cast<std::uint64_t>(position), block };
+    }
+
+    void setState(const State& state) {
+        rng.setState(state.stream);
+        position = state.position < blockSize ? static_cast<std::size_t>(state.position) : blockSize;
+        block = state.block;
+    }
+
+private:
+    RandomStream rng;
+    std::size_t position;  // Next unused entry of block; blockSize when empty.
+    std::array<double, blockSize> block;
+
+    void refill() {
+        QS_PROFILE_SCOPE(RandomNumbers);
+        for (double& value : block)
+            value = rng.nextUniform();
+        standardExponentials(block.data(), blockSize);
+        position = 0;
+    }
+};
+
+#endif // EXPONENTIAL_VARIATES_H
@@ -0,0 +1,139 @@
+#include "ExponentialVariates.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const std::size_t draws = 50000000;
+
+    // Time draws calls of next() and report variates per second. The sum
+    // keeps the compiler from dropping the work.
+    template <typename Next>
+    void measure(const char* label, Next next) {
+        auto begin = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        for (std::size_t i = 0; i < draws; i++)
+            sum += next();
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        std::cout << "  " << std::left << std::setw(46) << label << std::right
+                  << std::setw(8) << std::setprecision(3) << draws / seconds / 1.0e6 << " M/s"
+                  << "  (mean " << std::setprecision(5) << sum / draws << ")\n";
+    }
+
+    bool report(const char* check, double value, double limit) {
+        bool passed = value <= limit;
+        std::cout << "  " << std::left << std::setw(46) << check << std::right << std::setprecision(4)
+                  << std::setw(12) << value << "  limit " << limit << (passed ? "  ok\n" : "  FAILED\n");
+        return passed;
+    }
+
+    // Statistical checks on n standard exponential variates from ExponentialVariates.
+    bool checkDistribution(std::size_t n) {
+        ExponentialVariates variates(RandomStream(20241014));
+        std::vector<double> sample(n);
+        for (double& x : sample)
+            x = variates.next(1.0);
+
+        double mean = 0.0, m2 = 0.0;
+        for (std::size_t i = 0; i < n; i++) {
+            double delta = sample[i] - mean;
+            mean += delta / (i + 1);
+            m2 += delta * (sample[i] - mean);
+        }
+        double variance = m2 / (n - 1);
+
+        // Kolmogorov-Smirnov distance to F(x) = 1 - exp(-x).
+        std::sort(sample.begin(), sample.end());
+        double ks = 0.0;
+        for (std::size_t i = 0; i < n; i++) {
+            double cdf = -std::expm1(-sample[i]);
+            ks = std::max({ ks, cdf - static_cast<double>(i) / n, static_cast<double>(i + 1) / n - cdf });
+        }
+
+        // Chi-square over 50 equiprobable bins (49 degrees of freedom).
+        const int bins = 50;
+        std::vector<double> counts(bins, 0.0);
+        for (double x : sample)
+            counts[std::min(bins - 1, static_cast<int>(-std::expm1(-x) * bins))] += 1.0;
+        double expected = static_cast<double>(n) / bins, chiSquare = 0.0;
+        for (double count : counts)
+            chiSquare += (count - expected) * (count - expected) / expected;
+
+        // Limits at roughly the 0.1% level: 3.3 standard errors for the
+        // moments (Var of the sample variance is 8/n for Exp(1)), 1.95/sqrt(n)
+        // for KS and the 99.9% point of chi-square with 49 degrees of freedom.
+        double rootN = std::sqrt(static_cast<double>(n));
+        std::cout << "Distribution of " << n << " variates (Exp(1)):\n";
+        bool passed = report("|mean - 1|", std::abs(mean - 1.0), 3.3 / rootN);
+        passed &= report("|variance - 1|", std::abs(variance - 1.0), 3.3 * std::sqrt(8.0) / rootN);
+        passed &= report("Kolmogorov-Smirnov D", ks, 1.95 / rootN);
+        passed &= report("chi-square, 50 bins", chiSquare, 85.35);
+        return passed;
+    }
+
+    // Compare the kernel with std::log over many uniforms, in units of
+    // the spacing of doubles at the exact result.
+    bool checkAccuracy(std::size_t n) {
+        RandomStream rng(7);
+        std::vector<double> values(n), exact(n);
+        for (std::size_t i = 0; i < n; i++) {
+            // Mostly uniforms, plus tiny values to cover large exponents.
+            double u = rng.nextUniform();
+            values[i] = (i % 8 == 0) ? std::ldexp(u, -static_cast<int>(rng() % 50)) : u;
+            exact[i] = -std::log(values[i]);
+        }
+        std::vector<double> scalar = values;
+        standardExponentials(values.data(), n);
+        standardExponentialsScalar(scalar.data(), n);
+
+        double maxUlps = 0.0;
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            double ulp = std::nextafter(std::abs(exact[i]), INFINITY) - std::abs(exact[i]);
+            if (exact[i] != 0.0)
+                maxUlps = std::max(maxUlps, std::abs(values[i] - exact[i]) / ulp);
+            mismatches += (values[i] != scalar[i]);
+        }
+        std::cout << "Accuracy over " << n << " values:\n";
+        bool passed = report("max error vs std::log (ulps)", maxUlps, 2.0);
+        passed &= report("kernel values differing from scalar path", static_cast<double>(mismatches), 0.0);
+        return passed;
+    }
+}
+
+int main() {
+    std::cout << "Exponential variates, kernel: " << standardExponentialsKernel() << "\n\n";
+
+    std::cout << "Throughput (" << draws << " draws):\n";
+    {
+        std::default_random_engine engine(1);
+        std::exponential_distribution<double> dist(2.0);
+        measure("exponential_distribution, default engine", [&]() { return dist(engine); });
+    }
+    {
+        RandomStream rng(1);
+        std::exponential_distribution<double> dist(2.0);
+        measure("exponential_distribution, RandomStream", [&]() { return dist(rng); });
+    }
+    {
+        RandomStream rng(1);
+        measure("-log(U) / rate per draw, RandomStream", [&]() { return -std::log(rng.nextUniform()) * 0.5; });
+    }
+    {
+        ExponentialVariates variates(RandomStream(1));
+        measure("ExponentialVariates (blocks of 128)", [&]() { return variates.next(0.5); });
+    }
+    std::cout << "\n";
+
+    bool passed = checkDistribution(10000000);
+    std::cout << "\n";
+    passed &= checkAccuracy(10000000);
+    std::cout << "\n" << (passed ? "All checks passed." : "Some checks FAILED.") << "\n";
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,321 @@
+#ifndef FUTURE_EVENT_SET_H
+#define FUTURE_EVENT_SET_H
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------
+// Entry in the future-event set.
+//----------------------------------------------------------------
+// Events with equal times are ordered by their sequence number (the order
+// in which they were scheduled), so every future-event set produces the
+// same ordering.
+struct ScheduledEvent {
+    double eventTime;
+    std::uint64_t sequence;
+    std::uint32_t handle;  // Event pool handle.
+};
+
+// Returns true if a must be processed before b.
+inline bool occursBefore(const ScheduledEvent& a, const ScheduledEvent& b) {
+    return a.eventTime < b.eventTime
+        || (a.eventTime == b.eventTime && a.sequence < b.sequence);
+}
+
+// Available future-event set implementations.
+enum class FutureEventSetKind {
+    BinaryHeap,   // O(log n) per operation; best for small event lists.
+    LadderQueue   // Amortized O(1) per operation; best for large event lists.
+};
+
+//----------------------------------------------------------------
+// Binary heap future-event set.
+//----------------------------------------------------------------
+// The heap records the position of every handle it holds, so an entry can
+// be removed or moved to a new time in O(log n). Each handle may appear in
+// the heap at most once.
+class BinaryHeapEventSet {
+public:
+    // Entries can be removed and updated in place.
+    static constexpr bool supportsRemoval = true;
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+
+    void push(const ScheduledEvent& event) {
+        if (event.handle >= position.size())
+            position.resize(static_cast<std::size_t>(event.handle) + 1);
+        heap.push_back(event);
+        siftUp(heap.size() - 1);
+    }
+
+    const ScheduledEvent& top() { return heap.front(); }
+
+    void pop() { removeAt(0); }
+
+    // Remove the entry holding the given handle.
+    void remove(std::uint32_t handle) { removeAt(position[handle]); }
+
+    // Move the entry holding the given handle to a new time and sequence number.
+    void update(std::uint32_t handle, double eventTime, std::uint64_t sequence) {
+        std::size_t index = position[handle];
+        heap[index].eventTime = eventTime;
+        heap[index].sequence = sequence;
+        siftUp(index);
+        siftDown(position[handle]);
+    }
+
+    // Call f for every entry, in no particular order.
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& event : heap)
+            f(event);
+    }
+
+private:
+    std::vector<ScheduledEvent> heap;
+    std::vector<std::uint32_t> position;  // Heap index of each handle.
+
+    void place(std::size_t index, const ScheduledEvent& event) {
+        heap[index] = event;
+        position[event.handle] = static_cast<std::uint32_t>(index);
+    }
+
+    void siftUp(std::size_t index) {
+        ScheduledEvent event = heap[index];
+        while (index > 0) {
+            std::size_t parent = (index - 1) / 2;
+            if (!occursBefore(event, heap[parent]))
+                break;
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, event);
+    }
+
+    void siftDown(std::size_t index) {
+        ScheduledEvent event = heap[index];
+        std::size_t size = heap.size();
+        for (;;) {
+            std::size_t child = 2 * index + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && occursBefore(heap[child + 1], heap[child]))
+                child++;
+            if (!occursBefore(heap[child], event))
+                break;
+            place(index, heap[child]);
+            index = child;
+        }
+        place(index, event);
+    }
+
+    void removeAt(std::size_t index) {
+        ScheduledEvent last = heap.back();
+        heap.pop_back();
+        if (index < heap.size()) {
+            place(index, last);
+            siftUp(index);
+            siftDown(position[last.handle]);
+        }
+    }
+};
+
+//----------------------------------------------------------------
+// Ladder queue future-event set (Tang, Goh and Thng, 2005).
+//----------------------------------------------------------------
+// Events are kept in three tiers:
+//  - Top:    an unsorted list of far-future events.
+//  - Ladder: rungs of time buckets; each rung subdivides one bucket of the
+//            rung above it. Buckets are unsorted.
+//  - Bottom: a short sorted list holding the events that are due next.
+// When Bottom runs dry the next non-empty bucket of the lowest rung is
+// either split into a new rung (if it is large) or sorted into Bottom.
+// Entries cannot be removed; cancelled events are skipped when dequeued.
+class LadderEventSet {
+public:
+    static constexpr bool supportsRemoval = false;
+
+    LadderEventSet() : count(0), activeRungs(0), topStart(0.0), topMin(0.0), topMax(0.0) {}
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void push(const ScheduledEvent& event) {
+        count++;
+        if (activeRungs == 0 && bottom.empty()) {
+            addToTop(event);
+            return;
+        }
+        if (event.eventTime >= topStart) {
+            addToTop(event);
+            return;
+        }
+        for (std::size_t i = 0; i < activeRungs; i++) {
+            Rung& rung = *rungs[i];
+            std::size_t bucket = rung.bucketFor(event.eventTime);
+            if (bucket >= rung.current) {
+                rung.buckets[bucket].push_back(event);
+                return;
+            }
+        }
+        // The event belongs in the range already sorted into Bottom.
+        // Bottom is kept in descending order so the next event is at the back.
+        auto position = std::upper_bound(bottom.begin(), bottom.end(), event,
+            [](const ScheduledEvent& a, const ScheduledEvent& b) { return occursBefore(b, a); });
+        bottom.insert(position, event);
+    }
+
+    const ScheduledEvent& top() {
+        if (bottom.empty()) {
+            refillBottom();
+        }
+        return bottom.back();
+    }
+
+    void pop() {
+        if (bottom.empty()) {
+            refillBottom();
+        }
+        bottom.pop_back();
+        count--;
+    }
+
+    // Call f for every entry, in no particular order.
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& event : top_)
+            f(event);
+        for (std::size_t i = 0; i < activeRungs; i++) {
+            for (const auto& bucket : rungs[i]->buckets) {
+                for (const auto& event : bucket)
+                    f(event);
+            }
+        }
+        for (const auto& event : bottom)
+            f(event);
+    }
+
+private:
+    // Buckets larger than this are split into a new rung rather than sorted.
+    static constexpr std::size_t splitThreshold = 50;
+    static constexpr std::size_t maxRungs = 8;
+    // Upper bound on the bucket count of a rung; larger event lists go to deeper rungs.
+    static constexpr std::size_t maxBuckets = 65536;
+
+    struct Rung {
+        double start = 0.0;        // Time at which bucket 0 starts.
+        double width = 0.0;        // Width of each bucket.
+        std::size_t current = 0;   // First bucket not yet handed down.
+        std::vector<std::vector<ScheduledEvent>> buckets;
+
+        // Bucket index for a time inside the rung's range.
+        std::size_t bucketFor(double time) const {
+            double offset = std::floor((time - start) / width);
+            if (offset <= 0.0)
+                return 0;
+            std::size_t bucket = static_cast<std::size_t>(offset);
+            return std::min(bucket, buckets.size() - 1);
+        }
+
+        void reset(double rungStart, double bucketWidth, std::size_t bucketCount) {
+            start = rungStart;
+            width = bucketWidth;
+            current = 0;
+            for (auto& bucket : buckets)
+                bucket.clear();
+            buckets.resize(bucketCount);
+        }
+    };
+
+    std::size_t count;
+    std::vector<ScheduledEvent> top_;
+    std::vector<std::unique_ptr<Rung>> rungs;  // Rung objects are reused to keep their buckets' capacity.
+    std::size_t activeRungs;
+    std::vector<ScheduledEvent> bottom;
+    double topStart;  // Events at or after this time go to Top.
+    double topMin;
+    double topMax;
+
+    void addToTop(const ScheduledEvent& event) {
+        if (top_.empty()) {
+            topMin = topMax = event.eventTime;
+        }
+        else {
+            topMin = std::min(topMin, event.eventTime);
+            topMax = std::max(topMax, event.eventTime);
+        }
+        top_.push_back(event);
+    }
+
+    Rung& spawnRung(double start, double width, std::size_t bucketCount) {
+        if (activeRungs == rungs.size())
+            rungs.push_back(std::make_unique<Rung>());
+        Rung& rung = *rungs[activeRungs++];
+        rung.reset(start, width, bucketCount);
+        return rung;
+    }
+
+    // Move events into a rung, which must cover their times.
+    static void distribute(Rung& rung, std::vector<ScheduledEvent>& events) {
+        for (const auto& event : events)
+            rung.buckets[rung.bucketFor(event.eventTime)].push_back(event);
+        events.clear();
+    }
+
+    void sortIntoBottom(std::vector<ScheduledEvent>& events) {
+        bottom.assign(events.begin(), events.end());
+        std::sort(bottom.begin(), bottom.end(),
+            [](const ScheduledEvent& a, const ScheduledEvent& b) { return occursBefore(b, a); });
+        events.clear();
+    }
+
+    void refillBottom() {
+        while (bottom.empty()) {
+            if (activeRungs == 0) {
+                // Turn Top into the first rung.
+                double width = (topMax - topMin) / static_cast<double>(std::min(top_.size(), maxBuckets));
+                if (!(width > 0.0) || top_.size() <= splitThreshold) {
+                    sortIntoBottom(top_);
+                    topStart = topMax;
+                    return;
+                }
+                std::size_t bucketCount = static_cast<std::size_t>((topMax - topMin) / width) + 1;
+                Rung& rung = spawnRung(topMin, width, bucketCount);
+                topStart = rung.start + rung.width * static_cast<double>(bucketCount);
+                if (topStart <= topMax)
+                    topStart = std::nextafter(topMax, std::numeric_limits<double>::infinity());
+                distribute(rung, top_);
+            }
+
+            Rung& rung = *rungs[activeRungs - 1];
+            while (rung.current < rung.buckets.size() && rung.buckets[rung.current].empty())
+                rung.current++;
+            if (rung.current == rung.buckets.size()) {
+                // This rung is exhausted; continue with the one above it.
+                activeRungs--;
+                continue;
+            }
+
+            std::size_t index = rung.current++;
+            std::vector<ScheduledEvent>& bucket = rung.buckets[index];
+            std::size_t childBuckets = std::min(bucket.size(), maxBuckets);
+            double childWidth = rung.width / static_cast<double>(childBuckets);
+            if (bucket.size() > splitThreshold && activeRungs < maxRungs && childWidth > 0.0) {
+                double childStart = rung.start + rung.width * static_cast<double>(index);
+                Rung& child = spawnRung(childStart, childWidth, childBuckets);
+                distribute(child, bucket);
+            }
+            else {
+                sortIntoBottom(bucket);
+            }
+        }
+    }
+};
+
+#endif // FUTURE_EVENT_SET_H
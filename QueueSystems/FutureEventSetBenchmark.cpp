@@ -0,0 +1,82 @@
+#include "FutureEventSet.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Classic "hold" benchmark: fill the event set with n pending events, then
+// repeatedly remove the earliest event and schedule a new one a random
+// (exponential) time later, keeping the pending-event count constant.
+template <typename EventSet>
+double holdNanoseconds(std::size_t pending, std::size_t holds, unsigned seed) {
+    EventSet events;
+    std::default_random_engine rng(seed);
+    std::exponential_distribution<double> increment(1.0);
+    std::uint64_t sequence = 0;
+
+    for (std::size_t i = 0; i < pending; i++) {
+        events.push(ScheduledEvent{ increment(rng), sequence++, static_cast<std::uint32_t>(i) });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < holds; i++) {
+        ScheduledEvent next = events.top();
+        events.pop();
+        next.eventTime += increment(rng);
+        next.sequence = sequence++;
+        events.push(next);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / static_cast<double>(holds);
+}
+
+// Check that both event sets dequeue the same events in the same order,
+// including events scheduled at identical times.
+bool sameOrdering(std::size_t operations, unsigned seed) {
+    BinaryHeapEventSet heap;
+    LadderEventSet ladder;
+    std::default_random_engine rng(seed);
+    std::uniform_int_distribution<int> coarse(0, 20);   // Coarse times produce many ties.
+    std::bernoulli_distribution doPush(0.55);
+    std::uint64_t sequence = 0;
+    double now = 0.0;
+
+    for (std::size_t i = 0; i < operations; i++) {
+        if (heap.empty() || doPush(rng)) {
+            ScheduledEvent event{ now + coarse(rng) * 0.5, sequence, static_cast<std::uint32_t>(sequence) };
+            sequence++;
+            heap.push(event);
+            ladder.push(event);
+        }
+        else {
+            ScheduledEvent a = heap.top();
+            ScheduledEvent b = ladder.top();
+            if (a.handle != b.handle)
+                return false;
+            heap.pop();
+            ladder.pop();
+            now = a.eventTime;
+        }
+    }
+    return heap.size() == ladder.size();
+}
+
+int main() {
+    std::size_t holds = 2000000;
+
+    std::cout << "Future-event set benchmark (hold model, " << holds << " holds per size)\n";
+    std::cout << "Equal-time ordering identical: " << (sameOrdering(1000000, 7) ? "yes" : "NO") << "\n\n";
+
+    std::cout << std::setw(12) << "pending"
+              << std::setw(18) << "heap ns/hold"
+              << std::setw(18) << "ladder ns/hold" << "\n";
+    for (std::size_t pending = 10; pending <= 10000000; pending *= 10) {
+        double heapNs = holdNanoseconds<BinaryHeapEventSet>(pending, holds, 1);
+        double ladderNs = holdNanoseconds<LadderEventSet>(pending, holds, 1);
+        std::cout << std::setw(12) << pending
+                  << std::setw(18) << std::fixed << std::setprecision(1) << heapNs
+                  << std::setw(18) << ladderNs << "\n";
+    }
+    return 0;
+}
@@ -1,7 +1,17 @@
 #include "JacksonNetwork.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <utility>
 #include <numeric>
 #include <random>
 
+namespace {
+    // Network entry time of the customer a node has just released.
+    double departureOrigin(const CustomerTracker* customers) {
+        return customers != nullptr ? customers->getLastDepartureOrigin() : std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
 // -------------------------
 // JacksonMM1Queue Implementation
 // -------------------------
@@ -14,7 +24,13 @@ void JacksonMM1Queue::handleDeparture(Simulation& sim) {
     // Process the departure as in a regular MM1 queue.
     MM1Queue::handleDeparture(sim);
     // After handling departure, route the departing customer.
-    network->routeCustomer(nodeId, sim.getCurrentTime());
+    network->routeCustomer(nodeId, sim.getCurrentTime(), departureOrigin(customers.get()));
+}
+
+void JacksonMM1Queue::handleInternalArrival(Simulation& sim) {
+    MM1Queue::handleInternalArrival(sim);
+    if (customers)
+        customers->setLastArrivalOrigin(network->takeRoutedOrigin(nodeId, sim.getCurrentTime()));
 }
 
 // -------------------------
@@ -27,22 +43,44 @@ JacksonMMSQueue::JacksonMMSQueue(Simulation& sim, double arrivalRate, double ser
 
 void JacksonMMSQueue::handleDeparture(Simulation& sim) {
     MMSQueue::handleDeparture(sim);
-    network->routeCustomer(nodeId, sim.getCurrentTime());
+    network->routeCustomer(nodeId, sim.getCurrentTime(), departureOrigin(customers.get()));
+}
+
+void JacksonMMSQueue::handleInternalArrival(Simulation& sim) {
+    MMSQueue::handleInternalArrival(sim);
+    if (customers)
+        customers->setLastArrivalOrigin(network->takeRoutedOrigin(nodeId, sim.getCurrentTime()));
 }
 
 // -------------------------
 // JacksonNetwork Implementation
 // -------------------------
 JacksonNetwork::JacksonNetwork(Simulation& sim)
-    : sim(sim), rng(std::random_device{}())
+    : sim(sim)
 {
 }
 
+JacksonNetwork::~JacksonNetwork() {
+    for (QueueModel* node : nodes)
+        delete node;
+}
+
+void JacksonNetwork::removeNodes() {
+    for (QueueModel* node : nodes)
+        delete node;
+    nodes.clear();
+    routing = RoutingTable();
+    routingStreams.clear();
+    routedCustomers.clear();
+}
+
 int JacksonNetwork::addMM1Queue(double arrivalRate, double serviceRate) {
     int nodeId = static_cast<int>(nodes.size());
     // Create a new JacksonMM1Queue and store it.
     JacksonMM1Queue* node = new JacksonMM1Queue(sim, arrivalRate, serviceRate, nodeId, this);
     nodes.push_back(node);
+    routingStreams.push_back(sim.nextRandomStream());
+    enableNodeTracking(node);
     return nodeId;
 }
 
@@ -50,11 +88,32 @@ int JacksonNetwork::addMMSQueue(double arrivalRate, double serviceRate, int serv
     int nodeId = static_cast<int>(nodes.size());
     JacksonMMSQueue* node = new JacksonMMSQueue(sim, arrivalRate, serviceRate, servers, nodeId, this);
     nodes.push_back(node);
+    routingStreams.push_back(sim.nextRandomStream());
+    enableNodeTracking(node);
+    return nodeId;
+}
+
+int JacksonNetwork::addRemoteNode() {
+    int nodeId = static_cast<int>(nodes.size());
+    nodes.push_back(nullptr);
+    routingStreams.push_back(sim.nextRandomStream());
     return nodeId;
 }
 
+void JacksonNetwork::setRemoteRouter(std::function<void(int nodeId, double arrivalTime)> router) {
+    remoteRouter = std::move(router);
+}
+
 void JacksonNetwork::setRoutingMatrix(const std::vector<std::vector<double>>& matrix) {
-    routingMatrix = matrix;
+    routing = RoutingTable::fromDense(matrix);
+}
+
+void JacksonNetwork::setRouting(const std::vector<RoutingEntry>& entries) {
+    routing = RoutingTable::fromEntries(static_cast<int>(nodes.size()), entries);
+}
+
+void JacksonNetwork::setRouting(RoutingTable table) {
+    routing = std::move(table);
 }
 
 void JacksonNetwork::start() {
@@ -72,27 +131,108 @@ void JacksonNetwork::start() {
     }
 }
 
-void JacksonNetwork::routeCustomer(int fromNodeId, double currentTime) {
-    if (fromNodeId >= routingMatrix.size())
+void JacksonNetwork::routeCustomer(int fromNodeId, double currentTime, double originTime) {
+    if (fromNodeId >= routing.getRowCount()) {
+        if (sojournTimes)
+            sojournTimes->add(currentTime - originTime);
         return;
+    }
 
-    const std::vector<double>& row = routingMatrix[fromNodeId];
-
-    double cumulative = 0.0;
-    int destination = -1;
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    double r = dist(rng);
-    for (size_t j = 0; j < row.size(); j++) {
-        cumulative += row[j];
-        if (r < cumulative) {
-            destination = static_cast<int>(j);
-            break;
+    int destination = routing.sample(fromNodeId, routingStreams[fromNodeId].nextUniform());
+    if (destination >= 0 && destination < nodes.size()) {
+        if (nodes[destination] != nullptr) {
+            // Schedule an internal arrival.
+            nodes[destination]->scheduleInternalArrival(sim, currentTime + epsilon);
+            if (sojournTimes)
+                routedCustomers[destination].pushBack(RoutedCustomer{ currentTime + epsilon, originTime });
+        }
+        else if (remoteRouter) {
+            remoteRouter(destination, currentTime + epsilon);
         }
     }
-    if (destination >= 0 && destination < nodes.size()) {
-        // Schedule an internal arrival.
-        sim.scheduleEvent(std::make_shared<InternalArrivalEvent>(currentTime + epsilon, nodes[destination]));
+    else if (sojournTimes) {
+        // The customer leaves the network.
+        sojournTimes->add(currentTime - originTime);
+    }
+}
+
+void JacksonNetwork::enableCustomerTracking(int precisionBits) {
+    trackingPrecisionBits = precisionBits;
+    sojournTimes = std::make_unique<QuantileSketch>(precisionBits);
+    for (QueueModel* node : nodes)
+        enableNodeTracking(node);
+}
+
+void JacksonNetwork::enableNodeTracking(QueueModel* node) {
+    if (!sojournTimes)
+        return;
+    if (auto mm1 = dynamic_cast<JacksonMM1Queue*>(node))
+        mm1->enableCustomerTracking(trackingPrecisionBits);
+    else if (auto mms = dynamic_cast<JacksonMMSQueue*>(node))
+        mms->enableCustomerTracking(trackingPrecisionBits);
+    routedCustomers.resize(nodes.size());
+}
+
+void JacksonNetwork::resetSojournTimes() {
+    if (sojournTimes)
+        sojournTimes->reset();
+}
+
+double JacksonNetwork::takeRoutedOrigin(int nodeId, double currentTime) {
+    if (nodeId < 0 || nodeId >= static_cast<int>(routedCustomers.size()))
+        return std::numeric_limits<double>::quiet_NaN();
+    // Every route takes the same time, so routed customers arrive in the
+    // order they were routed. Arrivals scheduled some other way (e.g. by a
+    // checkpoint restore or another partition) find no matching entry.
+    RingQueue<RoutedCustomer>& routed = routedCustomers[nodeId];
+    while (!routed.empty() && routed.front().arrivalTime < currentTime)
+        routed.popFront();
+    if (!routed.empty() && routed.front().arrivalTime == currentTime)
+        return routed.popFront().originTime;
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+bool JacksonNetwork::isProductForm() const {
+    if (std::find(nodes.begin(), nodes.end(), nullptr) != nodes.end())
+        return false;
+    for (int row = 0; row < routing.getRowCount(); row++) {
+        double sum = 0.0;
+        for (std::size_t k = routing.rowBegin(row); k < routing.rowEnd(row); k++) {
+            if (!(routing.getProbability(k) >= 0.0))
+                return false;
+            sum += routing.getProbability(k);
+        }
+        if (sum > 1.0 + 1e-9)
+            return false;
     }
+    return true;
+}
+
+NetworkSolution JacksonNetwork::solveProductForm() const {
+    std::vector<ProductFormNode> specs;
+    for (QueueModel* node : nodes) {
+        if (auto mm1 = dynamic_cast<JacksonMM1Queue*>(node))
+            specs.push_back({ mm1->getArrivalRate(), mm1->getServiceRate(), 1 });
+        else if (auto mms = dynamic_cast<JacksonMMSQueue*>(node))
+            specs.push_back({ mms->getArrivalRate(), mms->getServiceRate(), mms->getServers() });
+        else
+            specs.push_back({ 0.0, 0.0, 0 });  // Remote: unknown, reported as unstable.
+    }
+
+    return ::solveProductForm(specs, routing.getEntries(), epsilon);
+}
+
+std::vector<NodeValidation> JacksonNetwork::validateAgainstProductForm(double relativeTolerance) const {
+    std::vector<ConfidenceInterval> simulated;
+    for (QueueModel* node : nodes) {
+        double average = std::numeric_limits<double>::quiet_NaN();
+        if (auto mm1 = dynamic_cast<JacksonMM1Queue*>(node))
+            average = mm1->getAverageNumberInSystem();
+        else if (auto mms = dynamic_cast<JacksonMMSQueue*>(node))
+            average = mms->getAverageNumberInSystem();
+        simulated.push_back({ average, 0.0 });
+    }
+    return validateSimulation(solveProductForm(), simulated, relativeTolerance);
 }
 
 QueueModel* JacksonNetwork::getNode(int nodeId) {
@@ -100,3 +240,94 @@ QueueModel* JacksonNetwork::getNode(int nodeId) {
         return nodes[nodeId];
     return nullptr;
 }
+
+int JacksonNetwork::getNodeCount() const {
+    return static_cast<int>(nodes.size());
+}
+
+namespace {
+    // Node kinds as stored in a checkpoint.
+    enum NodeKind : std::uint8_t { RemoteNode, MM1Node, MMSNode };
+
+    NodeKind kindOf(QueueModel* node) {
+        if (dynamic_cast<JacksonMM1Queue*>(node))
+            return MM1Node;
+        if (dynamic_cast<JacksonMMSQueue*>(node))
+            return MMSNode;
+        return RemoteNode;
+    }
+}
+
+void JacksonNetwork::saveState(CheckpointWriter& out) const {
+    out.write(static_cast<std::uint64_t>(nodes.size()));
+    for (QueueModel* node : nodes) {
+        NodeKind kind = kindOf(node);
+        out.write(kind);
+        if (auto mm1 = dynamic_cast<JacksonMM1Queue*>(node)) {
+            out.write(mm1->getArrivalRate());
+            out.write(mm1->getServiceRate());
+        }
+        else if (auto mms = dynamic_cast<JacksonMMSQueue*>(node)) {
+            out.write(mms->getArrivalRate());
+            out.write(mms->getServiceRate());
+            out.write(mms->getServers());
+        }
+    }
+
+    out.write(static_cast<std::uint64_t>(routing.getRowCount()));
+    out.writeVector(routing.getEntries());
+    for (const RandomStream& stream : routingStreams)
+        out.write(stream);
+
+    for (QueueModel* node : nodes) {
+        if (node != nullptr)
+            node->saveState(out);
+    }
+}
+
+void JacksonNetwork::restoreState(CheckpointReader& in) {
+    std::uint64_t nodeCount = in.read<std::uint64_t>();
+    bool createNodes = nodes.empty();
+    if (!createNodes && nodeCount != nodes.size()) {
+        in.fail();
+        return;
+    }
+    for (std::uint64_t i = 0; i < nodeCount && in.good(); i++) {
+        NodeKind kind = in.read<NodeKind>();
+        double arrivalRate = 0.0, serviceRate = 0.0;
+        int servers = 0;
+        if (kind == MM1Node || kind == MMSNode) {
+            arrivalRate = in.read<double>();
+            serviceRate = in.read<double>();
+        }
+        if (kind == MMSNode)
+            servers = in.read<int>();
+
+        if (!createNodes) {
+            if (kindOf(nodes[i]) != kind)
+                in.fail();
+            continue;
+        }
+        switch (kind) {
+        case MM1Node: addMM1Queue(arrivalRate, serviceRate); break;
+        case MMSNode: addMMSQueue(arrivalRate, serviceRate, servers); break;
+        case RemoteNode: addRemoteNode(); break;
+        default: in.fail(); break;
+        }
+    }
+
+    std::uint64_t rows = in.read<std::uint64_t>();
+    if (!in.good() || rows > nodeCount) {
+        in.fail();
+        return;
+    }
+    std::vector<RoutingEntry> entries = in.readVector<RoutingEntry>();
+    routing = RoutingTable(static_cast<int>(rows), entries);
+    for (RandomStream& stream : routingStreams)
+        in.read(stream);
+
+    for (QueueModel* node : nodes) {
+        if (node != nullptr && in.good())
+            node->restoreState(in);
+    }
+}
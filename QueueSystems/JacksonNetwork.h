@@ -6,14 +6,20 @@
 #include "MM1Queue.h"
 #include "MMSQueue.h"
 #include "QueueEvents.h"
+#include "CustomerTracker.h"
+#include "ProductForm.h"
 #include <vector>
 #include <random>
 #include <memory>
+#include <functional>
+#include <limits>
 
 const double epsilon = 0.01;
 
-// Forward declaration
+// Forward declarations
 class JacksonNetwork;
+class CheckpointWriter;
+class CheckpointReader;
 
 // Wrapper for an M/M/1 queue that routes departures.
 class JacksonMM1Queue : public MM1Queue {
@@ -25,6 +31,8 @@ public:
 
     // Override to add routing after departure.
     virtual void handleDeparture(Simulation& sim) override;
+    // Override to pick up the network entry time of a routed customer.
+    virtual void handleInternalArrival(Simulation& sim) override;
 };
 
 // Wrapper for an M/M/s queue that routes departures.
@@ -36,14 +44,26 @@ public:
     JacksonMMSQueue(Simulation& sim, double arrivalRate, double serviceRate, int servers, int nodeId, JacksonNetwork* network);
 
     virtual void handleDeparture(Simulation& sim) override;
+    virtual void handleInternalArrival(Simulation& sim) override;
 };
 
 // JacksonNetwork class simulates a network of queues where departures from one node
 // can be probabilistically routed to another node (or leave the network).
+//
+// Every node takes three random number streams from the simulation when it
+// is added: interarrival times, service times and routing. Networks that
+// add their nodes in the same order on identically seeded simulations
+// therefore use common random numbers, even if their server counts or
+// routing matrices differ (see ReplicationRunner::compare).
 class JacksonNetwork {
 public:
     // Constructor takes a reference to the simulation engine.
     JacksonNetwork(Simulation& sim);
+    // Deletes the nodes; their pending events must not be processed afterwards.
+    ~JacksonNetwork();
+
+    JacksonNetwork(const JacksonNetwork&) = delete;
+    JacksonNetwork& operator=(const JacksonNetwork&) = delete;
 
     // Add a new M/M/1 queue node. Returns the node id.
     int addMM1Queue(double arrivalRate, double serviceRate);
@@ -51,26 +71,107 @@ public:
     // Add a new M/M/s queue node. Returns the node id.
     int addMMSQueue(double arrivalRate, double serviceRate, int servers);
 
+    // Reserve a node id for a node simulated elsewhere (e.g. by another
+    // partition of a PartitionedJacksonNetwork). Customers routed to it are
+    // handed to the remote router instead of being scheduled locally.
+    int addRemoteNode();
+
+    // Set the callback that receives customers routed to remote nodes,
+    // together with the time at which they arrive there.
+    void setRemoteRouter(std::function<void(int nodeId, double arrivalTime)> router);
+
     // Set the routing matrix. For node i, routingMatrix[i][j] is the probability that a departing
     // customer will be routed to node j. (The row may sum to less than one; the remainder is the
     // probability the customer leaves the network.)
     void setRoutingMatrix(const std::vector<std::vector<double>>& routingMatrix);
 
+    // Set the routing from its nonzero entries only, for large networks
+    // where a dense matrix would not fit. Rows cover every node added so far.
+    void setRouting(const std::vector<RoutingEntry>& entries);
+    // Set a routing table built elsewhere (e.g. by NetworkDescription).
+    void setRouting(RoutingTable table);
+
+    const RoutingTable& getRouting() const { return routing; }
+
     // Start the network by starting all nodes.
     void start();
 
     // Called by a node (via the wrapper) when a departure occurs.
-    // currentTime is the simulation time at departure.
-    void routeCustomer(int fromNodeId, double currentTime);
+    // currentTime is the simulation time at departure; originTime is when
+    // the departing customer entered the network (NaN if not tracked).
+    void routeCustomer(int fromNodeId, double currentTime,
+        double originTime = std::numeric_limits<double>::quiet_NaN());
+
+    // Track customers across hops (off by default). Every node, including
+    // nodes added later, records its own waiting and sojourn times (see
+    // MM1Queue::enableCustomerTracking), and the network records the time
+    // from a customer's external arrival to its exit from the network.
+    // Customers routed to remote nodes are not followed.
+    void enableCustomerTracking(int precisionBits = QuantileSketch::defaultPrecisionBits);
+    // End-to-end sojourn times, or nullptr if tracking is off.
+    const QuantileSketch* getSojournTimes() const { return sojournTimes.get(); }
+    // Empty the end-to-end sketch (e.g. at the end of the warm-up period).
+    void resetSojournTimes();
+
+    // Called by a node for a routed arrival: the network entry time of the
+    // customer arriving at nodeId now, or NaN if it is not known.
+    double takeRoutedOrigin(int nodeId, double currentTime);
+
+    // True if every node is simulated here (no remote nodes) and every
+    // routing row holds probabilities summing to at most one: the network
+    // is then an open Jackson network and solveProductForm is exact.
+    bool isProductForm() const;
+
+    // Steady state from the traffic equations and the M/M/s formulas per
+    // node (see ProductForm.h), using the nodes' current server counts.
+    // Check NetworkSolution::stable(): unstable nodes have infinite metrics.
+    NetworkSolution solveProductForm() const;
+
+    // Compare each node's simulated average number in system, since its last
+    // statistics reset, with the analytic solution. A single run gives no
+    // confidence interval, so a node is consistent if its relative error is
+    // at most relativeTolerance; for replications use validateSimulation
+    // with the ReplicationRunner summaries.
+    std::vector<NodeValidation> validateAgainstProductForm(double relativeTolerance = 0.05) const;
 
     // Optionally, provide access to a node.
     QueueModel* getNode(int nodeId);
 
+    // Number of nodes, including remote ones.
+    int getNodeCount() const;
+
+    // Checkpointing: the nodes, their state, the routing entries and the
+    // routing streams. Restoring into an empty network creates the nodes;
+    // otherwise the existing nodes must be of the same kinds.
+    void saveState(CheckpointWriter& out) const;
+    void restoreState(CheckpointReader& in);
+
 private:
+    friend class Checkpoint;  // Empties a network again when a restore into it is rejected.
+
     Simulation& sim;
     std::vector<QueueModel*> nodes;  // Stores pointers to our Jackson queue nodes.
-    std::vector<std::vector<double>> routingMatrix;
-    std::default_random_engine rng;
+    // Sparse routing rows with an alias table each (see RoutingTable).
+    RoutingTable routing;
+    // Routing draws for the customers leaving each node, one stream per
+    // node so that runs under different configurations share them.
+    std::vector<RandomStream> routingStreams;
+    std::function<void(int nodeId, double arrivalTime)> remoteRouter;
+
+    // Customer tracking: the end-to-end sketch (null when off) and, per
+    // node, the arrival and network entry times of the customers routed
+    // there and not yet arrived, in arrival order.
+    struct RoutedCustomer {
+        double arrivalTime;
+        double originTime;
+    };
+    std::unique_ptr<QuantileSketch> sojournTimes;
+    std::vector<RingQueue<RoutedCustomer>> routedCustomers;
+    int trackingPrecisionBits = QuantileSketch::defaultPrecisionBits;
+
+    void enableNodeTracking(QueueModel* node);
+    // Delete every node, the routing and the routing streams.
+    void removeNodes();
 
     int node0to1Counter = 0;
     int node1to0Counter = 0;
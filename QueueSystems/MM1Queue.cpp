@@ -1,23 +1,24 @@
 #include "MM1Queue.h"
 #include "QueueEvents.h"
+#include "Checkpoint.h"
 #include <limits>
+#include <cmath>
 #include <algorithm>
 
 MM1Queue::MM1Queue(Simulation& sim, double arrivalRate, double serviceRate)
     : sim(sim), lambda(arrivalRate), mu(serviceRate),
-    numInSystem(0), rng(std::random_device{}()),
-    serviceDist(serviceRate),
+    numInSystem(0), arrivalVariates(sim.nextRandomStream()), serviceVariates(sim.nextRandomStream()),
+    arrivalMean(arrivalRate > 0 ? 1.0 / arrivalRate : std::numeric_limits<double>::infinity()),
+    serviceMean(1.0 / serviceRate),
     totalArrivals(0), totalDepartures(0),
-    cumulativeTimeWeightedCustomers(0.0), lastEventTime(0.0)
+    cumulativeTimeWeightedCustomers(0.0), lastEventTime(0.0), statisticsStart(0.0),
+    servingCustomer(CustomerTracker::noCustomer)
 {
-    if (lambda > 0) {
-        arrivalDist.emplace(lambda);
-    }
 }
 
 double MM1Queue::getNextInterarrivalTime() {
-    if (arrivalDist.has_value()) {
-        return (*arrivalDist)(rng);
+    if (std::isfinite(arrivalMean)) {
+        return arrivalVariates.next(arrivalMean);
     }
     return std::numeric_limits<double>::infinity();
 }
@@ -25,7 +26,7 @@ double MM1Queue::getNextInterarrivalTime() {
 void MM1Queue::start() {
     double firstArrivalTime = sim.getCurrentTime() + getNextInterarrivalTime();
     if (std::isfinite(firstArrivalTime)) {
-        sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(firstArrivalTime, this));
+        scheduleExternalArrival(sim, firstArrivalTime);
     }
 }
 
@@ -34,17 +35,20 @@ void MM1Queue::handleExternalArrival(Simulation& sim) {
     updateMetrics(currentTime);
     totalArrivals++;
     numInSystem++;
+    stateChanged(currentTime);
+    if (customers)
+        trackArrival(currentTime);
 
     // Schedule the next external arrival.
     double nextArrivalTime = currentTime + getNextInterarrivalTime();
     if (std::isfinite(nextArrivalTime)) {
-        sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(nextArrivalTime, this));
+        scheduleExternalArrival(sim, nextArrivalTime);
     }
 
     // If server was idle, schedule a departure.
     if (numInSystem == 1) {
-        double departureTime = currentTime + serviceDist(rng);
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        double departureTime = currentTime + serviceVariates.next(serviceMean);
+        scheduleDeparture(sim, departureTime);
     }
 }
 
@@ -53,11 +57,14 @@ void MM1Queue::handleInternalArrival(Simulation& sim) {
     updateMetrics(currentTime);
     totalArrivals++;
     numInSystem++;
+    stateChanged(currentTime);
+    if (customers)
+        trackArrival(currentTime);
 
     // Note: Do not schedule the next external arrival.
     if (numInSystem == 1) {
-        double departureTime = currentTime + serviceDist(rng);
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        double departureTime = currentTime + serviceVariates.next(serviceMean);
+        scheduleDeparture(sim, departureTime);
     }
 }
 
@@ -66,15 +73,33 @@ void MM1Queue::handleDeparture(Simulation& sim) {
     updateMetrics(currentTime);
     totalDepartures++;
     numInSystem--;
+    stateChanged(currentTime);
+    if (customers)
+        trackDeparture(currentTime);
 
     if (numInSystem > 0) {
-        double departureTime = currentTime + serviceDist(rng);
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        double departureTime = currentTime + serviceVariates.next(serviceMean);
+        scheduleDeparture(sim, departureTime);
     }
 }
 
 double MM1Queue::getAverageNumberInSystem() const {
-    return (lastEventTime > 0) ? cumulativeTimeWeightedCustomers / lastEventTime : 0.0;
+    double elapsed = lastEventTime - statisticsStart;
+    return (elapsed > 0) ? cumulativeTimeWeightedCustomers / elapsed : 0.0;
+}
+
+double MM1Queue::getTimeWeightedCustomers(double time) const {
+    return cumulativeTimeWeightedCustomers + numInSystem * (time - lastEventTime);
+}
+
+void MM1Queue::resetStatistics(double time) {
+    updateMetrics(time);
+    cumulativeTimeWeightedCustomers = 0.0;
+    totalArrivals = 0;
+    totalDepartures = 0;
+    statisticsStart = time;
+    if (customers)
+        customers->resetStatistics();
 }
 
 int MM1Queue::getTotalArrivals() const {
@@ -85,8 +110,57 @@ int MM1Queue::getTotalDepartures() const {
     return totalDepartures;
 }
 
+void MM1Queue::saveState(CheckpointWriter& out) const {
+    out.write(numInSystem);
+    out.write(totalArrivals);
+    out.write(totalDepartures);
+    out.write(cumulativeTimeWeightedCustomers);
+    out.write(lastEventTime);
+    out.write(statisticsStart);
+    out.write(arrivalVariates);
+    out.write(serviceVariates);
+}
+
+void MM1Queue::restoreState(CheckpointReader& in) {
+    numInSystem = in.read<int>();
+    totalArrivals = in.read<int>();
+    totalDepartures = in.read<int>();
+    cumulativeTimeWeightedCustomers = in.read<double>();
+    lastEventTime = in.read<double>();
+    statisticsStart = in.read<double>();
+    in.read(arrivalVariates);
+    in.read(serviceVariates);
+    if (customers)
+        trackUnknownCustomers();
+}
+
 void MM1Queue::updateMetrics(double currentTime) {
     double interval = currentTime - lastEventTime;
     cumulativeTimeWeightedCustomers += numInSystem * interval;
     lastEventTime = currentTime;
 }
+
+void MM1Queue::enableCustomerTracking(int precisionBits) {
+    customers = std::make_unique<CustomerTracker>(precisionBits);
+    trackUnknownCustomers();
+}
+
+void MM1Queue::trackArrival(double currentTime) {
+    customers->arrive(currentTime);
+    if (numInSystem == 1)
+        servingCustomer = customers->startService(currentTime);
+}
+
+void MM1Queue::trackDeparture(double currentTime) {
+    customers->depart(servingCustomer, currentTime);
+    servingCustomer = customers->startService(currentTime);
+}
+
+void MM1Queue::trackUnknownCustomers() {
+    customers->clearCustomers();
+    servingCustomer = CustomerTracker::noCustomer;
+    if (numInSystem > 0)
+        servingCustomer = customers->unknownInService();
+    for (int i = 1; i < numInSystem; i++)
+        customers->arriveUnknown();
+}
@@ -5,6 +5,8 @@
 #include "QueueModel.h"
 #include "QueueEvents.h"
 #include "Observable.h"
+#include "CustomerTracker.h"
+#include "ExponentialVariates.h"
 #include <random>
 #include <vector>
 #include <memory>
@@ -33,28 +35,64 @@ public:
     int getTotalArrivals() const;
     int getTotalDepartures() const;
 
+    // Area under the number-in-system curve from the last statistics reset up to time.
+    double getTimeWeightedCustomers(double time) const;
+
+    // Restart the statistics at time (e.g. at the end of the warm-up period).
+    // The queue's state is kept.
+    void resetStatistics(double time);
+
     // Helper for obtaining next interarrival time.
     double getNextInterarrivalTime();
 
+    double getArrivalRate() const { return lambda; }
+    double getServiceRate() const { return mu; }
+
+    // Record every customer's waiting and sojourn time (off by default).
+    // Customers already in the queue are tracked with unknown times.
+    void enableCustomerTracking(int precisionBits = QuantileSketch::defaultPrecisionBits);
+    // The customer records and latency sketches, or nullptr if tracking is off.
+    const CustomerTracker* getCustomerTracker() const { return customers.get(); }
+
+    // Checkpointing. Customer records are not saved; with tracking enabled,
+    // the customers present at the checkpoint are restored with unknown times.
+    virtual void saveState(CheckpointWriter& out) const override;
+    virtual void restoreState(CheckpointReader& in) override;
+
 protected:
     Simulation& sim;
     double lambda;  // External arrival rate
     double mu;      // Service rate
     int numInSystem;
 
-    std::default_random_engine rng;
-    // Use std::optional to handle zero arrival rate.
-    std::optional<std::exponential_distribution<double>> arrivalDist;
-    std::exponential_distribution<double> serviceDist;
+    // Interarrival and service times, drawn in blocks. Each has a stream of
+    // its own, so that a change to one does not shift the other when runs
+    // under different configurations share random numbers.
+    ExponentialVariates arrivalVariates;
+    ExponentialVariates serviceVariates;
+    double arrivalMean;  // 1 / lambda, or infinity when there are no external arrivals.
+    double serviceMean;  // 1 / mu.
 
     // Metrics for statistics.
     int totalArrivals;
     int totalDepartures;
     double cumulativeTimeWeightedCustomers;
     double lastEventTime;
+    double statisticsStart;  // Time of the last statistics reset.
+
+    // Customer tracking (null when off) and the customer being served.
+    std::unique_ptr<CustomerTracker> customers;
+    CustomerTracker::Id servingCustomer;
 
     // Helper to update metrics.
     void updateMetrics(double currentTime);
+
+    // Customer tracking for an arrival and a departure.
+    void trackArrival(double currentTime);
+    void trackDeparture(double currentTime);
+
+    // Track the customers in the queue with unknown arrival times.
+    void trackUnknownCustomers();
 };
 
 #endif // MM1QUEUE_H
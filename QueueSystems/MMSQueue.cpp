@@ -1,25 +1,45 @@
 #include "MMSQueue.h"
 #include "QueueEvents.h"
+#include "Checkpoint.h"
 #include <limits>
+#include <cmath>
 #include <algorithm>
 
+namespace {
+    // The stream that picks departing tracked customers, derived from the
+    // service stream so that nothing is taken from the simulation. A jump
+    // would land on the start of another stream the simulation hands out,
+    // so the state is hashed into a fresh seed instead.
+    RandomStream departureChoiceStream(const RandomStream::State& service) {
+        std::uint64_t seed = 0;
+        for (std::uint64_t word : service)
+            seed = (seed ^ word) * 0x9e3779b97f4a7c15ULL;
+        return RandomStream(seed);
+    }
+}
+
 MMSQueue::MMSQueue(Simulation& sim, double arrivalRate, double serviceRate, int servers)
     : sim(sim), lambda(arrivalRate), mu(serviceRate), servers(servers),
-    numInSystem(0), busyServers(0),
-    rng(std::random_device{}()),
-    serviceDist(serviceRate),
+    numInSystem(0), busyServers(0), aggregateDepartures(false), aggregateServing(0),
+    arrivalVariates(sim.nextRandomStream()), serviceVariates(sim.nextRandomStream()),
+    arrivalMean(arrivalRate > 0 ? 1.0 / arrivalRate : std::numeric_limits<double>::infinity()),
+    serviceMean(1.0 / serviceRate),
     totalArrivals(0), totalDepartures(0),
-    cumulativeTimeWeightedCustomers(0.0), lastEventTime(0.0)
+    cumulativeTimeWeightedCustomers(0.0), lastEventTime(0.0), statisticsStart(0.0),
+    departingCustomer(CustomerTracker::noCustomer)
 {
-    // Only create the arrival distribution if lambda > 0.
-    if (lambda > 0) {
-        arrivalDist.emplace(lambda);
+    departureChoices = departureChoiceStream(serviceVariates.getState().stream);
+
+    // All servers start out free.
+    serverDepartures.resize(servers);
+    for (int server = servers - 1; server >= 0; server--) {
+        freeServers.push_back(server);
     }
 }
 
 double MMSQueue::getNextInterarrivalTime() {
-    if (arrivalDist.has_value()) {
-        return (*arrivalDist)(rng);
+    if (std::isfinite(arrivalMean)) {
+        return arrivalVariates.next(arrivalMean);
     }
     return std::numeric_limits<double>::infinity();
 }
@@ -28,7 +48,7 @@ void MMSQueue::start() {
     double firstArrivalTime = sim.getCurrentTime() + getNextInterarrivalTime();
     if (std::isfinite(firstArrivalTime)) {
         // Schedule the first external arrival.
-        sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(firstArrivalTime, this));
+        scheduleExternalArrival(sim, firstArrivalTime);
     }
 }
 
@@ -37,18 +57,21 @@ void MMSQueue::handleExternalArrival(Simulation& sim) {
     updateMetrics(currentTime);
     totalArrivals++;
     numInSystem++;
+    stateChanged(currentTime);
+    if (customers)
+        customers->arrive(currentTime);
 
     // If a server is idle, start service immediately.
     if (busyServers < servers) {
-        busyServers++;
-        double departureTime = currentTime + serviceDist(rng);
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        startService(sim, currentTime);
+        if (aggregateDepartures)
+            updateAggregateDeparture(currentTime);
     }
 
     // Schedule the next external arrival.
     double nextArrivalTime = currentTime + getNextInterarrivalTime();
     if (std::isfinite(nextArrivalTime)) {
-        sim.scheduleEvent(std::make_shared<ExternalArrivalEvent>(nextArrivalTime, this));
+        scheduleExternalArrival(sim, nextArrivalTime);
     }
 }
 
@@ -57,20 +80,45 @@ void MMSQueue::handleInternalArrival(Simulation& sim) {
     updateMetrics(currentTime);
     totalArrivals++;
     numInSystem++;
+    stateChanged(currentTime);
+    if (customers)
+        customers->arrive(currentTime);
 
     // For an internal (routed) arrival, do not schedule the next external arrival.
     if (busyServers < servers) {
-        busyServers++;
-        double departureTime = currentTime + serviceDist(rng);
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        startService(sim, currentTime);
+        if (aggregateDepartures)
+            updateAggregateDeparture(currentTime);
+    }
+}
+
+void MMSQueue::completeService(Simulation& sim, int server) {
+    releaseServer(server);
+    handleDeparture(sim);
+}
+
+void MMSQueue::releaseServer(int server) {
+    // The server's departure event has fired; it no longer has one pending.
+    serverDepartures[server] = EventHandle();
+    freeServers.push_back(server);
+    if (customers) {
+        departingCustomer = serverCustomers[server];
+        serverCustomers[server] = CustomerTracker::noCustomer;
     }
 }
 
 void MMSQueue::handleDeparture(Simulation& sim) {
     double currentTime = sim.getCurrentTime();
+    if (aggregateDepartures)
+        takeAggregateDeparture();
     updateMetrics(currentTime);
     totalDepartures++;
     numInSystem--;
+    stateChanged(currentTime);
+    if (customers) {
+        customers->depart(departingCustomer, currentTime);
+        departingCustomer = CustomerTracker::noCustomer;
+    }
 
     // A departure frees a busy server.
     if (busyServers > 0) {
@@ -79,14 +127,35 @@ void MMSQueue::handleDeparture(Simulation& sim) {
 
     // If there are waiting customers (numInSystem > busyServers) and an idle server is available, start service.
     if (numInSystem > busyServers && busyServers < servers) {
-        busyServers++;
-        double departureTime = currentTime + serviceDist(rng);
-        sim.scheduleEvent(std::make_shared<GenericDepartureEvent>(departureTime, this));
+        startService(sim, currentTime);
     }
+    if (aggregateDepartures)
+        updateAggregateDeparture(currentTime);
 }
 
 double MMSQueue::getAverageNumberInSystem() const {
-    return (lastEventTime > 0) ? cumulativeTimeWeightedCustomers / lastEventTime : 0.0;
+    double elapsed = lastEventTime - statisticsStart;
+    return (elapsed > 0) ? cumulativeTimeWeightedCustomers / elapsed : 0.0;
+}
+
+double MMSQueue::getTimeWeightedCustomers(double time) const {
+    return cumulativeTimeWeightedCustomers + numInSystem * (time - lastEventTime);
+}
+
+void MMSQueue::resetStatistics(double time) {
+    updateMetrics(time);
+    cumulativeTimeWeightedCustomers = 0.0;
+    totalArrivals = 0;
+    totalDepartures = 0;
+    statisticsStart = time;
+    if (customers)
+        customers->resetStatistics();
+}
+
+void MMSQueue::setRandomStreams(const RandomStream& arrivals, const RandomStream& service) {
+    arrivalVariates = ExponentialVariates(arrivals);
+    serviceVariates = ExponentialVariates(service);
+    departureChoices = departureChoiceStream(service.getState());
 }
 
 int MMSQueue::getTotalArrivals() const {
@@ -97,8 +166,235 @@ int MMSQueue::getTotalDepartures() const {
     return totalDepartures;
 }
 
+void MMSQueue::saveState(CheckpointWriter& out) const {
+    out.write(servers);
+    out.write(numInSystem);
+    out.write(busyServers);
+    out.writeVector(freeServers);
+    out.write(totalArrivals);
+    out.write(totalDepartures);
+    out.write(cumulativeTimeWeightedCustomers);
+    out.write(lastEventTime);
+    out.write(statisticsStart);
+    out.write(arrivalVariates);
+    out.write(serviceVariates);
+    out.write(departureChoices);
+    out.write(aggregateDepartures);
+}
+
+void MMSQueue::restoreState(CheckpointReader& in) {
+    servers = in.read<int>();
+    numInSystem = in.read<int>();
+    busyServers = in.read<int>();
+    freeServers = in.readVector<int>();
+    totalArrivals = in.read<int>();
+    totalDepartures = in.read<int>();
+    cumulativeTimeWeightedCustomers = in.read<double>();
+    lastEventTime = in.read<double>();
+    statisticsStart = in.read<double>();
+    in.read(arrivalVariates);
+    in.read(serviceVariates);
+    in.read(departureChoices);
+    aggregateDepartures = in.read<bool>();
+
+    if (servers < 0 || (aggregateDepartures && !freeServers.empty())
+        || std::any_of(freeServers.begin(), freeServers.end(),
+            [this](int server) { return server < 0 || server >= servers; })) {
+        in.fail();
+        servers = 0;
+        freeServers.clear();
+    }
+    // The pending departures are filled in by restoreEvent.
+    serverDepartures.assign(aggregateDepartures ? 0 : servers, EventHandle());
+    aggregateDeparture = EventHandle();
+    aggregateServing = 0;
+    if (customers)
+        trackUnknownCustomers();
+}
+
+void MMSQueue::restoreEvent(const StaticQueueEvent& event, const EventHandle& handle) {
+    if (aggregateDepartures) {
+        if (event.type == QueueEventType::Departure) {
+            aggregateDeparture = handle;
+            aggregateServing = servingServers();
+        }
+    }
+    else if (event.type == QueueEventType::ServiceCompletion && event.server >= 0 && event.server < servers) {
+        serverDepartures[event.server] = handle;
+        if (customers)
+            serverCustomers[event.server] = customers->unknownInService();
+    }
+}
+
+bool MMSQueue::acceptsEvent(QueueEventType type, int server) const {
+    if (type == QueueEventType::ServiceCompletion)
+        return server >= 0 && server < servers;
+    return QueueModel::acceptsEvent(type, server);
+}
+
+void MMSQueue::enableCustomerTracking(int precisionBits) {
+    customers = std::make_unique<CustomerTracker>(precisionBits);
+    trackUnknownCustomers();
+    if (aggregateDepartures)
+        return;
+    for (int server = 0; server < servers; server++) {
+        if (serverDepartures[server].isPending())
+            serverCustomers[server] = customers->unknownInService();
+    }
+}
+
+void MMSQueue::trackUnknownCustomers() {
+    customers->clearCustomers();
+    departingCustomer = CustomerTracker::noCustomer;
+    if (aggregateDepartures) {
+        serverCustomers.clear();
+        for (int i = 0; i < servingServers(); i++)
+            serverCustomers.push_back(customers->unknownInService());
+    }
+    else
+        serverCustomers.assign(servers, CustomerTracker::noCustomer);
+    for (int i = busyServers; i < numInSystem; i++)
+        customers->arriveUnknown();
+}
+
 void MMSQueue::updateMetrics(double currentTime) {
     double interval = currentTime - lastEventTime;
     cumulativeTimeWeightedCustomers += numInSystem * interval;
     lastEventTime = currentTime;
 }
+
+void MMSQueue::startService(Simulation& sim, double currentTime) {
+    if (aggregateDepartures) {
+        busyServers++;
+        if (customers)
+            serverCustomers.push_back(customers->startService(currentTime));
+        return;
+    }
+    int server = freeServers.back();
+    freeServers.pop_back();
+    busyServers++;
+    if (customers)
+        serverCustomers[server] = customers->startService(currentTime);
+    double departureTime = currentTime + serviceVariates.next(serviceMean);
+    serverDepartures[server] = sim.scheduleEvent(departureTime,
+        StaticQueueEvent{ QueueEventType::ServiceCompletion, server, getDispatchRef() });
+}
+
+void MMSQueue::setServers(int newServers) {
+    double currentTime = sim.getCurrentTime();
+    updateMetrics(currentTime);
+
+    if (aggregateDepartures) {
+        // Any customers in service can be the ones preempted; servers
+        // holding a blocked customer (CANQueue) stay busy, as they do with
+        // per-server departures.
+        for (; busyServers > newServers && servingServers() > 0; busyServers--) {
+            if (customers) {
+                customers->requeue(serverCustomers.back());
+                serverCustomers.pop_back();
+            }
+        }
+        servers = newServers;
+        while (numInSystem > busyServers && busyServers < servers)
+            startService(sim, currentTime);
+        updateAggregateDeparture(currentTime);
+        return;
+    }
+
+    // Preempt the customers served by removed servers.
+    for (int server = newServers; server < static_cast<int>(serverDepartures.size()); server++) {
+        if (serverDepartures[server].cancel()) {
+            busyServers--;
+            if (customers)
+                customers->requeue(serverCustomers[server]);
+        }
+    }
+    servers = newServers;
+    serverDepartures.resize(servers);
+    if (customers)
+        serverCustomers.resize(servers, CustomerTracker::noCustomer);
+
+    freeServers.clear();
+    for (int server = servers - 1; server >= 0; server--) {
+        if (!serverDepartures[server].isPending()) {
+            freeServers.push_back(server);
+        }
+    }
+
+    // Added servers pick up waiting customers.
+    while (numInSystem > busyServers && busyServers < servers && !freeServers.empty()) {
+        startService(sim, currentTime);
+    }
+}
+
+void MMSQueue::updateAggregateDeparture(double currentTime) {
+    int serving = servingServers();
+    if (serving == aggregateServing && (serving <= 0 || aggregateDeparture.isPending()))
+        return;
+    aggregateServing = serving;
+    if (serving <= 0) {
+        aggregateDeparture.cancel();
+        return;
+    }
+    // The first of serving exponential service times to end.
+    double departureTime = currentTime + serviceVariates.next(serviceMean / serving);
+    if (!aggregateDeparture.reschedule(departureTime))
+        aggregateDeparture = scheduleDeparture(sim, departureTime);
+}
+
+void MMSQueue::takeAggregateDeparture() {
+    aggregateDeparture = EventHandle();
+    if (customers && !serverCustomers.empty()) {
+        // Every customer in service is equally likely to be the one leaving.
+        std::size_t count = serverCustomers.size();
+        std::size_t index = std::min(static_cast<std::size_t>(departureChoices.nextUniform() * count), count - 1);
+        departingCustomer = serverCustomers[index];
+        serverCustomers[index] = serverCustomers.back();
+        serverCustomers.pop_back();
+    }
+}
+
+void MMSQueue::setAggregateDepartures(bool enabled) {
+    if (enabled == aggregateDepartures)
+        return;
+    double currentTime = sim.getCurrentTime();
+    // Remaining service times are exponential whatever the time already
+    // served, so the customers in service carry over with fresh draws.
+    if (enabled) {
+        std::vector<CustomerTracker::Id> inService;
+        for (int server = 0; server < static_cast<int>(serverDepartures.size()); server++) {
+            if (serverDepartures[server].cancel() && customers)
+                inService.push_back(serverCustomers[server]);
+        }
+        serverDepartures.clear();
+        freeServers.clear();
+        if (customers)
+            serverCustomers = std::move(inService);
+        aggregateDepartures = true;
+        aggregateServing = 0;
+        updateAggregateDeparture(currentTime);
+        return;
+    }
+
+    aggregateDeparture.cancel();
+    aggregateDeparture = EventHandle();
+    aggregateServing = 0;
+    aggregateDepartures = false;
+    std::vector<CustomerTracker::Id> inService;
+    if (customers)
+        inService = std::move(serverCustomers);
+    serverDepartures.assign(servers, EventHandle());
+    if (customers)
+        serverCustomers.assign(servers, CustomerTracker::noCustomer);
+    freeServers.clear();
+    for (int server = servers - 1; server >= 0; server--)
+        freeServers.push_back(server);
+    for (int i = 0; i < servingServers(); i++) {
+        int server = freeServers.back();
+        freeServers.pop_back();
+        if (customers && i < static_cast<int>(inService.size()))
+            serverCustomers[server] = inService[i];
+        serverDepartures[server] = sim.scheduleEvent(currentTime + serviceVariates.next(serviceMean),
+            StaticQueueEvent{ QueueEventType::ServiceCompletion, server, getDispatchRef() });
+    }
+}
@@ -5,6 +5,8 @@
 #include "QueueModel.h"
 #include "QueueEvents.h"
 #include "Observable.h"
+#include "CustomerTracker.h"
+#include "ExponentialVariates.h"
 #include <random>
 #include <vector>
 #include <memory>
@@ -33,9 +35,65 @@ public:
     int getTotalArrivals() const;
     int getTotalDepartures() const;
 
+    // Area under the number-in-system curve from the last statistics reset up to time.
+    double getTimeWeightedCustomers(double time) const;
+
+    // Restart the statistics at time (e.g. at the end of the warm-up period).
+    // The queue's state is kept.
+    virtual void resetStatistics(double time);
+
     // Helper for obtaining the next interarrival time.
     double getNextInterarrivalTime();
 
+    // Change the number of servers (e.g. a breakdown or repair). When servers
+    // are removed, their in-flight departures are cancelled and the customers
+    // return to the waiting line; with exponential service the remaining
+    // service time does not depend on the time already served.
+    void setServers(int newServers);
+
+    // Called by a ServiceCompletionEvent when the given server finishes.
+    void completeService(Simulation& sim, int server);
+
+    // Mark a server as free after its departure event has fired.
+    void releaseServer(int server);
+
+    // Aggregate departures (off by default): instead of one pending
+    // departure per busy server, keep a single departure event at rate
+    // (servers serving) * mu, redrawn whenever that number changes. With
+    // exponential service the departure process is the same, and the queue
+    // never has more than one pending departure, however many servers it
+    // has. A tracked customer leaving is picked at random among those in
+    // service. May be switched at any time; customers in service carry over.
+    void setAggregateDepartures(bool enabled);
+    bool hasAggregateDepartures() const { return aggregateDepartures; }
+
+    // Replace the interarrival and service streams, e.g. so that copies of
+    // one restored state go on with different random numbers. Variates
+    // already drawn from the old streams are discarded.
+    void setRandomStreams(const RandomStream& arrivals, const RandomStream& service);
+
+    double getArrivalRate() const { return lambda; }
+    double getServiceRate() const { return mu; }
+    int getServers() const { return servers; }
+
+    // Record every customer's waiting and sojourn time (off by default).
+    // Customers are served first come, first served; a customer preempted by
+    // setServers goes back to the head of the line. Customers already in the
+    // queue are tracked with unknown times.
+    void enableCustomerTracking(int precisionBits = QuantileSketch::defaultPrecisionBits);
+    // The customer records and latency sketches, or nullptr if tracking is off.
+    const CustomerTracker* getCustomerTracker() const { return customers.get(); }
+
+    // Checkpointing. The number of servers is part of the saved state
+    // because setServers can change it during a run. Customer records are
+    // not saved; with tracking enabled, the customers present at the
+    // checkpoint are restored with unknown times.
+    virtual void saveState(CheckpointWriter& out) const override;
+    virtual void restoreState(CheckpointReader& in) override;
+    virtual void restoreEvent(const StaticQueueEvent& event, const EventHandle& handle) override;
+    // Also accepts service completions of existing servers.
+    virtual bool acceptsEvent(QueueEventType type, int server) const override;
+
 protected:
     Simulation& sim;
     double lambda;  // External arrival rate.
@@ -45,20 +103,75 @@ protected:
     int numInSystem;  // Total customers (in service + waiting).
     int busyServers;  // Servers currently busy.
 
-    // Random number generators.
-    std::default_random_engine rng;
-    // Use std::optional so that we only create an exponential distribution if lambda > 0.
-    std::optional<std::exponential_distribution<double>> arrivalDist;
-    std::exponential_distribution<double> serviceDist;
+    // Pending departure of each server, and the servers without one. Both
+    // are empty with aggregate departures.
+    std::vector<EventHandle> serverDepartures;
+    std::vector<int> freeServers;
+
+    // Aggregate departures: the pending departure event, and the number of
+    // servers serving when it was drawn.
+    bool aggregateDepartures;
+    EventHandle aggregateDeparture;
+    int aggregateServing;
+
+    // Interarrival and service times, drawn in blocks. Each has a stream of
+    // its own, so that a change to one does not shift the other when runs
+    // under different configurations share random numbers.
+    ExponentialVariates arrivalVariates;
+    ExponentialVariates serviceVariates;
+    double arrivalMean;  // 1 / lambda, or infinity when there are no external arrivals.
+    double serviceMean;  // 1 / mu.
 
     // Metrics.
     int totalArrivals;
     int totalDepartures;
     double cumulativeTimeWeightedCustomers;
     double lastEventTime;
+    double statisticsStart;  // Time of the last statistics reset.
+
+    // Customer tracking (null when off): the customer served by each server
+    // (with aggregate departures, the customers in service in no particular
+    // order) and the one whose departure is being handled. With aggregate
+    // departures the departing customer is picked with a stream of its own,
+    // derived from the service stream, so that tracking leaves the service
+    // times and the other queues' streams alone.
+    std::unique_ptr<CustomerTracker> customers;
+    std::vector<CustomerTracker::Id> serverCustomers;
+    CustomerTracker::Id departingCustomer;
+    RandomStream departureChoices;
 
     // Helper to update the time-weighted metric.
     void updateMetrics(double currentTime);
+
+    // Track the customers in the queue with unknown arrival times.
+    virtual void trackUnknownCustomers();
+
+    // Put a waiting customer into service on a free server. With aggregate
+    // departures the caller then calls updateAggregateDeparture.
+    void startService(Simulation& sim, double currentTime);
+
+    // Servers working on a customer (CANQueue leaves out those holding a
+    // blocked one); the rate of the aggregate departure is this times mu.
+    virtual int servingServers() const { return busyServers; }
+
+    // Redraw the aggregate departure if the number of serving servers has
+    // changed or it has fired.
+    void updateAggregateDeparture(double currentTime);
+
+    // The aggregate departure has fired: pick the tracked customer leaving.
+    void takeAggregateDeparture();
+};
+
+// Departure from a specific server of an MMSQueue.
+class ServiceCompletionEvent : public Event {
+public:
+    MMSQueue* queue;
+    int server;
+    ServiceCompletionEvent(double time, MMSQueue* q, int server) : Event(time), queue(q), server(server) {}
+
+    virtual void process(Simulation& sim) override {
+        queue->completeService(sim, server);
+    }
 };
 
 #endif // MMSQUEUE_H
@@ -44,11 +44,11 @@ int main() {
 
     // Schedule measurement events on each node (sample every 1 time unit).
     if (auto obs0 = dynamic_cast<Observable*>(network.getNode(node0)))
-        sim.scheduleEvent(std::make_shared<MeasurementEvent>(0.0, obs0, 1.0));
+        sim.scheduleEvent<MeasurementEvent>(0.0, obs0, 1.0);
     if (auto obs1 = dynamic_cast<Observable*>(network.getNode(node1)))
-        sim.scheduleEvent(std::make_shared<MeasurementEvent>(0.0, obs1, 1.0));
+        sim.scheduleEvent<MeasurementEvent>(0.0, obs1, 1.0);
     if (auto obs2 = dynamic_cast<Observable*>(network.getNode(node2)))
-        sim.scheduleEvent(std::make_shared<MeasurementEvent>(0.0, obs2, 1.0));
+        sim.scheduleEvent<MeasurementEvent>(0.0, obs2, 1.0);
 
     // Start the network (each node schedules its first external arrival if applicable).
     network.start();
@@ -0,0 +1,90 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "Checkpoint.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Build the 3-node network from Main.cpp with a configurable service rate at node 0.
+void buildNetwork(JacksonNetwork& network, double serviceRate0) {
+    network.addMM1Queue(4, serviceRate0);
+    network.addMMSQueue(1, 10, 2);
+    network.addMM1Queue(0, 6);
+    network.setRoutingMatrix({
+        { 0.0, 0.2, 0.1 },
+        { 0.2, 0.0, 0.3 },
+        { 0.1, 0.2, 0.0 }
+    });
+}
+
+std::vector<double> averages(JacksonNetwork& network) {
+    std::vector<double> result;
+    for (int node = 0; node < network.getNodeCount(); node++) {
+        QueueModel* queue = network.getNode(node);
+        if (auto mm1 = dynamic_cast<MM1Queue*>(queue))
+            result.push_back(mm1->getAverageNumberInSystem());
+        else if (auto mms = dynamic_cast<MMSQueue*>(queue))
+            result.push_back(mms->getAverageNumberInSystem());
+    }
+    return result;
+}
+
+int main() {
+    const double warmUpTime = 1000.0;
+    const double endTime = 2000.0;
+    const char* path = "warm.ckpt";
+
+    // Warm up once and save the state.
+    Simulation sim;
+    sim.seedRandomStreams(20240801);
+    JacksonNetwork network(sim);
+    buildNetwork(network, 8);
+    network.start();
+    sim.run(warmUpTime);
+
+    Checkpoint checkpoint;
+    checkpoint.add(network);
+    if (!checkpoint.save(sim, path)) {
+        std::cerr << "Error writing " << path << "\n";
+        return 1;
+    }
+    std::vector<double> warm = averages(network);
+    sim.run(endTime);
+    std::vector<double> continued = averages(network);
+
+    // Restoring into an empty network must reproduce the continued run exactly.
+    Simulation restoredSim;
+    JacksonNetwork restored(restoredSim);
+    Checkpoint restoredCheckpoint;
+    restoredCheckpoint.add(restored);
+    if (!restoredCheckpoint.restore(restoredSim, path)) {
+        std::cerr << "Error restoring " << path << "\n";
+        return 1;
+    }
+    restoredSim.run(endTime);
+    std::vector<double> replayed = averages(restored);
+
+    std::cout << "Checkpoint at T = " << warmUpTime << ", runs continued to T = " << endTime << "\n\n";
+    std::cout << std::setprecision(10);
+    for (std::size_t node = 0; node < continued.size(); node++) {
+        std::cout << "Node " << node << ": continued L = " << continued[node]
+                  << ", restored L = " << replayed[node]
+                  << (continued[node] == replayed[node] ? "  (identical)" : "  (DIFFERENT)") << "\n";
+    }
+
+    // What-if experiments forked from the warmed state: vary node 0's service rate.
+    std::cout << std::setprecision(4) << "\nWhat-if on node 0 (L over the second half of the run):\n";
+    for (double serviceRate : { 6.0, 8.0, 12.0 }) {
+        Simulation forkSim;
+        JacksonNetwork fork(forkSim);
+        buildNetwork(fork, serviceRate);
+        Checkpoint forkCheckpoint;
+        forkCheckpoint.add(fork);
+        if (!forkCheckpoint.restore(forkSim, path))
+            return 1;
+        forkSim.run(endTime);
+        double area = averages(fork)[0] * endTime - warm[0] * warmUpTime;
+        std::cout << "  mu = " << std::setw(4) << serviceRate << ": L = " << area / (endTime - warmUpTime) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "JacksonNetwork.h"
+#include "CustomerTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+namespace {
+    void printLatencies(const char* name, const QuantileSketch& sketch) {
+        std::cout << "  " << std::left << std::setw(9) << name << std::right
+                  << " mean " << std::setw(8) << sketch.getMean()
+                  << "  p50 " << std::setw(8) << sketch.quantile(0.50)
+                  << "  p95 " << std::setw(8) << sketch.quantile(0.95)
+                  << "  p99 " << std::setw(8) << sketch.quantile(0.99) << "\n";
+    }
+}
+
+int main() {
+    const double lambda = 4.0, mu = 5.0;
+    const double endTime = 1.0e6;
+    std::cout << std::setprecision(4);
+
+    // M/M/1: the sojourn time is exponential with rate mu - lambda, and the
+    // waiting time exceeds t with probability rho * exp(-(mu - lambda) t).
+    {
+        Simulation sim;
+        sim.seedRandomStreams(20241013);
+        MM1Queue queue(sim, lambda, mu);
+        queue.enableCustomerTracking();
+        queue.start();
+        sim.run(endTime);
+
+        const CustomerTracker& customers = *queue.getCustomerTracker();
+        double rho = lambda / mu;
+        std::cout << "M/M/1 (lambda = " << lambda << ", mu = " << mu << "), T = " << endTime << ", "
+                  << customers.getSojournTimes().getCount() << " customers\n";
+        printLatencies("waiting", customers.getWaitingTimes());
+        printLatencies("sojourn", customers.getSojournTimes());
+        std::cout << "  theory    waiting p95 " << std::log(rho / 0.05) / (mu - lambda)
+                  << ", p99 " << std::log(rho / 0.01) / (mu - lambda)
+                  << "; sojourn p95 " << std::log(20.0) / (mu - lambda)
+                  << ", p99 " << std::log(100.0) / (mu - lambda) << "\n";
+        std::cout << "  " << customers.getPool().capacity() << " customer records, "
+                  << customers.getSojournTimes().getBucketCount() << " sketch buckets\n\n";
+    }
+
+    // M/M/3 at the same load per server.
+    {
+        Simulation sim;
+        sim.seedRandomStreams(20241013);
+        MMSQueue queue(sim, 3 * lambda, mu, 3);
+        queue.enableCustomerTracking();
+        queue.start();
+        sim.run(endTime);
+
+        const CustomerTracker& customers = *queue.getCustomerTracker();
+        std::cout << "M/M/3 (lambda = " << 3 * lambda << ", mu = " << mu << ")\n";
+        printLatencies("waiting", customers.getWaitingTimes());
+        printLatencies("sojourn", customers.getSojournTimes());
+        std::cout << "\n";
+    }
+
+    // Two M/M/1 nodes in tandem with feedback: end-to-end sojourn times.
+    {
+        Simulation sim;
+        sim.seedRandomStreams(20241013);
+        JacksonNetwork network(sim);
+        network.enableCustomerTracking();
+        int first = network.addMM1Queue(2.0, 6.0);
+        int second = network.addMM1Queue(0.0, 5.0);
+        network.setRoutingMatrix({ { 0.0, 1.0 }, { 0.25, 0.0 } });
+        network.start();
+        sim.run(endTime / 10);
+
+        std::cout << "Jackson network, 2 nodes with feedback\n";
+        printLatencies("node 0", static_cast<MM1Queue*>(network.getNode(first))->getCustomerTracker()->getSojournTimes());
+        printLatencies("node 1", static_cast<MM1Queue*>(network.getNode(second))->getCustomerTracker()->getSojournTimes());
+        printLatencies("network", *network.getSojournTimes());
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "Simulation.h"
+#include "CANQueue.h"
+#include "OverflowSplitting.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+
+// Exact blocking probability of the M/M/s/K queue: P(N = K).
+double erlangBlocking(double lambda, double mu, int servers, int capacity) {
+    double a = lambda / mu;
+    double term = 1.0, sum = 1.0, last = 1.0;
+    for (int n = 1; n <= capacity; n++) {
+        term *= a / std::min(n, servers);
+        sum += term;
+        last = term;
+    }
+    return last / sum;
+}
+
+int main() {
+    const double lambda = 1.2, mu = 1.0;
+    const int servers = 2, capacity = 32;
+    const int replications = 20;
+    double exact = erlangBlocking(lambda, mu, servers, capacity);
+
+    std::cout << std::setprecision(4);
+    std::cout << "M/M/" << servers << "/" << capacity << " (lambda = " << lambda << ", mu = " << mu
+              << "), exact blocking probability " << exact << "\n\n";
+
+    // One thread, so that the CPU time is comparable with the plain run.
+    OverflowSplitting splitting(lambda, mu, servers, capacity, 20241016, 1);
+    std::cout << "Levels:";
+    for (int level : splitting.getLevels())
+        std::cout << " " << level;
+    std::cout << "\n";
+
+    auto begin = std::chrono::steady_clock::now();
+    SplittingEstimate estimate = splitting.estimate(replications);
+    double splittingSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "Stage probabilities:";
+    for (double p : estimate.levelProbabilities)
+        std::cout << " " << p;
+    std::cout << "\nSplitting, " << replications << " replications: " << estimate.blockingProbability.mean
+              << " +/- " << estimate.blockingProbability.halfWidth
+              << " (" << estimate.eventsProcessed << " events, " << splittingSeconds << " s)\n";
+
+    // Plain simulation for the same CPU time.
+    Simulation sim;
+    sim.seedRandomStreams(20241016);
+    CANQueue queue(sim, lambda, mu, servers, capacity);
+    queue.start();
+    begin = std::chrono::steady_clock::now();
+    double plainSeconds = 0.0;
+    for (double end = 1.0e5; plainSeconds < splittingSeconds; end += 1.0e5) {
+        sim.run(end);
+        plainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    double attempts = double(queue.getTotalArrivals()) + queue.getTotalRejections();
+    std::cout << "Plain simulation, same CPU time: " << queue.getTotalRejections() << " rejections in "
+              << attempts << " arrivals (" << sim.getEventsProcessed() << " events)\n";
+
+    // Arrivals a plain run needs for the splitting's relative half-width:
+    // the blocking indicator has relative variance (1 - p) / p per arrival.
+    double relativeHalfWidth = estimate.blockingProbability.halfWidth / estimate.blockingProbability.mean;
+    double arrivalsNeeded = std::pow(1.96 / relativeHalfWidth, 2) * (1.0 - exact) / exact;
+    double plainCpuNeeded = arrivalsNeeded / (attempts / plainSeconds);
+    std::cout << "Plain simulation would need about " << arrivalsNeeded << " arrivals ("
+              << plainCpuNeeded / 3600.0 << " CPU hours) for +/- " << 100.0 * relativeHalfWidth
+              << "%, " << plainCpuNeeded / splittingSeconds << " times the splitting's CPU time.\n";
+    return 0;
+}
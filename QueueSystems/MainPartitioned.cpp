@@ -0,0 +1,92 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "PartitionedJacksonNetwork.h"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <functional>
+
+// Random open network: every node has external arrivals at rate 1 and
+// routes half of its departures to a few random successors. Service rates
+// are chosen so that every node runs at 70% utilization.
+struct RandomNetwork {
+    std::vector<double> arrivalRates;
+    std::vector<double> serviceRates;
+    std::vector<std::vector<double>> routing;
+
+    explicit RandomNetwork(int nodes, unsigned seed) : arrivalRates(nodes, 1.0), serviceRates(nodes), routing(nodes, std::vector<double>(nodes, 0.0)) {
+        std::default_random_engine rng(seed);
+        std::uniform_int_distribution<int> pick(0, nodes - 1);
+        for (int i = 0; i < nodes; i++) {
+            for (int k = 0; k < 5; k++)
+                routing[i][pick(rng)] += 0.1;
+        }
+        // Solve the traffic equations by fixed-point iteration.
+        std::vector<double> lambda(arrivalRates);
+        for (int iteration = 0; iteration < 200; iteration++) {
+            std::vector<double> next(arrivalRates);
+            for (int i = 0; i < nodes; i++)
+                for (int j = 0; j < nodes; j++)
+                    next[j] += lambda[i] * routing[i][j];
+            lambda.swap(next);
+        }
+        for (int i = 0; i < nodes; i++)
+            serviceRates[i] = lambda[i] / 0.7;
+    }
+};
+
+double averageOverNodes(int nodes, const std::function<QueueModel*(int)>& getNode) {
+    double total = 0.0;
+    for (int i = 0; i < nodes; i++) {
+        if (auto mm1 = dynamic_cast<MM1Queue*>(getNode(i)))
+            total += mm1->getAverageNumberInSystem();
+    }
+    return total / nodes;
+}
+
+int main(int argc, char* argv[]) {
+    int nodes = (argc > 1) ? std::atoi(argv[1]) : 1000;
+    double endTime = (argc > 2) ? std::atof(argv[2]) : 200.0;
+    int partitions = (argc > 3) ? std::atoi(argv[3]) : static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    RandomNetwork model(nodes, 42);
+
+    // Sequential run.
+    Simulation sim;
+    sim.seedRandomStreams(1);
+    JacksonNetwork network(sim);
+    for (int i = 0; i < nodes; i++)
+        network.addMM1Queue(model.arrivalRates[i], model.serviceRates[i]);
+    network.setRoutingMatrix(model.routing);
+    network.start();
+    auto begin = std::chrono::steady_clock::now();
+    sim.run(endTime);
+    double sequentialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double sequentialL = averageOverNodes(nodes, [&](int i) { return network.getNode(i); });
+
+    // Partitioned run.
+    PartitionedJacksonNetwork partitioned(partitions, 2);
+    for (int i = 0; i < nodes; i++)
+        partitioned.addMM1Queue(model.arrivalRates[i], model.serviceRates[i]);
+    partitioned.setRoutingMatrix(model.routing);
+    begin = std::chrono::steady_clock::now();
+    partitioned.run(endTime);
+    double partitionedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double partitionedL = averageOverNodes(nodes, [&](int i) { return partitioned.getNode(i); });
+
+    std::cout << "Random Jackson network: " << nodes << " nodes, T = " << endTime
+              << ", utilization 0.7 (theory L = 2.333 per node)\n\n";
+    std::cout << "Sequential:\n";
+    std::cout << "  Events: " << sim.getEventsProcessed() << "\n";
+    std::cout << "  Wall time (s): " << sequentialSeconds << "\n";
+    std::cout << "  Mean Average Number in System per node: " << sequentialL << "\n\n";
+    std::cout << "Partitioned (" << partitions << " partitions):\n";
+    std::cout << "  Events: " << partitioned.getEventsProcessed() << "\n";
+    std::cout << "  Cross-partition messages: " << partitioned.getCrossPartitionMessages() << "\n";
+    std::cout << "  Time windows: " << partitioned.getWindows() << "\n";
+    std::cout << "  Wall time (s): " << partitionedSeconds << "\n";
+    std::cout << "  Mean Average Number in System per node: " << partitionedL << "\n";
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "ReplicationRunner.h"
+#include "ProductForm.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+
+// The 3-node network from Main.cpp.
+void buildNetwork(JacksonNetwork& network, int servers) {
+    network.addMM1Queue(4, 8);
+    network.addMMSQueue(1, 10, servers);
+    network.addMM1Queue(0, 6);
+    network.setRoutingMatrix({
+        { 0.0, 0.2, 0.1 },
+        { 0.2, 0.0, 0.3 },
+        { 0.1, 0.2, 0.0 }
+    });
+}
+
+double microsecondsSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void printSolution(const NetworkSolution& solution) {
+    for (std::size_t node = 0; node < solution.nodes.size(); node++) {
+        const NodeSolution& s = solution.nodes[node];
+        std::cout << "  Node " << node << ": lambda " << std::setw(8) << s.arrivalRate
+                  << "  rho " << std::setw(8) << s.utilization << "  L " << std::setw(8) << s.averageNumberInSystem
+                  << "  W " << std::setw(8) << s.averageSojournTime << (s.stable ? "\n" : "  UNSTABLE\n");
+    }
+    std::cout << "  Network: L " << solution.averageNumberInNetwork << ", sojourn time " << solution.averageSojournTime
+              << (solution.stable() ? "\n" : " (unstable)\n");
+}
+
+int main() {
+    const double simulationTime = 10000.0;
+    std::cout << std::setprecision(5);
+
+    // Analytic solution of the 3-node network.
+    Simulation sim;
+    JacksonNetwork network(sim);
+    buildNetwork(network, 2);
+    auto begin = std::chrono::steady_clock::now();
+    NetworkSolution solution = network.solveProductForm();
+    double solveMicroseconds = microsecondsSince(begin);
+    std::cout << "Product-form solution (" << solveMicroseconds << " us, "
+              << solution.iterations << " sweeps), product form: " << (network.isProductForm() ? "yes" : "no") << "\n";
+    printSolution(solution);
+
+    // Validation against 32 replications.
+    ReplicationRunner runner(20241017);
+    std::vector<NodeSummary> summaries = runner.run(32, [=](Simulation& sim) {
+        JacksonNetwork network(sim);
+        buildNetwork(network, 2);
+        network.start();
+        sim.run(simulationTime);
+        std::vector<NodeMetrics> metrics;
+        for (const NodeValidation& node : network.validateAgainstProductForm())
+            metrics.push_back({ node.simulated.mean, 0.0, 0.0 });
+        return metrics;
+    });
+    std::cout << "\nSimulated L, 32 replications of T = " << simulationTime << ":\n";
+    std::vector<NodeValidation> validation = validateSimulation(solution, summaries);
+    for (std::size_t node = 0; node < validation.size(); node++) {
+        std::cout << "  Node " << node << ": " << validation[node].simulated.mean << " +/- "
+                  << validation[node].simulated.halfWidth << " vs " << validation[node].analytic
+                  << (validation[node].consistent ? "  consistent\n" : "  INCONSISTENT\n");
+    }
+
+    // End-to-end sojourn time from one tracked run.
+    {
+        Simulation sim;
+        sim.seedRandomStreams(20241017);
+        JacksonNetwork network(sim);
+        buildNetwork(network, 2);
+        network.enableCustomerTracking();
+        network.start();
+        sim.run(simulationTime);
+        std::cout << "  Network sojourn time: simulated " << network.getSojournTimes()->getMean()
+                  << " vs " << solution.averageSojournTime << "\n";
+    }
+
+    // Unstable configuration: an overloaded fourth node.
+    {
+        Simulation sim;
+        JacksonNetwork network(sim);
+        buildNetwork(network, 1);
+        network.addMM1Queue(0, 0.5);  // Receives 70% of node 2's output.
+        network.setRoutingMatrix({
+            { 0.0, 0.2, 0.1, 0.0 },
+            { 0.2, 0.0, 0.3, 0.0 },
+            { 0.1, 0.2, 0.0, 0.7 }
+        });
+        std::cout << "\nWith an overloaded fourth node:\n";
+        printSolution(network.solveProductForm());
+    }
+
+    // A large sparse network: 20000 single-server nodes, 5 successors each.
+    const int nodeCount = 20000, successors = 5;
+    RandomStream rng(42);
+    std::vector<ProductFormNode> nodes;
+    std::vector<RoutingEntry> routing;
+    for (int node = 0; node < nodeCount; node++) {
+        nodes.push_back({ 0.01 + 0.09 * rng.nextUniform(), 2.0, 1 });
+        for (int k = 0; k < successors; k++)
+            routing.push_back({ node, static_cast<int>(rng() % nodeCount), 0.16 });
+    }
+    begin = std::chrono::steady_clock::now();
+    NetworkSolution large = solveProductForm(nodes, routing, epsilon);
+    double largeMicroseconds = microsecondsSince(begin);
+    std::cout << "\n" << nodeCount << " nodes, " << routing.size() << " routes: solved in " << largeMicroseconds
+              << " us (" << large.iterations << " sweeps), network L " << large.averageNumberInNetwork
+              << ", sojourn time " << large.averageSojournTime << ", " << large.unstableNodes.size()
+              << " unstable nodes\n";
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "Simulation.h"
+#include "SimulationProfiler.h"
+#include "JacksonNetwork.h"
+#include "MeasurementEvent.h"
+#include "StateLogger.h"
+#include <iostream>
+
+// Profile the three-node network of Main.cpp, with a logger sampling each
+// node, and write a trace for chrome://tracing or ui.perfetto.dev. Build
+// with QS_PROFILE defined; otherwise the profiler sees nothing.
+int main() {
+    if (!SimulationProfiler::compiledIn) {
+        std::cout << "Profiling is not compiled in; build with QS_PROFILE defined (e.g. -DQS_PROFILE).\n";
+        return 0;
+    }
+
+    Simulation sim(20241022);
+    SimulationProfiler profiler;
+    sim.setProfiler(&profiler);
+
+    JacksonNetwork network(sim);
+    network.addMM1Queue(4, 8);
+    network.addMMSQueue(1, 10, 2);
+    network.addMM1Queue(0, 6);
+    network.setRoutingMatrix({ { 0.0, 0.2, 0.1 }, { 0.2, 0.0, 0.3 }, { 0.1, 0.2, 0.0 } });
+
+    StateLogger loggers[3];
+    for (int node = 0; node < 3; node++) {
+        auto observable = dynamic_cast<Observable*>(network.getNode(node));
+        observable->attach(&loggers[node]);
+        sim.scheduleEvent<MeasurementEvent>(0.0, observable, 1.0);
+    }
+    network.start();
+
+    // Two runs: a warm-up and the measured period appear as separate spans.
+    sim.run(1000.0);
+    sim.run(200000.0);
+
+    profiler.printSummary(std::cout);
+    if (profiler.writeChromeTrace("profile.json"))
+        std::cout << "\nTrace written to profile.json\n";
+    else
+        std::cerr << "Error writing profile.json\n";
+    return 0;
+}
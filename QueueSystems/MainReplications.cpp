@@ -0,0 +1,83 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "ReplicationRunner.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// One replication of the 3-node network from Main.cpp.
+std::vector<NodeMetrics> runJacksonReplication(Simulation& sim, double simulationTime) {
+    JacksonNetwork network(sim);
+    network.addMM1Queue(4, 8);
+    network.addMMSQueue(1, 10, 2);
+    network.addMM1Queue(0, 6);
+    network.setRoutingMatrix({
+        { 0.0, 0.2, 0.1 },
+        { 0.2, 0.0, 0.3 },
+        { 0.1, 0.2, 0.0 }
+    });
+    network.start();
+    sim.run(simulationTime);
+
+    std::vector<NodeMetrics> metrics;
+    for (int node = 0; node < 3; node++) {
+        QueueModel* queue = network.getNode(node);
+        if (auto mm1 = dynamic_cast<MM1Queue*>(queue)) {
+            metrics.push_back({ mm1->getAverageNumberInSystem(),
+                double(mm1->getTotalArrivals()), double(mm1->getTotalDepartures()) });
+        }
+        else if (auto mms = dynamic_cast<MMSQueue*>(queue)) {
+            metrics.push_back({ mms->getAverageNumberInSystem(),
+                double(mms->getTotalArrivals()), double(mms->getTotalDepartures()) });
+        }
+    }
+    return metrics;
+}
+
+int main() {
+    const std::uint64_t masterSeed = 20240601;
+    const int replications = 64;
+    const double simulationTime = 10000.0;
+
+    auto replication = [simulationTime](Simulation& sim) {
+        return runJacksonReplication(sim, simulationTime);
+    };
+
+    ReplicationRunner runner(masterSeed);
+    std::vector<NodeSummary> summaries = runner.run(replications, replication);
+
+    std::cout << "Jackson Network: " << replications << " replications, T = " << simulationTime
+              << ", master seed " << masterSeed << "\n";
+    std::cout << "95% confidence intervals\n\n";
+    for (std::size_t node = 0; node < summaries.size(); node++) {
+        const NodeSummary& s = summaries[node];
+        std::cout << "Node " << node << ":\n";
+        std::cout << "  Average Number in System: " << s.averageNumberInSystem.mean
+                  << " +/- " << s.averageNumberInSystem.halfWidth << "\n";
+        std::cout << "  Total Arrivals: " << s.totalArrivals.mean << " +/- " << s.totalArrivals.halfWidth << "\n";
+        std::cout << "  Total Departures: " << s.totalDepartures.mean << " +/- " << s.totalDepartures.halfWidth << "\n";
+    }
+
+    // Scaling: wall time for the same replications on 1, 2, 4, ... threads,
+    // and last on every core.
+    std::cout << "\nScaling (" << replications << " replications):\n";
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    double singleThreadSeconds = 0.0;
+    for (unsigned threads = 1; ; threads = std::min(2 * threads, cores)) {
+        ReplicationRunner timed(masterSeed, threads);
+        auto begin = std::chrono::steady_clock::now();
+        timed.run(replications, replication);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if (threads == 1)
+            singleThreadSeconds = seconds;
+        std::cout << "  " << std::setw(3) << threads << " threads: " << std::fixed << std::setprecision(3)
+                  << seconds << " s, speedup " << std::setprecision(2) << singleThreadSeconds / seconds << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+        if (threads == cores)
+            break;
+    }
+    return 0;
+}
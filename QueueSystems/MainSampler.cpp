@@ -0,0 +1,84 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "MeasurementEvent.h"
+#include "NetworkSampler.h"
+#include <iostream>
+#include <chrono>
+
+// Sums every sampled state, one node at a time.
+class SumObserver : public StateObserver {
+public:
+    double sum = 0.0;
+    long long samples = 0;
+    virtual void update(const StateData& data) override {
+        sum += data.state;
+        samples++;
+    }
+};
+
+// Sums every sampled state, one batch of nodes at a time.
+class SumBatchObserver : public SampleBatchObserver {
+public:
+    double sum = 0.0;
+    long long samples = 0;
+    virtual void update(double, const std::vector<int>& states) override {
+        for (int state : states)
+            sum += state;
+        samples += static_cast<long long>(states.size());
+    }
+};
+
+enum class Sampling { PerNode, Periodic, ChangeDriven };
+
+void runNetwork(Sampling sampling, int nodes, double sampleInterval, double endTime) {
+    Simulation sim;
+    sim.seedRandomStreams(20241201);
+    JacksonNetwork network(sim);
+    for (int i = 0; i < nodes; i++)
+        network.addMM1Queue(0.5, 1.0);
+
+    SumObserver nodeSum;
+    SumBatchObserver batchSum;
+    NetworkSampler sampler(sim, sampleInterval,
+        sampling == Sampling::ChangeDriven ? NetworkSampler::Mode::ChangeDriven : NetworkSampler::Mode::Periodic);
+    sampler.attach(&batchSum);
+    for (int node = 0; node < nodes; node++) {
+        Observable* observable = dynamic_cast<Observable*>(network.getNode(node));
+        if (sampling == Sampling::PerNode) {
+            observable->attach(&nodeSum);
+            sim.scheduleEvent<MeasurementEvent>(0.0, observable, sampleInterval);
+        }
+        else {
+            sampler.add(*observable);
+        }
+    }
+    network.start();
+    if (sampling != Sampling::PerNode)
+        sampler.start();
+
+    auto begin = std::chrono::steady_clock::now();
+    sim.run(endTime);
+    sampler.finish(endTime);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    const char* name = sampling == Sampling::PerNode ? "MeasurementEvent per node"
+        : sampling == Sampling::Periodic ? "NetworkSampler, periodic"
+        : "NetworkSampler, change-driven";
+    double sum = sampling == Sampling::PerNode ? nodeSum.sum : batchSum.sum;
+    long long samples = sampling == Sampling::PerNode ? nodeSum.samples : batchSum.samples;
+    std::cout << name << ": " << seconds << " s, " << sim.getEventsProcessed() << " events, "
+              << samples << " samples, mean state " << sum / samples << "\n";
+}
+
+int main() {
+    const int nodes = 10000;
+    const double sampleInterval = 0.1;
+    const double endTime = 200.0;
+
+    std::cout << nodes << " M/M/1 nodes (rho = 0.5, theory L = 1), sampled every "
+              << sampleInterval << " up to T = " << endTime << "\n";
+    runNetwork(Sampling::PerNode, nodes, sampleInterval, endTime);
+    runNetwork(Sampling::Periodic, nodes, sampleInterval, endTime);
+    runNetwork(Sampling::ChangeDriven, nodes, sampleInterval, endTime);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "SteadyStateAnalyzer.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+// Steady-state number in system of an M/M/s queue (Erlang C).
+double theoreticalL(double lambda, double mu, int s) {
+    double a = lambda / mu;
+    double rho = a / s;
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < s; k++) {
+        term *= a / k;
+        sum += term;
+    }
+    double last = term * a / s / (1.0 - rho);
+    double waitProbability = last / (sum + last);
+    return waitProbability * rho / (1.0 - rho) + a;
+}
+
+void report(const char* label, double lambda, double mu, int s, double precision) {
+    Simulation sim;
+    sim.seedRandomStreams(20240901);
+    MMSQueue queue(sim, lambda, mu, s);
+    SteadyStateAnalyzer analyzer(sim, 10.0);
+    int metric = analyzer.addAverageNumberInSystem(queue, label);
+    analyzer.setPrecision(precision);
+    queue.start();
+    analyzer.start();
+    sim.run(1.0e7);  // Safety limit; the analyzer stops the run much earlier.
+
+    ConfidenceInterval estimate = analyzer.getEstimate(metric);
+    std::cout << label << " (lambda = " << lambda << ", mu = " << mu << ")\n"
+              << "  warm-up truncated at T = " << analyzer.getWarmUpEnd()
+              << ", stopped at T = " << sim.getCurrentTime()
+              << (analyzer.hasConverged() ? "" : " (precision not reached)") << "\n"
+              << "  L = " << estimate.mean << " +/- " << estimate.halfWidth
+              << " (theory " << theoreticalL(lambda, mu, s) << ")\n"
+              << "  queue's own average since the reset: " << queue.getAverageNumberInSystem() << "\n";
+}
+
+int main() {
+    std::cout << std::setprecision(5);
+    std::cout << "Automatic warm-up and sequential stopping (2% relative half-width, 95%)\n\n";
+    report("M/M/1", 0.9, 1.0, 1, 0.02);
+    report("M/M/3", 2.5, 1.0, 3, 0.02);
+    report("M/M/1 light", 0.5, 1.0, 1, 0.02);
+    return 0;
+}
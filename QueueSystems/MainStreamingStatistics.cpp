@@ -0,0 +1,44 @@
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "MeasurementEvent.h"
+#include "StreamingObserver.h"
+#include "StateLogger.h"
+#include <iostream>
+#include <iomanip>
+
+int main() {
+    const double lambda = 4.0, mu = 5.0;
+    const double sampleInterval = 0.01;
+    const double endTime = 1.0e5;
+
+    Simulation sim;
+    sim.seedRandomStreams(20241001);
+    MM1Queue queue(sim, lambda, mu);
+    StreamingStatisticsObserver statistics;
+    queue.attach(&statistics);
+    queue.start();
+    sim.scheduleEvent<MeasurementEvent>(0.0, &queue, sampleInterval);
+    sim.run(endTime);
+
+    std::cout << std::setprecision(5);
+    std::cout << "M/M/1 (lambda = " << lambda << ", mu = " << mu << "), sampled every "
+              << sampleInterval << " up to T = " << endTime << "\n\n";
+    std::cout << "Samples:  " << statistics.getCount() << "\n";
+    std::cout << "Mean:     " << statistics.getMean() << " (theory " << lambda / (mu - lambda) << ")\n";
+    std::cout << "Variance: " << statistics.getVariance() << " (theory "
+              << (lambda / mu) / ((1 - lambda / mu) * (1 - lambda / mu)) << ")\n";
+    std::cout << "Min/Max:  " << statistics.getMin() << " / " << statistics.getMax() << "\n";
+
+    ConfidenceInterval nbm = statistics.getBatchMeansInterval();
+    ConfidenceInterval obm = statistics.getOverlappingBatchMeansInterval();
+    std::cout << "95% CI, batch means:             " << nbm.mean << " +/- " << nbm.halfWidth
+              << " (" << statistics.getBatchMeans().getBatchCount() << " batches of "
+              << statistics.getBatchMeans().getBatchSize() << ")\n";
+    std::cout << "95% CI, overlapping batch means: " << obm.mean << " +/- " << obm.halfWidth
+              << " (windows of " << statistics.getOverlappingBatchMeans().getBatchSize() << ")\n";
+
+    std::cout << "\nObserver size: " << sizeof(StreamingStatisticsObserver)
+              << " bytes plus at most " << (40 + 128) * sizeof(double) << " bytes of batches; a StateLogger would hold "
+              << statistics.getCount() * sizeof(StateData) / (1024 * 1024) << " MiB.\n";
+    return 0;
+}
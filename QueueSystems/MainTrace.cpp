@@ -0,0 +1,65 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "MeasurementEvent.h"
+#include "TraceWriter.h"
+#include "TraceReader.h"
+#include <iostream>
+#include <chrono>
+
+int main() {
+    const double sampleInterval = 0.001;
+    const double endTime = 10000.0;
+    const char* tracePath = "trace.bin";
+
+    Simulation sim;
+    sim.seedRandomStreams(20241101);
+    JacksonNetwork network(sim);
+    network.addMM1Queue(4, 8);
+    network.addMMSQueue(1, 10, 2);
+    network.addMM1Queue(0, 6);
+    network.setRoutingMatrix({
+        { 0.0, 0.2, 0.1 },
+        { 0.2, 0.0, 0.3 },
+        { 0.1, 0.2, 0.0 }
+    });
+
+    // Trace the state of every node, sampled by a MeasurementEvent.
+    TraceWriter writer;
+    writer.setWaitWhenFull(true);
+    if (!writer.open(tracePath, 3)) {
+        std::cerr << "Error creating " << tracePath << "\n";
+        return 1;
+    }
+    for (int node = 0; node < 3; node++) {
+        Observable* observable = dynamic_cast<Observable*>(network.getNode(node));
+        observable->attach(writer.createObserver(node));
+        sim.scheduleEvent<MeasurementEvent>(0.0, observable, sampleInterval);
+    }
+    network.start();
+
+    auto begin = std::chrono::steady_clock::now();
+    sim.run(endTime);
+    bool closed = writer.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Traced " << writer.getRecordsWritten() << " observations in " << seconds << " s ("
+              << writer.getDroppedRecords() << " dropped)\n";
+    if (!closed) {
+        std::cerr << "Error writing " << tracePath << ": " << writer.getUnwrittenRecords()
+                  << " observations not written\n";
+        return 1;
+    }
+
+    // Read the trace back through a memory mapping.
+    TraceReader reader;
+    if (!reader.open(tracePath)) {
+        std::cerr << "Error reading " << tracePath << "\n";
+        return 1;
+    }
+    for (std::uint32_t node = 0; node < reader.getNodeCount(); node++) {
+        double sum = 0.0;
+        reader.forEach(node, [&sum](double, std::int32_t state) { sum += state; });
+        std::uint64_t count = reader.getRecordCount(node);
+        std::cout << "Node " << node << ": " << count << " samples, mean state " << sum / count << "\n";
+    }
+    return 0;
+}
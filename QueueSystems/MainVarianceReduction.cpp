@@ -0,0 +1,94 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "ReplicationRunner.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+
+// The 3-node network from Main.cpp with a given number of servers at node 1.
+std::vector<NodeMetrics> runNetwork(Simulation& sim, int servers, double simulationTime) {
+    JacksonNetwork network(sim);
+    network.addMM1Queue(4, 8);
+    network.addMMSQueue(1, 10, servers);
+    network.addMM1Queue(0, 6);
+    network.setRoutingMatrix({
+        { 0.0, 0.2, 0.1 },
+        { 0.2, 0.0, 0.3 },
+        { 0.1, 0.2, 0.0 }
+    });
+    network.start();
+    sim.run(simulationTime);
+
+    std::vector<NodeMetrics> metrics;
+    for (int node = 0; node < network.getNodeCount(); node++) {
+        QueueModel* queue = network.getNode(node);
+        if (auto mm1 = dynamic_cast<MM1Queue*>(queue)) {
+            metrics.push_back({ mm1->getAverageNumberInSystem(),
+                double(mm1->getTotalArrivals()), double(mm1->getTotalDepartures()) });
+        }
+        else if (auto mms = dynamic_cast<MMSQueue*>(queue)) {
+            metrics.push_back({ mms->getAverageNumberInSystem(),
+                double(mms->getTotalArrivals()), double(mms->getTotalDepartures()) });
+        }
+    }
+    return metrics;
+}
+
+int main() {
+    const std::uint64_t masterSeed = 20241015;
+    const int replications = 64;
+    const double simulationTime = 2000.0;
+
+    auto oneServer = [=](Simulation& sim) { return runNetwork(sim, 1, simulationTime); };
+    auto twoServers = [=](Simulation& sim) { return runNetwork(sim, 2, simulationTime); };
+
+    std::cout << std::setprecision(4);
+    std::cout << "Effect of a second server at node 1 on the average number in system, "
+              << replications << " replications of T = " << simulationTime << "\n\n";
+
+    // Independent seeding: each configuration on its own master seed.
+    {
+        ReplicationRunner first(masterSeed), second(masterSeed + 1);
+        std::vector<NodeSummary> before = first.run(replications, oneServer);
+        std::vector<NodeSummary> after = second.run(replications, twoServers);
+        // The difference of independent means has the sum of their
+        // variances; each variance comes back from its half-width, which is
+        // t times the standard error with replications - 1 degrees of freedom.
+        double t = studentTQuantile(0.975, replications - 1.0);
+        std::cout << "Independent seeds:\n";
+        for (std::size_t node = 0; node < before.size(); node++) {
+            double beforeError = before[node].averageNumberInSystem.halfWidth / t;
+            double afterError = after[node].averageNumberInSystem.halfWidth / t;
+            std::cout << "  Node " << node << ": " << std::setw(9)
+                      << after[node].averageNumberInSystem.mean - before[node].averageNumberInSystem.mean
+                      << " +/- " << std::setw(9) << t * std::sqrt(beforeError * beforeError + afterError * afterError) << "\n";
+        }
+    }
+
+    for (bool antithetic : { false, true }) {
+        ReplicationRunner runner(masterSeed);
+        runner.setAntithetic(antithetic);
+        std::vector<NodeComparison> comparisons = runner.compare(replications, oneServer, twoServers);
+        std::cout << (antithetic ? "\nCommon random numbers, antithetic pairs:\n" : "\nCommon random numbers:\n");
+        for (std::size_t node = 0; node < comparisons.size(); node++) {
+            std::cout << "  Node " << node << ": " << std::setw(9) << comparisons[node].averageNumberInSystem.mean
+                      << " +/- " << std::setw(9) << comparisons[node].averageNumberInSystem.halfWidth
+                      << "  variance reduction x" << comparisons[node].varianceReduction.averageNumberInSystem << "\n";
+        }
+    }
+
+    // Antithetic pairs for a single configuration.
+    ReplicationRunner runner(masterSeed);
+    runner.setAntithetic(true);
+    std::vector<NodeSummary> summaries = runner.run(replications, oneServer);
+    std::cout << "\nAverage number in system, one server at node 1, antithetic pairs:\n";
+    for (std::size_t node = 0; node < summaries.size(); node++) {
+        std::cout << "  Node " << node << ": " << std::setw(9) << summaries[node].averageNumberInSystem.mean
+                  << " +/- " << std::setw(9) << summaries[node].averageNumberInSystem.halfWidth
+                  << "  variance reduction x" << summaries[node].varianceReduction.averageNumberInSystem << "\n";
+    }
+    std::cout << "\nA variance reduction of x k means the same precision would take k times as many\n"
+                 "independent replications (and k times the CPU time).\n";
+    return 0;
+}
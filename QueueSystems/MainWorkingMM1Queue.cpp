@@ -25,7 +25,7 @@ int main() {
 
     // Schedule a measurement event to sample the queue state every 1.0 time unit.
     // Note: MeasurementEvent expects an Observable*, and queue qualifies.
-    sim.scheduleEvent(std::make_shared<MeasurementEvent>(0.0, &queue, 1.0));
+    sim.scheduleEvent<MeasurementEvent>(0.0, &queue, 1.0);
 
     // Start the queue (this schedules the first arrival if lambda > 0).
     queue.start();
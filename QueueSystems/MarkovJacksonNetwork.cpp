@@ -0,0 +1,466 @@
+#include "MarkovJacksonNetwork.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+int RateGroups::groupFor(double rate) {
+    return std::max(std::ilogb(rate), minExponent) - minExponent;
+}
+
+void RateGroups::assign(const std::vector<double>& rates) {
+    entries.assign(rates.size(), Entry{ 0.0, -1, 0 });
+    groups.clear();
+    usedGroups.clear();
+    totalRate = 0.0;
+    for (int index = 0; index < size(); index++) {
+        entries[index].rate = rates[index];
+        if (rates[index] > 0.0)
+            insert(index, groupFor(rates[index]));
+    }
+}
+
+void RateGroups::rebuild() {
+    totalRate = 0.0;
+    for (int id : usedGroups) {
+        Group& group = groups[id];
+        group.total = 0.0;
+        for (int index : group.members)
+            group.total += entries[index].rate;
+        totalRate += group.total;
+    }
+}
+
+void RateGroups::setRate(int index, double rate) {
+    Entry& entry = entries[index];
+    int group = rate > 0.0 ? groupFor(rate) : -1;
+    if (group >= 0 && group == entry.group) {
+        double delta = rate - entry.rate;
+        groups[group].total += delta;
+        totalRate += delta;
+        entry.rate = rate;
+        return;
+    }
+    remove(index);
+    entry.rate = rate;
+    if (group >= 0)
+        insert(index, group);
+}
+
+void RateGroups::insert(int index, int id) {
+    if (groups.empty())
+        groups.resize(groupCount);
+    Group& group = groups[id];
+    if (group.bound == 0.0) {
+        // First use: keep the groups in use ordered by decreasing rate.
+        group.bound = std::ldexp(1.0, id + minExponent + 1);
+        usedGroups.insert(std::upper_bound(usedGroups.begin(), usedGroups.end(), id, std::greater<int>()), id);
+    }
+    Entry& entry = entries[index];
+    entry.group = id;
+    entry.slot = static_cast<std::uint32_t>(group.members.size());
+    group.members.push_back(index);
+    group.total += entry.rate;
+    totalRate += entry.rate;
+}
+
+void RateGroups::remove(int index) {
+    Entry& entry = entries[index];
+    if (entry.group < 0)
+        return;
+    Group& group = groups[entry.group];
+    int last = group.members.back();
+    group.members[entry.slot] = last;
+    entries[last].slot = entry.slot;
+    group.members.pop_back();
+    entry.group = -1;
+    if (group.members.empty()) {
+        // Drop the group's rounding error with it.
+        totalRate -= group.total;
+        group.total = 0.0;
+    }
+    else {
+        group.total -= entry.rate;
+        totalRate -= entry.rate;
+    }
+}
+
+namespace {
+    // A leap must cover this many expected transitions, or exact steps are
+    // taken instead, this many at a time. Both grow to one per node and
+    // routing entry in large networks: a leap draws a Poisson variate for
+    // each, at about the cost of an exact step, and choosing tau visits
+    // them all even when the leap is then not taken.
+    const double leapMinimumTransitions = 10.0;
+    const std::uint64_t exactBurst = 100;
+
+    // Poisson variate: products of uniforms for small means, Hormann's
+    // transformed rejection with squeeze (PTRS, 1993) otherwise.
+    std::int64_t poissonVariate(RandomStream& rng, double mean) {
+        if (!(mean > 0.0))
+            return 0;
+        if (mean < 10.0) {
+            double limit = std::exp(-mean), product = rng.nextUniform();
+            std::int64_t count = 0;
+            while (product > limit) {
+                product *= rng.nextUniform();
+                count++;
+            }
+            return count;
+        }
+        double root = std::sqrt(mean), logMean = std::log(mean);
+        double b = 0.931 + 2.53 * root;
+        double a = -0.059 + 0.02483 * b;
+        double inverseAlpha = 1.1239 + 1.1328 / (b - 3.4);
+        double vr = 0.9277 - 3.6224 / (b - 2.0);
+        while (true) {
+            double u = rng.nextUniform() - 0.5;
+            double v = rng.nextUniform();
+            double us = 0.5 - std::abs(u);
+            if (us <= 0.0)
+                continue;
+            double k = std::floor((2.0 * a / us + b) * u + mean + 0.43);
+            if (us >= 0.07 && v <= vr)
+                return static_cast<std::int64_t>(k);
+            if (k < 0.0 || (us < 0.013 && v > us))
+                continue;
+            if (std::log(v) + std::log(inverseAlpha) - std::log(a / (us * us) + b)
+                <= -mean + k * logMean - std::lgamma(k + 1.0))
+                return static_cast<std::int64_t>(k);
+        }
+    }
+
+    // What the routing probabilities of row are multiplied by, as the
+    // alias table does for a row that sums to more than one.
+    double rowScale(const RoutingTable& routing, int row) {
+        double sum = 0.0;
+        for (std::size_t entry = routing.rowBegin(row); entry < routing.rowEnd(row); entry++)
+            sum += std::max(routing.getProbability(entry), 0.0);
+        return sum > 1.0 ? 1.0 / sum : 1.0;
+    }
+}
+
+MarkovJacksonNetwork::MarkovJacksonNetwork(std::uint64_t masterSeed, std::uint64_t replication)
+    : MarkovJacksonNetwork(RandomStreamFactory(masterSeed, replication))
+{
+}
+
+MarkovJacksonNetwork::MarkovJacksonNetwork(RandomStreamFactory streams)
+    : ratesValid(false), rateChanges(0), currentTime(0.0), statisticsStart(0.0),
+    transitionPending(false), nextTransitionTime(0.0), transitions(0),
+    holdingVariates(streams.next()), selectionStream(streams.next()), routingStream(streams.next()),
+    leapErrorBound(0.0), leaps(0), leaptTransitions(0), leapStream(streams.next())
+{
+}
+
+void MarkovJacksonNetwork::reserve(int nodeCount) {
+    nodes.reserve(static_cast<std::size_t>(nodeCount));
+}
+
+int MarkovJacksonNetwork::addMM1Queue(double arrivalRate, double serviceRate) {
+    return addMMSQueue(arrivalRate, serviceRate, 1);
+}
+
+int MarkovJacksonNetwork::addMMSQueue(double arrivalRate, double serviceRate, int servers) {
+    // An infinite rate would have no rate group (see RateGroups::groupFor).
+    if (!(arrivalRate >= 0.0 && std::isfinite(arrivalRate)) || !(serviceRate >= 0.0 && std::isfinite(serviceRate)))
+        throw std::invalid_argument("MarkovJacksonNetwork needs finite, non-negative rates");
+    int node = getNodeCount();
+    Node added{};
+    added.arrivalRate = arrivalRate;
+    added.serviceRate = serviceRate;
+    added.lastEventTime = currentTime;
+    added.servers = servers;
+    nodes.push_back(added);
+    // The total rate has changed, so the pending transition no longer applies.
+    ratesValid = false;
+    transitionPending = false;
+    return node;
+}
+
+void MarkovJacksonNetwork::setRoutingMatrix(const std::vector<std::vector<double>>& matrix) {
+    routing = RoutingTable::fromDense(matrix);
+}
+
+void MarkovJacksonNetwork::setRouting(const std::vector<RoutingEntry>& entries) {
+    routing = RoutingTable::fromEntries(getNodeCount(), entries);
+}
+
+void MarkovJacksonNetwork::setRouting(RoutingTable table) {
+    routing = std::move(table);
+}
+
+double MarkovJacksonNetwork::getAverageNumberInSystem(int node) const {
+    double elapsed = nodes[node].lastEventTime - statisticsStart;
+    return (elapsed > 0) ? nodes[node].area / elapsed : 0.0;
+}
+
+void MarkovJacksonNetwork::resetStatistics() {
+    for (Node& node : nodes) {
+        updateMetrics(node);
+        node.area = 0.0;
+        node.totalArrivals = 0;
+        node.totalDepartures = 0;
+    }
+    statisticsStart = currentTime;
+}
+
+void MarkovJacksonNetwork::setTauLeaping(double errorBound) {
+    leapErrorBound = std::max(errorBound, 0.0);
+}
+
+void MarkovJacksonNetwork::run(double endTime) {
+    if (leapErrorBound > 0.0)
+        runLeaping(endTime);
+    else
+        runExact(endTime, std::numeric_limits<std::uint64_t>::max());
+    currentTime = std::max(currentTime, endTime);
+}
+
+bool MarkovJacksonNetwork::runExact(double endTime, std::uint64_t maxSteps) {
+    if (!ratesValid)
+        rebuildRates();
+    for (std::uint64_t steps = 0; steps < maxSteps; steps++) {
+        if (!transitionPending) {
+            double total = rates.total();
+            if (total <= 0.0)
+                return false;  // Nothing can happen any more.
+            nextTransitionTime = currentTime + holdingVariates.next(1.0 / total);
+            transitionPending = true;
+        }
+        if (nextTransitionTime > endTime)
+            return false;
+        currentTime = nextTransitionTime;
+        transitionPending = false;
+        step();
+    }
+    return true;
+}
+
+void MarkovJacksonNetwork::runLeaping(double endTime) {
+    std::size_t size = nodes.size() + routing.getEntryCount();
+    double minimumTransitions = std::max(leapMinimumTransitions, static_cast<double>(size));
+    std::uint64_t burst = std::max<std::uint64_t>(exactBurst, size);
+    while (currentTime < endTime) {
+        if (leap(endTime, minimumTransitions))
+            continue;
+        // Too few transitions to leap over: a burst of exact steps.
+        if (!runExact(endTime, burst))
+            break;
+    }
+}
+
+double MarkovJacksonNetwork::selectLeap(double& totalRate, double& criticalRate) {
+    std::size_t n = nodes.size();
+    leapDrift.assign(n, 0.0);
+    leapVariance.assign(n, 0.0);
+    totalRate = 0.0;
+    criticalRate = 0.0;
+    for (int index = 0; index < getNodeCount(); index++) {
+        const Node& node = nodes[index];
+        double departureRate = node.busyServers * node.serviceRate;
+        totalRate += node.arrivalRate + departureRate;
+        leapDrift[index] += node.arrivalRate;
+        leapVariance[index] += node.arrivalRate;
+        if (node.numInSystem < criticalCount) {
+            criticalRate += departureRate;
+            continue;
+        }
+        leapDrift[index] -= departureRate;
+        leapVariance[index] += departureRate;
+        if (index >= routing.getRowCount())
+            continue;
+        double scale = rowScale(routing, index);
+        for (std::size_t entry = routing.rowBegin(index); entry < routing.rowEnd(index); entry++) {
+            int destination = routing.getDestination(entry);
+            double probability = routing.getProbability(entry) * scale;
+            if (probability > 0.0 && destination >= 0 && destination < getNodeCount()) {
+                leapDrift[destination] += departureRate * probability;
+                leapVariance[destination] += departureRate * probability;
+            }
+        }
+    }
+
+    // Bound the expected change and the standard deviation of every count.
+    double tau = std::numeric_limits<double>::infinity();
+    for (std::size_t index = 0; index < n; index++) {
+        const Node& node = nodes[index];
+        double bound = std::max(leapErrorBound * node.numInSystem, 1.0);
+        if (leapDrift[index] != 0.0)
+            tau = std::min(tau, bound / std::abs(leapDrift[index]));
+        if (leapVariance[index] > 0.0)
+            tau = std::min(tau, bound * bound / leapVariance[index]);
+        // With a server free (or about to be), the departure rate follows
+        // the count, but customers arriving during the leap are not served
+        // until it ends: keep the leap to a small part of a service time.
+        if (node.numInSystem <= node.servers && leapVariance[index] > 0.0 && node.serviceRate > 0.0)
+            tau = std::min(tau, leapErrorBound * std::max<double>(node.numInSystem, 1.0) / node.serviceRate);
+    }
+    return tau;
+}
+
+bool MarkovJacksonNetwork::leap(double endTime, double minimumTransitions) {
+    double totalRate, criticalRate;
+    double tau = selectLeap(totalRate, criticalRate);
+    std::size_t n = nodes.size();
+    while (true) {
+        // A critical departure ends the leap early, after 1 / criticalRate on average.
+        double expectedLeap = criticalRate > 0.0 ? std::min(tau, 1.0 / criticalRate) : tau;
+        if (!(totalRate > 0.0) || expectedLeap * totalRate < minimumTransitions)
+            return false;
+        double remaining = endTime - currentTime;
+        double criticalTime = criticalRate > 0.0
+            ? -std::log(leapStream.nextUniform()) / criticalRate : std::numeric_limits<double>::infinity();
+        bool fireCritical = criticalTime <= tau && criticalTime <= remaining;
+        double leapTime = std::min({ tau, criticalTime, remaining });
+
+        // Poisson counts of every non-critical transition over the leap.
+        leapArrivals.assign(n, 0);
+        leapDepartures.assign(n, 0);
+        std::uint64_t fired = 0;
+        for (int index = 0; index < getNodeCount(); index++) {
+            const Node& node = nodes[index];
+            std::int64_t external = poissonVariate(leapStream, node.arrivalRate * leapTime);
+            leapArrivals[index] += external;
+            fired += static_cast<std::uint64_t>(external);
+            double departureRate = node.busyServers * node.serviceRate;
+            if (node.numInSystem < criticalCount || departureRate <= 0.0)
+                continue;
+            double routed = 0.0;
+            if (index < routing.getRowCount()) {
+                double scale = rowScale(routing, index);
+                for (std::size_t entry = routing.rowBegin(index); entry < routing.rowEnd(index); entry++) {
+                    double probability = routing.getProbability(entry) * scale;
+                    if (probability <= 0.0)
+                        continue;
+                    routed += probability;
+                    std::int64_t moved = poissonVariate(leapStream, departureRate * probability * leapTime);
+                    leapDepartures[index] += moved;
+                    int destination = routing.getDestination(entry);
+                    if (destination >= 0 && destination < getNodeCount())
+                        leapArrivals[destination] += moved;
+                }
+            }
+            leapDepartures[index] += poissonVariate(leapStream, departureRate * std::max(1.0 - routed, 0.0) * leapTime);
+            fired += static_cast<std::uint64_t>(leapDepartures[index]);
+        }
+
+        bool negative = false;
+        for (std::size_t index = 0; index < n && !negative; index++)
+            negative = nodes[index].numInSystem + leapArrivals[index] - leapDepartures[index] < 0;
+        if (negative) {
+            tau /= 2.0;
+            continue;
+        }
+
+        // The critical departure, chosen by the rates at the start of the leap.
+        int critical = -1;
+        if (fireCritical) {
+            double target = (1.0 - leapStream.nextUniform()) * criticalRate;
+            for (int index = 0; index < getNodeCount(); index++) {
+                const Node& node = nodes[index];
+                double departureRate = node.busyServers * node.serviceRate;
+                if (node.numInSystem >= criticalCount || departureRate <= 0.0)
+                    continue;
+                critical = index;
+                if (target < departureRate)
+                    break;
+                target -= departureRate;
+            }
+        }
+
+        double leapEnd = leapTime == remaining ? endTime : currentTime + leapTime;
+        for (int index = 0; index < getNodeCount(); index++) {
+            Node& node = nodes[index];
+            updateMetrics(node);
+            std::int64_t after = node.numInSystem + leapArrivals[index] - leapDepartures[index];
+            node.area += 0.5 * (node.numInSystem + after) * (leapEnd - currentTime);
+            node.lastEventTime = leapEnd;
+            node.numInSystem = static_cast<std::int32_t>(after);
+            node.busyServers = std::min(node.numInSystem, node.servers);
+            node.totalArrivals += static_cast<std::uint32_t>(leapArrivals[index]);
+            node.totalDepartures += static_cast<std::uint32_t>(leapDepartures[index]);
+        }
+        currentTime = leapEnd;
+        // The state has moved on: redraw the next exact transition and rebuild the rates.
+        transitionPending = false;
+        ratesValid = false;
+        if (critical >= 0) {
+            depart(critical);
+            fired++;
+        }
+
+        leaps++;
+        leaptTransitions += fired;
+        transitions += fired;
+        return true;
+    }
+}
+
+void MarkovJacksonNetwork::rebuildRates() {
+    std::vector<double> nodeRates(nodes.size());
+    for (std::size_t node = 0; node < nodes.size(); node++)
+        nodeRates[node] = nodes[node].arrivalRate + nodes[node].busyServers * nodes[node].serviceRate;
+    rates.assign(nodeRates);
+    ratesValid = true;
+    rateChanges = 0;
+}
+
+void MarkovJacksonNetwork::updateRate(int index, const Node& node) {
+    if (!ratesValid)
+        return;  // All are rebuilt before the next exact step.
+    rates.setRate(index, node.arrivalRate + node.busyServers * node.serviceRate);
+    // Rebuilding after 64 changes per node keeps its O(N) cost negligible.
+    if (++rateChanges >= 64 * nodes.size() + 4096) {
+        rates.rebuild();
+        rateChanges = 0;
+    }
+}
+
+void MarkovJacksonNetwork::updateMetrics(Node& node) {
+    node.area += node.numInSystem * (currentTime - node.lastEventTime);
+    node.lastEventTime = currentTime;
+}
+
+void MarkovJacksonNetwork::step() {
+    RateGroups::Selection selected = rates.select([this] { return selectionStream.nextUniform(); });
+    if (selected.index < 0)
+        return;  // Only rounding left in the total rate.
+    // The offset is uniform within the node's rate: its arrival rate first.
+    if (selected.offset < nodes[selected.index].arrivalRate)
+        arrive(selected.index);
+    else
+        depart(selected.index);
+    transitions++;
+}
+
+void MarkovJacksonNetwork::arrive(int index) {
+    Node& node = nodes[index];
+    updateMetrics(node);
+    node.totalArrivals++;
+    node.numInSystem++;
+    if (node.busyServers < node.servers) {
+        node.busyServers++;
+        updateRate(index, node);
+    }
+}
+
+void MarkovJacksonNetwork::depart(int index) {
+    Node& node = nodes[index];
+    updateMetrics(node);
+    node.totalDepartures++;
+    node.numInSystem--;
+    // The server takes the next waiting customer, if any.
+    if (node.numInSystem < node.busyServers) {
+        node.busyServers--;
+        updateRate(index, node);
+    }
+
+    if (index < routing.getRowCount()) {
+        int destination = routing.sample(index, routingStream.nextUniform());
+        if (destination >= 0 && destination < getNodeCount())
+            arrive(destination);
+    }
+}
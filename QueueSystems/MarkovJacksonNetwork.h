@@ -0,0 +1,271 @@
+#ifndef MARKOV_JACKSON_NETWORK_H
+#define MARKOV_JACKSON_NETWORK_H
+
+#include "RoutingTable.h"
+#include "RandomStream.h"
+#include "ExponentialVariates.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------
+// RateGroups: composition-rejection sampling of rates
+//----------------------------------------------------------------
+// Chooses an index with probability proportional to its rate. Indexes are
+// grouped by the binary exponent of their rate, so every rate in group e
+// lies in [2^e, 2^(e+1)). Sampling picks a group in proportion to its total
+// (a scan over the few groups in use), then members of the group uniformly
+// until one is accepted with probability rate / 2^(e+1), which takes fewer
+// than two tries on average. Changing a rate moves the index between groups
+// in O(1). Both costs are independent of the number of indexes, and each
+// touches only a couple of cache lines, where a binary tree over a large
+// network misses the cache at most of its log2(N) levels.
+//
+// Group totals drift by rounding as rates come and go; rebuild() computes
+// them again from the rates.
+class RateGroups {
+public:
+    struct Selection {
+        int index;      // -1 when every rate is zero.
+        double offset;  // Uniform in [0, rate of index).
+    };
+
+    // Replace every rate; O(n).
+    void assign(const std::vector<double>& rates);
+    void rebuild();
+
+    int size() const { return static_cast<int>(entries.size()); }
+    double total() const { return totalRate; }
+    double getRate(int index) const { return entries[index].rate; }
+
+    void setRate(int index, double rate);
+
+    // uniform() returns uniforms in (0, 1], like RandomStream::nextUniform.
+    template <typename Uniform>
+    Selection select(Uniform&& uniform) const {
+        if (usedGroups.empty() || !(totalRate > 0.0))
+            return { -1, 0.0 };
+        // The group: the last with members takes any rounding excess.
+        double target = (1.0 - uniform()) * totalRate;
+        const Group* group = nullptr;
+        for (int id : usedGroups) {
+            const Group& candidate = groups[id];
+            if (candidate.members.empty())
+                continue;
+            group = &candidate;
+            if (target < candidate.total)
+                break;
+            target -= candidate.total;
+        }
+        if (group == nullptr)
+            return { -1, 0.0 };
+        // A member: the integer part of u times the member count picks it,
+        // the fraction accepts it against the group's upper bound.
+        double count = static_cast<double>(group->members.size());
+        while (true) {
+            double scaled = (1.0 - uniform()) * count;
+            std::size_t slot = static_cast<std::size_t>(scaled);
+            if (slot >= group->members.size())
+                slot = group->members.size() - 1;
+            int index = group->members[slot];
+            double offset = (scaled - static_cast<double>(slot)) * group->bound;
+            if (offset < entries[index].rate)
+                return { index, offset };
+        }
+    }
+
+private:
+    struct Group {
+        std::vector<int> members;
+        double total = 0.0;
+        double bound = 0.0;  // 2^(e+1).
+    };
+
+    // Exponents from minExponent up; subnormal rates share the lowest group.
+    static constexpr int minExponent = -1022;
+    static constexpr int groupCount = 1024 - minExponent + 1;
+
+    // Everything about one index in one 16-byte entry.
+    struct Entry {
+        double rate;
+        std::int32_t group;  // -1 for a zero rate.
+        std::uint32_t slot;  // Position in the group's members.
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Group> groups;      // Indexed by exponent - minExponent; allocated on first use.
+    std::vector<int> usedGroups;    // Groups that have ever had members, by exponent.
+    double totalRate = 0.0;
+
+    static int groupFor(double rate);
+    void insert(int index, int group);
+    void remove(int index);
+};
+
+//----------------------------------------------------------------
+// MarkovJacksonNetwork: direct-method (Gillespie) simulation
+//----------------------------------------------------------------
+// Simulates the same open network of M/M/1 and M/M/s nodes as
+// JacksonNetwork, as the continuous-time Markov chain it is, without events
+// or a future-event set. The state is the number in system at each node;
+// node i leaves it at rate lambda_i + busy_i * mu_i, by an external arrival
+// or a departure (which routes the customer on at once). Each step draws
+// one exponential holding time at the total rate, then a node from
+// RateGroups over the node rates in expected O(1), then the transition
+// within the node, then the destination from the routing alias table.
+//
+// The run is exact: it samples the same process as the event-driven
+// simulation, with two differences in the model:
+// - Routed customers arrive at once instead of epsilon later. The nodes'
+//   steady state is the same; only the time in transit is gone.
+// - Nodes cannot be observed, tracked, checkpointed or have their servers
+//   changed, as in CompactJacksonNetwork.
+// The metrics are defined as in CompactJacksonNetwork, with a departure and
+// the routed arrival it causes counted as one transition.
+//
+// The group totals drift by rounding as rates change, so they are rebuilt
+// from the exact node rates after every few node counts' worth of changes.
+//
+// Tau-leaping (setTauLeaping) trades exactness for speed in heavy traffic,
+// where queues are long and most transitions change them little. A leap
+// advances every node over a step tau at once, with the number of times
+// each transition fires drawn from a Poisson distribution: external
+// arrivals per node, moves along each routing entry and exits per node,
+// each at its rate at the start of the leap. Tau is chosen as by Cao,
+// Gillespie and Petzold (2006) so that the expected change and standard
+// deviation of every node's count over the leap stay within errorBound
+// times the count (and within 1 for short queues). Where no customer
+// waits, the departure rate follows the count but arrivals are not served
+// before the leap ends, so there tau is also kept within errorBound times
+// the count (at least 1) mean service times. Departures from nodes with
+// fewer than criticalCount customers are not leapt: at most one of them
+// fires per leap, at an exponential time, so no count can go negative
+// there; a leap that would still make a count negative is retried with tau
+// halved. When a leap would cover few transitions (fewer than there are
+// nodes and routing entries, as it draws a Poisson variate for each),
+// because tau is short or a critical departure is likely to end it early,
+// exact steps are taken instead. The time-weighted number in system is
+// integrated over a leap by the trapezoid rule.
+class MarkovJacksonNetwork {
+public:
+    // The streams are those of the given replication of masterSeed.
+    explicit MarkovJacksonNetwork(std::uint64_t masterSeed, std::uint64_t replication = 0);
+
+    // Reserve room for the given number of nodes.
+    void reserve(int nodeCount);
+
+    // Add nodes; ids are numbered in order of addition. Throws
+    // std::invalid_argument for a negative or non-finite rate.
+    int addMM1Queue(double arrivalRate, double serviceRate);
+    int addMMSQueue(double arrivalRate, double serviceRate, int servers);
+
+    // Same meaning as JacksonNetwork::setRoutingMatrix and both setRouting.
+    void setRoutingMatrix(const std::vector<std::vector<double>>& routingMatrix);
+    void setRouting(const std::vector<RoutingEntry>& entries);
+    void setRouting(RoutingTable table);
+    const RoutingTable& getRouting() const { return routing; }
+
+    // Simulate until endTime. Runs continue where the last one stopped.
+    void run(double endTime);
+
+    double getCurrentTime() const { return currentTime; }
+    // Transitions made so far, over all runs, including those leapt.
+    std::uint64_t getTransitionCount() const { return transitions; }
+
+    // Leap with the given error bound from now on (0.03 is typical), or
+    // simulate exactly with 0, the default.
+    void setTauLeaping(double errorBound);
+    double getTauLeaping() const { return leapErrorBound; }
+    // Leaps taken so far; the other transitions were exact steps.
+    std::uint64_t getLeapCount() const { return leaps; }
+    std::uint64_t getLeaptTransitionCount() const { return leaptTransitions; }
+
+    // Departures from nodes with fewer customers are never leapt.
+    static constexpr int criticalCount = 10;
+
+    int getNodeCount() const { return static_cast<int>(nodes.size()); }
+
+    // Per-node metrics, as for CompactJacksonNetwork.
+    int getNumberInSystem(int node) const { return nodes[node].numInSystem; }
+    double getAverageNumberInSystem(int node) const;
+    std::uint32_t getTotalArrivals(int node) const { return nodes[node].totalArrivals; }
+    std::uint32_t getTotalDepartures(int node) const { return nodes[node].totalDepartures; }
+    double getArrivalRate(int node) const { return nodes[node].arrivalRate; }
+    double getServiceRate(int node) const { return nodes[node].serviceRate; }
+    int getServers(int node) const { return nodes[node].servers; }
+
+    // Restart every node's statistics at the current time; the state is kept.
+    void resetStatistics();
+
+private:
+    // A transition reads and writes nearly every field of its node, so,
+    // unlike CompactJacksonNetwork, the node state is kept together in one
+    // cache line per node.
+    struct alignas(64) Node {
+        double arrivalRate;
+        double serviceRate;
+        double area;  // Time-weighted number in system since statisticsStart.
+        double lastEventTime;
+        std::int32_t numInSystem;
+        std::int32_t busyServers;
+        std::int32_t servers;
+        std::uint32_t totalArrivals;
+        std::uint32_t totalDepartures;
+    };
+
+public:
+    // Bytes of per-node state: the node, its rate entry and its place in a
+    // rate group (excluding the routing table).
+    static constexpr std::size_t bytesPerNode = sizeof(Node) + 16 + sizeof(std::int32_t);
+
+private:
+    std::vector<Node> nodes;
+
+    RoutingTable routing;
+    RateGroups rates;                  // arrivalRate + busyServers * serviceRate of each node.
+    bool ratesValid;                   // False once nodes are added, until the next run.
+    std::uint64_t rateChanges;         // Since the group totals were last rebuilt.
+
+    double currentTime;
+    double statisticsStart;
+    // The next transition, drawn when a run stops short of it. Kept while
+    // the state is unchanged, so splitting a run does not change it.
+    bool transitionPending;
+    double nextTransitionTime;
+    std::uint64_t transitions;
+
+    ExponentialVariates holdingVariates;
+    RandomStream selectionStream;
+    RandomStream routingStream;
+
+    // Tau-leaping.
+    double leapErrorBound;             // 0 for exact simulation.
+    std::uint64_t leaps;
+    std::uint64_t leaptTransitions;
+    RandomStream leapStream;
+    // Per node: expected change and variance of the count over unit time,
+    // then arrivals and departures drawn for a leap.
+    std::vector<double> leapDrift;
+    std::vector<double> leapVariance;
+    std::vector<std::int64_t> leapArrivals;
+    std::vector<std::int64_t> leapDepartures;
+
+    explicit MarkovJacksonNetwork(RandomStreamFactory streams);
+
+    // Exact steps until endTime or until maxSteps have been taken. Returns
+    // whether it stopped for maxSteps.
+    bool runExact(double endTime, std::uint64_t maxSteps);
+    void runLeaping(double endTime);
+    // One leap, or false if it would take fewer than minimumTransitions.
+    bool leap(double endTime, double minimumTransitions);
+    double selectLeap(double& totalRate, double& criticalRate);
+
+    void rebuildRates();
+    void updateRate(int index, const Node& node);
+    void updateMetrics(Node& node);
+    void step();
+    void arrive(int index);
+    void depart(int index);
+};
+
+#endif // MARKOV_JACKSON_NETWORK_H
@@ -0,0 +1,121 @@
+#include "Simulation.h"
+#include "CompactJacksonNetwork.h"
+#include "MarkovJacksonNetwork.h"
+#include "ProductForm.h"
+#include "BenchmarkNetworks.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace {
+    const double arrivalRate = 0.05, serviceRate = 1.0;
+    const double warmUp = 10.0;
+
+    // The network of Main.cpp, run long by both engines: per-node L and
+    // arrival rate against the product form.
+    bool compareSmallNetwork() {
+        const double endTime = 1.0e6, smallWarmUp = 1000.0;
+        const std::vector<std::vector<double>> matrix = { { 0.0, 0.2, 0.1 }, { 0.2, 0.0, 0.3 }, { 0.1, 0.2, 0.0 } };
+        std::vector<ProductFormNode> specs = { { 4, 8, 1 }, { 1, 10, 2 }, { 0, 6, 1 } };
+
+        Simulation sim(20241023);
+        CompactJacksonNetwork events(sim);
+        MarkovJacksonNetwork markov(20241023);
+        for (const ProductFormNode& spec : specs) {
+            events.addMMSQueue(spec.externalArrivalRate, spec.serviceRate, spec.servers);
+            markov.addMMSQueue(spec.externalArrivalRate, spec.serviceRate, spec.servers);
+        }
+        events.setRoutingMatrix(matrix);
+        markov.setRoutingMatrix(matrix);
+        NetworkSolution solution = solveProductForm(specs, events.getRouting().getEntries());
+
+        events.start();
+        sim.run(smallWarmUp);
+        events.resetStatistics(smallWarmUp);
+        sim.run(endTime);
+        markov.run(smallWarmUp);
+        markov.resetStatistics();
+        markov.run(endTime);
+
+        std::cout << "Main.cpp network, T = " << endTime << ":\n"
+                  << "  node   L analytic   L events   L Markov   arrivals/t analytic   events   Markov\n";
+        bool passed = true;
+        double elapsed = endTime - smallWarmUp;
+        for (int node = 0; node < 3; node++) {
+            const NodeSolution& analytic = solution.nodes[node];
+            double eventsL = events.getAverageNumberInSystem(node), markovL = markov.getAverageNumberInSystem(node);
+            double eventsRate = events.getTotalArrivals(node) / elapsed, markovRate = markov.getTotalArrivals(node) / elapsed;
+            std::cout << "  " << std::setw(4) << node << std::setw(13) << analytic.averageNumberInSystem
+                      << std::setw(11) << eventsL << std::setw(11) << markovL
+                      << std::setw(22) << analytic.arrivalRate << std::setw(9) << eventsRate
+                      << std::setw(9) << markovRate << "\n";
+            passed &= std::abs(markovL - analytic.averageNumberInSystem) < 0.02 * analytic.averageNumberInSystem
+                && std::abs(markovRate - analytic.arrivalRate) < 0.01 * analytic.arrivalRate
+                && std::abs(double(markov.getTotalArrivals(node)) - markov.getTotalDepartures(node)) < 100;
+        }
+        std::cout << "  " << sim.getEventsProcessed() << " events, " << markov.getTransitionCount() << " transitions\n\n";
+        return passed;
+    }
+
+    // Simulated time per second of wall time and the mean node L of both
+    // engines on a random network.
+    bool compareLargeNetwork(int nodeCount, double endTime) {
+        std::vector<RoutingEntry> routing = randomRouting(nodeCount, 7);
+        std::vector<ProductFormNode> specs(nodeCount, ProductFormNode{ arrivalRate, serviceRate, 1 });
+        double analyticMean = solveProductForm(specs, routing).averageNumberInNetwork / nodeCount;
+        std::cout << nodeCount << " nodes, " << routing.size() << " routes, T = " << endTime
+                  << ", analytic mean L " << analyticMean << ":\n";
+
+        Simulation sim(20241023);
+        CompactJacksonNetwork events(sim);
+        events.reserve(nodeCount);
+        for (int node = 0; node < nodeCount; node++)
+            events.addMM1Queue(arrivalRate, serviceRate);
+        events.setRouting(routing);
+        events.start();
+        auto begin = std::chrono::steady_clock::now();
+        sim.run(warmUp);
+        events.resetStatistics(warmUp);
+        sim.run(endTime);
+        double eventsSeconds = secondsSince(begin);
+        double eventsMean = 0.0;
+        for (int node = 0; node < nodeCount; node++)
+            eventsMean += events.getAverageNumberInSystem(node);
+        eventsMean /= nodeCount;
+
+        MarkovJacksonNetwork markov(20241023);
+        markov.reserve(nodeCount);
+        for (int node = 0; node < nodeCount; node++)
+            markov.addMM1Queue(arrivalRate, serviceRate);
+        markov.setRouting(routing);
+        begin = std::chrono::steady_clock::now();
+        markov.run(warmUp);
+        markov.resetStatistics();
+        markov.run(endTime);
+        double markovSeconds = secondsSince(begin);
+        double markovMean = 0.0;
+        for (int node = 0; node < nodeCount; node++)
+            markovMean += markov.getAverageNumberInSystem(node);
+        markovMean /= nodeCount;
+
+        std::cout << "  events  " << std::setw(10) << sim.getEventsProcessed() << " events      "
+                  << std::setw(7) << endTime / eventsSeconds << " time units/s, mean L " << eventsMean << "\n";
+        std::cout << "  Markov  " << std::setw(10) << markov.getTransitionCount() << " transitions "
+                  << std::setw(7) << endTime / markovSeconds << " time units/s, mean L " << markovMean
+                  << "  (" << eventsSeconds / markovSeconds << "x)\n";
+        return std::abs(markovMean - analyticMean) < 0.03 * analyticMean;
+    }
+}
+
+int main() {
+    std::cout << std::setprecision(4);
+    bool passed = compareSmallNetwork();
+    for (int nodeCount : { 10000, 100000, 1000000 })
+        passed &= compareLargeNetwork(nodeCount, std::max(2.0e7 / nodeCount, 3.0 * warmUp));
+    std::cout << "\n" << (passed ? "All checks passed." : "Some checks FAILED.") << "\n";
+    return passed ? 0 : 1;
+}
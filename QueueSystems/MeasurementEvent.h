@@ -17,7 +17,7 @@ public:
 
         // Schedule the next measurement.
         double nextTime = currentTime + sampleInterval;
-        sim.scheduleEvent(std::make_shared<MeasurementEvent>(nextTime, observable, sampleInterval));
+        sim.scheduleEvent<MeasurementEvent>(nextTime, observable, sampleInterval);
     }
 
 private:
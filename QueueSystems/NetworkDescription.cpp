@@ -0,0 +1,473 @@
+#include "NetworkDescription.h"
+#include "NetworkFormat.h"
+#include "JacksonNetwork.h"
+#include "CompactJacksonNetwork.h"
+#include "MarkovJacksonNetwork.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace {
+    // Slack allowed on a row sum for rounding in the generating program.
+    const double rowSumTolerance = 1e-9;
+
+    // Whitespace-separated fields of one line of a text description.
+    class LineFields {
+    public:
+        LineFields(const char* begin, const char* end) : p(begin), end(end) {}
+
+        // True once only blanks or a comment are left.
+        bool atEnd() {
+            skipBlanks();
+            return p == end || *p == '#';
+        }
+
+        bool word(std::string_view& value) {
+            skipBlanks();
+            const char* begin = p;
+            while (p < end && !isBlank(*p) && *p != '#')
+                p++;
+            value = std::string_view(begin, static_cast<std::size_t>(p - begin));
+            return !value.empty();
+        }
+
+        // A number that takes up the whole field.
+        template <typename T>
+        bool number(T& value) {
+            skipBlanks();
+            std::from_chars_result result = std::from_chars(p, end, value);
+            if (result.ec != std::errc() || (result.ptr < end && !isBlank(*result.ptr) && *result.ptr != '#'))
+                return false;
+            p = result.ptr;
+            return true;
+        }
+
+    private:
+        const char* p;
+        const char* end;
+
+        static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+        void skipBlanks() {
+            while (p < end && isBlank(*p))
+                p++;
+        }
+    };
+
+    struct RowEntry {
+        std::int32_t to;
+        double probability;
+    };
+
+    void writeColumn(std::ofstream& out, const void* values, std::uint64_t count, std::uint64_t elementSize) {
+        std::uint64_t bytes = count * elementSize;
+        out.write(static_cast<const char*>(values), static_cast<std::streamsize>(bytes));
+        const char padding[8] = {};
+        out.write(padding, static_cast<std::streamsize>(networkColumnBytes(count, elementSize) - bytes));
+    }
+}
+
+NetworkDescription::NetworkDescription() {
+    clear();
+}
+
+void NetworkDescription::clear() {
+    file.close();
+    arrivalRates.clear();
+    serviceRates.clear();
+    probabilities.clear();
+    rowStarts.assign(1, 0);
+    types.clear();
+    serverCounts.clear();
+    capacities.clear();
+    destinations.clear();
+    nodeCount = 0;
+    entryCount = 0;
+    pointAtVectors();
+}
+
+void NetworkDescription::pointAtVectors() {
+    arrivalRate = arrivalRates.data();
+    serviceRate = serviceRates.data();
+    rowStart = rowStarts.data();
+    probability = probabilities.data();
+    type = types.data();
+    servers = serverCounts.data();
+    capacity = capacities.data();
+    destination = destinations.data();
+}
+
+bool NetworkDescription::fail(const std::string& message) const {
+    error = message;
+    return false;
+}
+
+bool NetworkDescription::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(networkMagic)] = {};
+    in.read(magic, sizeof(magic));
+    if (in.gcount() == sizeof(magic) && std::memcmp(magic, networkMagic, sizeof(magic)) == 0)
+        return loadBinary(path);
+    return loadText(path);
+}
+
+bool NetworkDescription::loadText(const std::string& path) {
+    return loadWith(&NetworkDescription::parseText, path);
+}
+
+bool NetworkDescription::loadBinary(const std::string& path) {
+    return loadWith(&NetworkDescription::mapBinary, path);
+}
+
+bool NetworkDescription::loadWith(bool (NetworkDescription::*reader)(const std::string&), const std::string& path) {
+    clear();
+    error.clear();
+    if (!(this->*reader)(path)) {
+        // Leave an empty description rather than columns of a partial load.
+        std::string message = error;
+        clear();
+        return fail(message);
+    }
+    if (validate())
+        return true;
+    std::string message = path + ": " + error;
+    clear();
+    return fail(message);
+}
+
+bool NetworkDescription::parseText(const std::string& path) {
+    MappedFile text;
+    if (!text.open(path))
+        return fail("cannot open " + path);
+
+    const char* p = reinterpret_cast<const char*>(text.data());
+    const char* end = p + text.size();
+    std::vector<char> defined;
+    std::vector<RoutingEntry> edges;
+    bool sorted = true;  // Edges in row order with increasing destinations, as generators tend to write them.
+    long long lineNumber = 0;
+    int count = -1;
+
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (lineEnd == nullptr)
+            lineEnd = end;
+        lineNumber++;
+        LineFields fields(p, lineEnd);
+        p = (lineEnd < end) ? lineEnd + 1 : end;
+        auto syntaxError = [&path, lineNumber](const char* what) {
+            return path + ":" + std::to_string(lineNumber) + ": " + what;
+        };
+
+        std::string_view keyword;
+        if (fields.atEnd() || !fields.word(keyword))
+            continue;
+
+        if (keyword == "edge") {
+            RoutingEntry edge;
+            if (!fields.number(edge.from) || !fields.number(edge.to) || !fields.number(edge.probability) || !fields.atEnd())
+                return fail(syntaxError("expected edge <from> <to> <probability>"));
+            if (count < 0)
+                return fail(syntaxError("edge before nodes"));
+            if (edge.from < 0 || edge.from >= count || edge.to < 0 || edge.to >= count)
+                return fail(syntaxError("node id out of range"));
+            if (!edges.empty()) {
+                const RoutingEntry& last = edges.back();
+                sorted = sorted && (last.from < edge.from || (last.from == edge.from && last.to < edge.to));
+            }
+            edges.push_back(edge);
+        }
+        else if (keyword == "node") {
+            int id;
+            std::string_view kind;
+            double arrival, service;
+            int serverCount = 1, limit = 0;
+            if (!fields.number(id) || !fields.word(kind) || !fields.number(arrival) || !fields.number(service))
+                return fail(syntaxError("expected node <id> <type> <arrival rate> <service rate>"));
+            NetworkNodeType nodeType;
+            if (kind == "mm1")
+                nodeType = MM1NodeType;
+            else if (kind == "mms") {
+                nodeType = MMSNodeType;
+                if (!fields.number(serverCount))
+                    return fail(syntaxError("expected the number of servers of an mms node"));
+                if (!fields.atEnd() && !fields.number(limit))
+                    return fail(syntaxError("expected the capacity of an mms node"));
+            }
+            else
+                return fail(syntaxError("unknown node type (expected mm1 or mms)"));
+            if (!fields.atEnd())
+                return fail(syntaxError("unexpected field after node"));
+            if (count < 0)
+                return fail(syntaxError("node before nodes"));
+            if (id < 0 || id >= count)
+                return fail(syntaxError("node id out of range"));
+            if (defined[id])
+                return fail(syntaxError("node defined twice"));
+            defined[id] = 1;
+            types[id] = nodeType;
+            arrivalRates[id] = arrival;
+            serviceRates[id] = service;
+            serverCounts[id] = serverCount;
+            capacities[id] = limit;
+        }
+        else if (keyword == "nodes") {
+            if (count >= 0)
+                return fail(syntaxError("nodes given twice"));
+            if (!fields.number(count) || count < 0 || !fields.atEnd())
+                return fail(syntaxError("expected nodes <count>"));
+            std::size_t n = static_cast<std::size_t>(count);
+            defined.assign(n, 0);
+            types.assign(n, MM1NodeType);
+            arrivalRates.assign(n, 0.0);
+            serviceRates.assign(n, 0.0);
+            serverCounts.assign(n, 1);
+            capacities.assign(n, 0);
+            // About 20 bytes per edge line.
+            edges.reserve(static_cast<std::size_t>(end - p) / 20);
+        }
+        else
+            return fail(syntaxError("unknown statement"));
+    }
+
+    if (count < 0)
+        return fail(path + ": no nodes statement");
+    for (int id = 0; id < count; id++) {
+        if (!defined[id])
+            return fail(path + ": node " + std::to_string(id) + " is not defined");
+    }
+
+    // Sparse rows: count the edges of each row, place them, then sort each
+    // row by destination (unless the file already was) and add up duplicates.
+    rowStarts.assign(static_cast<std::size_t>(count) + 1, 0);
+    for (const RoutingEntry& edge : edges)
+        rowStarts[edge.from + 1]++;
+    for (int row = 0; row < count; row++)
+        rowStarts[row + 1] += rowStarts[row];
+    std::vector<RowEntry> placed(edges.size());
+    {
+        std::vector<std::uint64_t> next(rowStarts.begin(), rowStarts.end() - 1);
+        for (const RoutingEntry& edge : edges)
+            placed[next[edge.from]++] = RowEntry{ edge.to, edge.probability };
+    }
+    edges.clear();
+    edges.shrink_to_fit();
+
+    destinations.reserve(placed.size());
+    probabilities.reserve(placed.size());
+    for (int row = 0; row < count; row++) {
+        auto rowBegin = placed.begin() + static_cast<std::ptrdiff_t>(rowStarts[row]);
+        auto rowEnd = placed.begin() + static_cast<std::ptrdiff_t>(rowStarts[row + 1]);
+        if (!sorted) {
+            std::sort(rowBegin, rowEnd, [](const RowEntry& a, const RowEntry& b) { return a.to < b.to; });
+        }
+        rowStarts[row] = destinations.size();
+        for (auto entry = rowBegin; entry != rowEnd; ++entry) {
+            if (destinations.size() > rowStarts[row] && destinations.back() == entry->to)
+                probabilities.back() += entry->probability;
+            else {
+                destinations.push_back(entry->to);
+                probabilities.push_back(entry->probability);
+            }
+        }
+    }
+    rowStarts[count] = destinations.size();
+
+    nodeCount = count;
+    entryCount = destinations.size();
+    pointAtVectors();
+    return true;
+}
+
+bool NetworkDescription::mapBinary(const std::string& path) {
+    if (!file.open(path))
+        return fail("cannot open " + path);
+
+    const unsigned char* data = file.data();
+    std::uint64_t size = file.size();
+    NetworkFileHeader header;
+    if (size < sizeof(header))
+        return fail(path + ": not a binary network description");
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, networkMagic, sizeof(header.magic)) != 0 || header.version != networkVersion)
+        return fail(path + ": not a binary network description of version " + std::to_string(networkVersion));
+
+    std::uint64_t n = header.nodeCount, e = header.entryCount;
+    // Entry indexes must fit the int32 destination column's offsets and the
+    // file; checked before computing sizes to rule out overflow.
+    if (n > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) || e > size)
+        return fail(path + ": node or entry count out of range");
+    std::uint64_t expected = sizeof(header)
+        + 2 * networkColumnBytes(n, sizeof(double)) + networkColumnBytes(n + 1, sizeof(std::uint64_t))
+        + networkColumnBytes(e, sizeof(double)) + 3 * networkColumnBytes(n, sizeof(std::int32_t))
+        + networkColumnBytes(e, sizeof(std::int32_t));
+    if (size != expected)
+        return fail(path + ": file size does not match its header");
+
+    std::uint64_t offset = sizeof(header);
+    auto column = [data, &offset](std::uint64_t count, std::uint64_t elementSize) {
+        const unsigned char* begin = data + offset;
+        offset += networkColumnBytes(count, elementSize);
+        return begin;
+    };
+    arrivalRate = reinterpret_cast<const double*>(column(n, sizeof(double)));
+    serviceRate = reinterpret_cast<const double*>(column(n, sizeof(double)));
+    rowStart = reinterpret_cast<const std::uint64_t*>(column(n + 1, sizeof(std::uint64_t)));
+    probability = reinterpret_cast<const double*>(column(e, sizeof(double)));
+    type = reinterpret_cast<const std::int32_t*>(column(n, sizeof(std::int32_t)));
+    servers = reinterpret_cast<const std::int32_t*>(column(n, sizeof(std::int32_t)));
+    capacity = reinterpret_cast<const std::int32_t*>(column(n, sizeof(std::int32_t)));
+    destination = reinterpret_cast<const std::int32_t*>(column(e, sizeof(std::int32_t)));
+    nodeCount = static_cast<int>(n);
+    entryCount = static_cast<std::size_t>(e);
+    return true;
+}
+
+bool NetworkDescription::validate() const {
+    for (int node = 0; node < nodeCount; node++) {
+        auto which = [node]() { return "node " + std::to_string(node); };
+        if (type[node] != MM1NodeType && type[node] != MMSNodeType)
+            return fail(which() + ": unknown node type");
+        if (!(arrivalRate[node] >= 0.0) || !std::isfinite(arrivalRate[node]))
+            return fail(which() + ": arrival rate must be finite and not negative");
+        if (!(serviceRate[node] > 0.0) || !std::isfinite(serviceRate[node]))
+            return fail(which() + ": service rate must be finite and positive");
+        if (servers[node] < 1 || (type[node] == MM1NodeType && servers[node] != 1))
+            return fail(which() + ": invalid number of servers");
+        if (capacity[node] < 0 || (capacity[node] > 0 && capacity[node] < servers[node]))
+            return fail(which() + ": capacity must be 0 (unlimited) or at least the number of servers");
+    }
+
+    if (rowStart[0] != 0 || rowStart[nodeCount] != entryCount)
+        return fail("routing rows do not cover the entries");
+    for (int row = 0; row < nodeCount; row++) {
+        auto which = [row]() { return "routing row " + std::to_string(row); };
+        if (rowStart[row + 1] < rowStart[row] || rowStart[row + 1] > entryCount)
+            return fail(which() + ": invalid row offsets");
+        double sum = 0.0;
+        for (std::uint64_t k = rowStart[row]; k < rowStart[row + 1]; k++) {
+            if (destination[k] < 0 || destination[k] >= nodeCount)
+                return fail(which() + ": destination out of range");
+            if (k > rowStart[row] && destination[k] <= destination[k - 1])
+                return fail(which() + ": destinations not strictly increasing");
+            if (!(probability[k] > 0.0 && probability[k] <= 1.0))
+                return fail(which() + ": probability not in (0, 1]");
+            sum += probability[k];
+        }
+        if (sum > 1.0 + rowSumTolerance)
+            return fail(which() + ": probabilities sum to " + std::to_string(sum) + ", more than one");
+    }
+    return true;
+}
+
+bool NetworkDescription::saveText(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+    out.precision(17);
+    out << "nodes " << nodeCount << '\n';
+    for (int node = 0; node < nodeCount; node++) {
+        out << "node " << node << (type[node] == MM1NodeType ? " mm1 " : " mms ")
+            << arrivalRate[node] << ' ' << serviceRate[node];
+        if (type[node] == MMSNodeType) {
+            out << ' ' << servers[node];
+            if (capacity[node] > 0)
+                out << ' ' << capacity[node];
+        }
+        out << '\n';
+    }
+    for (int row = 0; row < nodeCount; row++) {
+        for (std::size_t k = rowBegin(row); k < rowEnd(row); k++)
+            out << "edge " << row << ' ' << destination[k] << ' ' << probability[k] << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool NetworkDescription::saveBinary(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+    NetworkFileHeader header = {};
+    std::memcpy(header.magic, networkMagic, sizeof(header.magic));
+    header.version = networkVersion;
+    header.nodeCount = static_cast<std::uint32_t>(nodeCount);
+    header.entryCount = entryCount;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::uint64_t n = static_cast<std::uint64_t>(nodeCount), e = entryCount;
+    writeColumn(out, arrivalRate, n, sizeof(double));
+    writeColumn(out, serviceRate, n, sizeof(double));
+    writeColumn(out, rowStart, n + 1, sizeof(std::uint64_t));
+    writeColumn(out, probability, e, sizeof(double));
+    writeColumn(out, type, n, sizeof(std::int32_t));
+    writeColumn(out, servers, n, sizeof(std::int32_t));
+    writeColumn(out, capacity, n, sizeof(std::int32_t));
+    writeColumn(out, destination, e, sizeof(std::int32_t));
+    return static_cast<bool>(out);
+}
+
+NetworkNode NetworkDescription::getNode(int node) const {
+    return NetworkNode{ static_cast<NetworkNodeType>(type[node]), arrivalRate[node], serviceRate[node],
+        servers[node], capacity[node] };
+}
+
+std::vector<RoutingEntry> NetworkDescription::getEntries() const {
+    std::vector<RoutingEntry> entries;
+    entries.reserve(entryCount);
+    for (int row = 0; row < nodeCount; row++) {
+        for (std::size_t k = rowBegin(row); k < rowEnd(row); k++)
+            entries.push_back({ row, destination[k], probability[k] });
+    }
+    return entries;
+}
+
+RoutingTable NetworkDescription::makeRoutingTable() const {
+    return RoutingTable::fromRows(nodeCount, rowStart, destination, probability);
+}
+
+bool NetworkDescription::checkBuildable(int existingNodes) const {
+    if (existingNodes != 0)
+        return fail("the network already has nodes");
+    for (int node = 0; node < nodeCount; node++) {
+        if (capacity[node] > 0)
+            return fail("node " + std::to_string(node) + " has a finite capacity, which the network does not simulate");
+    }
+    return true;
+}
+
+bool NetworkDescription::build(JacksonNetwork& network) const {
+    if (!checkBuildable(network.getNodeCount()))
+        return false;
+    for (int node = 0; node < nodeCount; node++) {
+        if (type[node] == MM1NodeType)
+            network.addMM1Queue(arrivalRate[node], serviceRate[node]);
+        else
+            network.addMMSQueue(arrivalRate[node], serviceRate[node], servers[node]);
+    }
+    network.setRouting(makeRoutingTable());
+    return true;
+}
+
+bool NetworkDescription::build(CompactJacksonNetwork& network) const {
+    if (!checkBuildable(network.getNodeCount()))
+        return false;
+    network.reserve(nodeCount);
+    for (int node = 0; node < nodeCount; node++)
+        network.addMMSQueue(arrivalRate[node], serviceRate[node], servers[node]);
+    network.setRouting(makeRoutingTable());
+    return true;
+}
+
+bool NetworkDescription::build(MarkovJacksonNetwork& network) const {
+    if (!checkBuildable(network.getNodeCount()))
+        return false;
+    network.reserve(nodeCount);
+    for (int node = 0; node < nodeCount; node++)
+        network.addMMSQueue(arrivalRate[node], serviceRate[node], servers[node]);
+    network.setRouting(makeRoutingTable());
+    return true;
+}
@@ -0,0 +1,124 @@
+#ifndef NETWORK_DESCRIPTION_H
+#define NETWORK_DESCRIPTION_H
+
+#include "MappedFile.h"
+#include "RoutingTable.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class JacksonNetwork;
+class CompactJacksonNetwork;
+class MarkovJacksonNetwork;
+
+enum NetworkNodeType : std::int32_t {
+    MM1NodeType = 0,
+    MMSNodeType = 1
+};
+
+// One node of a network description.
+struct NetworkNode {
+    NetworkNodeType type;
+    double arrivalRate;  // External arrivals; 0 for none.
+    double serviceRate;
+    int servers;
+    int capacity;        // Customers in the node at most; 0 for unlimited.
+};
+
+//----------------------------------------------------------------
+// NetworkDescription: a network loaded from a file
+//----------------------------------------------------------------
+// The nodes and sparse routing of an open network, read from a text
+// description or from the binary format of NetworkFormat.h, so that large
+// generated topologies need no code.
+//
+// The text format has one statement per line; # starts a comment:
+//
+//   nodes <count>
+//   node <id> mm1 <arrival rate> <service rate>
+//   node <id> mms <arrival rate> <service rate> <servers> [<capacity>]
+//   edge <from> <to> <probability>
+//
+// "nodes" comes first, every id from 0 to count - 1 has one "node" line,
+// and "edge" lines may come in any order; duplicate edges are added up.
+//
+// A binary file is mapped and used in place: loading it only checks the
+// header and validates the columns. Either way the loaded description is
+// checked: rates finite, service rates positive, probabilities in (0, 1],
+// destinations in range and every row summing to at most one.
+//
+// Descriptions are immutable once loaded; load again to replace one.
+class NetworkDescription {
+public:
+    NetworkDescription();
+
+    NetworkDescription(const NetworkDescription&) = delete;
+    NetworkDescription& operator=(const NetworkDescription&) = delete;
+
+    // Load a description. Each returns false, with getError() saying why,
+    // if the file is missing, malformed or fails validation.
+    bool loadText(const std::string& path);
+    bool loadBinary(const std::string& path);
+    // Binary if the file starts with the binary magic, text otherwise.
+    bool load(const std::string& path);
+
+    bool saveText(const std::string& path) const;
+    bool saveBinary(const std::string& path) const;
+
+    // Why the last load or build failed.
+    const std::string& getError() const { return error; }
+
+    int getNodeCount() const { return nodeCount; }
+    std::size_t getEntryCount() const { return entryCount; }
+    NetworkNode getNode(int node) const;
+
+    // The routing entries of row node are rowBegin(node) .. rowEnd(node) - 1,
+    // sorted by destination.
+    std::size_t rowBegin(int node) const { return static_cast<std::size_t>(rowStart[node]); }
+    std::size_t rowEnd(int node) const { return static_cast<std::size_t>(rowStart[node + 1]); }
+    int getDestination(std::size_t entry) const { return destination[entry]; }
+    double getProbability(std::size_t entry) const { return probability[entry]; }
+
+    std::vector<RoutingEntry> getEntries() const;
+    RoutingTable makeRoutingTable() const;
+
+    // Add the nodes to an empty network and set its routing. Returns false
+    // if the network already has nodes or a node has a finite capacity,
+    // which no network simulates.
+    bool build(JacksonNetwork& network) const;
+    bool build(CompactJacksonNetwork& network) const;
+    bool build(MarkovJacksonNetwork& network) const;
+
+private:
+    // The columns, pointing into the mapping for a binary file and into the
+    // vectors below for a text file.
+    int nodeCount;
+    std::size_t entryCount;
+    const double* arrivalRate;
+    const double* serviceRate;
+    const std::uint64_t* rowStart;
+    const double* probability;
+    const std::int32_t* type;
+    const std::int32_t* servers;
+    const std::int32_t* capacity;
+    const std::int32_t* destination;
+
+    MappedFile file;
+    std::vector<double> arrivalRates, serviceRates, probabilities;
+    std::vector<std::uint64_t> rowStarts;
+    std::vector<std::int32_t> types, serverCounts, capacities, destinations;
+
+    mutable std::string error;
+
+    void clear();
+    void pointAtVectors();
+    bool loadWith(bool (NetworkDescription::*reader)(const std::string&), const std::string& path);
+    bool parseText(const std::string& path);
+    bool mapBinary(const std::string& path);
+    bool fail(const std::string& message) const;
+    bool validate() const;
+    bool checkBuildable(int existingNodes) const;
+};
+
+#endif // NETWORK_DESCRIPTION_H
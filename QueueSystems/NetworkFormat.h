@@ -0,0 +1,37 @@
+#ifndef NETWORK_FORMAT_H
+#define NETWORK_FORMAT_H
+
+#include <cstdint>
+
+// Layout of a binary network description written by
+// NetworkDescription::saveBinary.
+//
+// The file starts with a NetworkFileHeader, followed by the columns below,
+// each padded with zeros to a multiple of 8 bytes so that every column
+// stays aligned in a memory mapping (n nodes, e routing entries):
+//   double        arrivalRate[n]
+//   double        serviceRate[n]
+//   std::uint64_t rowStart[n + 1]   Entries of row i are rowStart[i] .. rowStart[i + 1] - 1.
+//   double        probability[e]
+//   std::int32_t  type[n]           A NetworkNodeType.
+//   std::int32_t  servers[n]
+//   std::int32_t  capacity[n]       0 for unlimited.
+//   std::int32_t  destination[e]    Strictly increasing within a row.
+// Values are stored in the machine's native byte order.
+
+const char networkMagic[8] = { 'Q', 'S', 'N', 'E', 'T', 'W', 'R', 'K' };
+const std::uint32_t networkVersion = 1;
+
+struct NetworkFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nodeCount;
+    std::uint64_t entryCount;
+};
+
+// Bytes of a column of count values of elementSize bytes, including padding.
+inline std::uint64_t networkColumnBytes(std::uint64_t count, std::uint64_t elementSize) {
+    return (count * elementSize + 7) & ~std::uint64_t(7);
+}
+
+#endif // NETWORK_FORMAT_H
@@ -0,0 +1,148 @@
+#include "NetworkDescription.h"
+#include "NetworkFormat.h"
+#include "CompactJacksonNetwork.h"
+#include "Simulation.h"
+#include "BenchmarkNetworks.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+
+namespace {
+    const int nodeCount = 200000;
+
+    // A text description of a random sparse network: nodeCount M/M/1 and
+    // M/M/2 nodes with successors random successors each, destinations in
+    // no particular order.
+    bool writeRandomNetwork(const std::string& path) {
+        std::ofstream out(path);
+        if (!out.is_open())
+            return false;
+        RandomStream rng(11);
+        out << "# " << nodeCount << " nodes, " << successors << " random successors each\n";
+        out << "nodes " << nodeCount << "\n";
+        for (int node = 0; node < nodeCount; node++) {
+            if (node % 10 == 0)
+                out << "node " << node << " mms 0.1 1 2\n";
+            else
+                out << "node " << node << " mm1 0.05 1\n";
+        }
+        for (int node = 0; node < nodeCount; node++) {
+            for (int k = 0; k < successors; k++)
+                out << "edge " << node << ' ' << rng() % nodeCount << ' ' << stayProbability << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    // Loading must fail, and say why.
+    bool expectRejected(const char* label, const std::string& path, bool binary) {
+        NetworkDescription description;
+        bool loaded = binary ? description.loadBinary(path) : description.loadText(path);
+        std::cout << "  " << std::left << std::setw(28) << label << std::right
+                  << (loaded ? "accepted  FAILED" : "rejected: " + description.getError()) << "\n";
+        return !loaded;
+    }
+
+    bool checkValidation(const std::string& binaryPath) {
+        std::cout << "\nValidation:\n";
+        bool passed = true;
+
+        const std::string textPath = "network_invalid.txt";
+        std::ofstream(textPath) << "nodes 2\nnode 0 mm1 1 2\nnode 1 mms 0 1 2\nedge 0 1 0.7\nedge 0 0 0.4\n";
+        passed &= expectRejected("text, row sum 1.1", textPath, false);
+        std::ofstream(textPath) << "nodes 2\nnode 0 mm1 1 2\nedge 0 1 0.5\n";
+        passed &= expectRejected("text, node missing", textPath, false);
+        std::ofstream(textPath) << "nodes 2\nnode 0 mm1 1 2\nnode 1 mm1 1 2x\n";
+        passed &= expectRejected("text, bad number", textPath, false);
+        std::remove(textPath.c_str());
+
+        // Raise the first routing probability of the binary file to 0.9.
+        std::vector<char> bytes;
+        {
+            std::ifstream in(binaryPath, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        std::size_t offset = sizeof(NetworkFileHeader) + 2 * networkColumnBytes(nodeCount, sizeof(double))
+            + networkColumnBytes(nodeCount + 1, sizeof(std::uint64_t));
+        double raised = 0.9;
+        std::memcpy(bytes.data() + offset, &raised, sizeof(raised));
+        const std::string corruptPath = "network_invalid.bin";
+        std::ofstream(corruptPath, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        passed &= expectRejected("binary, row sum over one", corruptPath, true);
+        bytes.resize(bytes.size() - 8);
+        std::ofstream(corruptPath, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        passed &= expectRejected("binary, truncated", corruptPath, true);
+        std::remove(corruptPath.c_str());
+        return passed;
+    }
+}
+
+int main() {
+    std::cout << std::setprecision(4);
+    const std::string textPath = "network_benchmark.txt", binaryPath = "network_benchmark.bin";
+    if (!writeRandomNetwork(textPath)) {
+        std::cerr << "Error writing " << textPath << "\n";
+        return 1;
+    }
+
+    NetworkDescription text;
+    auto begin = std::chrono::steady_clock::now();
+    bool loaded = text.loadText(textPath);
+    double textSeconds = secondsSince(begin);
+    if (!loaded) {
+        std::cerr << text.getError() << "\n";
+        return 1;
+    }
+    std::cout << text.getNodeCount() << " nodes, " << text.getEntryCount() << " routing entries\n";
+    std::cout << "  load text:           " << std::setw(8) << 1.0e3 * textSeconds << " ms\n";
+
+    if (!text.saveBinary(binaryPath)) {
+        std::cerr << "Error writing " << binaryPath << "\n";
+        return 1;
+    }
+    NetworkDescription binary;
+    begin = std::chrono::steady_clock::now();
+    loaded = binary.loadBinary(binaryPath);
+    double binarySeconds = secondsSince(begin);
+    if (!loaded) {
+        std::cerr << binary.getError() << "\n";
+        return 1;
+    }
+    std::cout << "  load binary:         " << std::setw(8) << 1.0e3 * binarySeconds << " ms (mapped, validated)\n";
+
+    bool passed = binary.getNodeCount() == text.getNodeCount() && binary.getEntryCount() == text.getEntryCount();
+    for (int node = 0; passed && node < text.getNodeCount(); node++) {
+        NetworkNode a = text.getNode(node), b = binary.getNode(node);
+        passed = a.type == b.type && a.arrivalRate == b.arrivalRate && a.serviceRate == b.serviceRate
+            && a.servers == b.servers && a.capacity == b.capacity && text.rowBegin(node) == binary.rowBegin(node);
+    }
+    for (std::size_t k = 0; passed && k < text.getEntryCount(); k++)
+        passed = text.getDestination(k) == binary.getDestination(k) && text.getProbability(k) == binary.getProbability(k);
+    std::cout << "  binary matches text: " << (passed ? "yes" : "NO") << "\n";
+
+    begin = std::chrono::steady_clock::now();
+    Simulation sim(20241020);
+    CompactJacksonNetwork network(sim);
+    binary.build(network);
+    double buildSeconds = secondsSince(begin);
+    std::cout << "  build network:       " << std::setw(8) << 1.0e3 * buildSeconds << " ms (nodes and alias tables)\n";
+
+    network.start();
+    begin = std::chrono::steady_clock::now();
+    sim.run(20.0);
+    double runSeconds = secondsSince(begin);
+    std::cout << "  simulate T = 20:     " << std::setw(8) << 1.0e3 * runSeconds << " ms, "
+              << sim.getEventsProcessed() << " events\n";
+
+    passed &= checkValidation(binaryPath);
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+
+    std::cout << "\n" << (passed ? "All checks passed." : "Some checks FAILED.") << "\n";
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#include "NetworkSampler.h"
+#include <algorithm>
+
+// Periodic sample of all nodes of a NetworkSampler.
+class SampleTickEvent : public Event {
+public:
+    NetworkSampler* sampler;
+    SampleTickEvent(double time, NetworkSampler* sampler) : Event(time), sampler(sampler) {}
+
+    virtual void process(Simulation&) override {
+        sampler->sample();
+    }
+};
+
+NetworkSampler::NetworkSampler(Simulation& sim, double interval, Mode mode)
+    : sim(sim), interval(interval), mode(mode), startTime(0.0), nextTick(0), started(false)
+{
+}
+
+int NetworkSampler::add(Observable& observable) {
+    observables.push_back(&observable);
+    states.push_back(observable.getState());
+    int index = static_cast<int>(observables.size()) - 1;
+    if (started && mode == Mode::ChangeDriven)
+        observable.setChangeListener(this, index);
+    return index;
+}
+
+void NetworkSampler::attach(SampleBatchObserver* observer) {
+    observers.push_back(observer);
+}
+
+void NetworkSampler::detach(SampleBatchObserver* observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void NetworkSampler::start() {
+    startTime = sim.getCurrentTime();
+    nextTick = 0;
+    started = true;
+    if (mode == Mode::Periodic) {
+        sim.scheduleEvent<SampleTickEvent>(startTime, this);
+        return;
+    }
+    for (std::size_t i = 0; i < observables.size(); i++) {
+        states[i] = observables[i]->getState();
+        observables[i]->setChangeListener(this, static_cast<int>(i));
+    }
+}
+
+void NetworkSampler::publish(double time) {
+    for (auto observer : observers)
+        observer->update(time, states);
+    nextTick++;
+}
+
+void NetworkSampler::sample() {
+    double now = sim.getCurrentTime();
+    for (std::size_t i = 0; i < observables.size(); i++)
+        states[i] = observables[i]->getState();
+    publish(now);
+    sim.scheduleEvent<SampleTickEvent>(tickTime(nextTick), this);
+}
+
+void NetworkSampler::catchUp(double time) {
+    // Changes arrive in time order, so the states already reflect every
+    // change up to each of these sample times.
+    while (tickTime(nextTick) < time)
+        publish(tickTime(nextTick));
+}
+
+void NetworkSampler::stateChanged(int id, double time, int state) {
+    catchUp(time);
+    states[id] = state;
+}
+
+void NetworkSampler::finish(double endTime) {
+    if (!started || mode != Mode::ChangeDriven)
+        return;
+    catchUp(endTime);
+    if (tickTime(nextTick) == endTime)
+        publish(endTime);
+    for (Observable* observable : observables)
+        observable->setChangeListener(nullptr);
+    started = false;
+}
@@ -0,0 +1,71 @@
+#ifndef NETWORK_SAMPLER_H
+#define NETWORK_SAMPLER_H
+
+#include "Simulation.h"
+#include "Observable.h"
+#include <vector>
+#include <cstdint>
+
+// Receives the states of all nodes of a NetworkSampler at one sample time.
+class SampleBatchObserver {
+public:
+    virtual ~SampleBatchObserver() {}
+    // states[i] is the state of the i-th observable added to the sampler.
+    virtual void update(double time, const std::vector<int>& states) = 0;
+};
+
+// NetworkSampler samples the state of many observables at regular times
+// startTime + k * interval and hands each sample to its observers as one
+// contiguous array. It replaces one MeasurementEvent per node.
+//
+// Periodic mode takes one event per sample time, whatever the number of
+// nodes. ChangeDriven mode schedules no events at all: the models report
+// each change of state (Observable::setChangeListener), and the samples up
+// to a change are filled in when that change arrives. Samples after the
+// last change are produced by finish().
+class NetworkSampler : public StateChangeListener {
+public:
+    enum class Mode { Periodic, ChangeDriven };
+
+    NetworkSampler(Simulation& sim, double interval, Mode mode = Mode::Periodic);
+
+    // Register an observable. Returns its index in the sample array.
+    int add(Observable& observable);
+
+    void attach(SampleBatchObserver* observer);
+    void detach(SampleBatchObserver* observer);
+
+    // Take the first sample at the current simulation time.
+    void start();
+
+    // Produce any samples still due up to endTime (ChangeDriven mode) and
+    // stop listening to the models. Call after the run.
+    void finish(double endTime);
+
+    Mode getMode() const { return mode; }
+    // Number of sample times handed to the observers so far.
+    std::uint64_t getSampleCount() const { return nextTick; }
+
+    // Take a sample now. Called by the sampler's event in Periodic mode.
+    void sample();
+
+    virtual void stateChanged(int id, double time, int state) override;
+
+private:
+    Simulation& sim;
+    double interval;
+    Mode mode;
+    double startTime;
+    std::uint64_t nextTick;   // Index of the next sample time.
+    bool started;
+    std::vector<Observable*> observables;
+    std::vector<int> states;  // Contiguous states, in order of registration.
+    std::vector<SampleBatchObserver*> observers;
+
+    double tickTime(std::uint64_t tick) const { return startTime + static_cast<double>(tick) * interval; }
+    void publish(double time);
+    // ChangeDriven: emit the samples due strictly before time.
+    void catchUp(double time);
+};
+
+#endif // NETWORK_SAMPLER_H
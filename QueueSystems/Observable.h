@@ -2,12 +2,23 @@
 #define OBSERVABLE_H
 
 #include "StateObserver.h"
+#include "ProfileScope.h"
 #include <vector>
 #include <algorithm>
 
+// Receives every change of an Observable's state as it happens (see
+// Observable::setChangeListener). The id identifies the observable.
+class StateChangeListener {
+public:
+    virtual ~StateChangeListener() {}
+    virtual void stateChanged(int id, double time, int state) = 0;
+};
+
 // Mixin class that enables an object to be observed.
 class Observable {
 public:
+    Observable() : changeListener(nullptr), changeId(0) {}
+
     virtual ~Observable() {}
 
     // Must be implemented by the observable subject.
@@ -25,14 +36,35 @@ public:
 
     // Notify all attached observers with the current state and time.
     void notifyObservers(double time) {
+        if (observers.empty())
+            return;
+        QS_PROFILE_SCOPE(Observers);
         StateData data{ time, getState() };
         for (auto observer : observers) {
             observer->update(data);
         }
     }
 
+    // Report every change of getState() to a listener, tagged with id.
+    // Pass nullptr to stop.
+    void setChangeListener(StateChangeListener* listener, int id = 0) {
+        changeListener = listener;
+        changeId = id;
+    }
+
+protected:
+    // Models call this whenever the value returned by getState() changes.
+    void stateChanged(double time) {
+        if (changeListener != nullptr) {
+            QS_PROFILE_SCOPE(Observers);
+            changeListener->stateChanged(changeId, time, getState());
+        }
+    }
+
 private:
     std::vector<StateObserver*> observers;
+    StateChangeListener* changeListener;
+    int changeId;
 };
 
 #endif // OBSERVABLE_H
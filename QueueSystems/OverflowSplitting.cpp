@@ -0,0 +1,239 @@
+#include "OverflowSplitting.h"
+#include "CANQueue.h"
+#include "Checkpoint.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    using State = std::vector<unsigned char>;
+
+    // Stage 0: counts regenerative cycles and stops the run at the first
+    // entrance to firstLevel in each cycle, and after the last cycle.
+    class CycleWatcher : public StateChangeListener {
+    public:
+        CycleWatcher(Simulation& sim, const CANQueue& queue, int firstLevel, int cycles)
+            : sim(sim), queue(queue), firstLevel(firstLevel), cyclesWanted(cycles),
+            cycles(0), arrivals(0), armed(true), entered(false) {}
+
+        virtual void stateChanged(int, double, int state) override {
+            if (state == 0) {
+                cycles++;
+                arrivals = queue.getTotalArrivals() + queue.getTotalRejections();
+                armed = true;
+                if (cycles == cyclesWanted)
+                    sim.stop();
+            }
+            else if (armed && state >= firstLevel) {
+                armed = false;
+                entered = true;
+                sim.stop();
+            }
+        }
+
+        Simulation& sim;
+        const CANQueue& queue;
+        int firstLevel;
+        int cyclesWanted;
+        int cycles;      // Completed cycles.
+        int arrivals;    // Arrivals in the completed cycles.
+        bool armed;      // The current cycle has not reached firstLevel yet.
+        bool entered;    // The run stopped at an entrance to firstLevel.
+    };
+
+    // Later stages: stops the run when the queue reaches target or empties.
+    class LevelWatcher : public StateChangeListener {
+    public:
+        LevelWatcher(Simulation& sim, int target) : sim(sim), target(target), reached(false) {}
+
+        virtual void stateChanged(int, double, int state) override {
+            if (state >= target || state == 0) {
+                reached = (state >= target);
+                sim.stop();
+            }
+        }
+
+        Simulation& sim;
+        int target;
+        bool reached;
+    };
+}
+
+struct OverflowSplitting::Replication {
+    double estimate;
+    std::vector<double> levelProbabilities;
+    double rejectionsPerOverflow;
+    double arrivalsPerCycle;
+    std::uint64_t eventsProcessed;
+};
+
+OverflowSplitting::OverflowSplitting(double arrivalRate, double serviceRate, int servers, int capacity,
+    std::uint64_t masterSeed, unsigned threads)
+    : arrivalRate(arrivalRate), serviceRate(serviceRate), servers(servers), capacity(capacity),
+    masterSeed(masterSeed), threads(threads), effort(1000), cycles(10000)
+{
+    if (capacity < 1 || servers < 1 || !(arrivalRate > 0.0) || !(serviceRate > 0.0))
+        throw std::invalid_argument("OverflowSplitting needs positive rates, servers and capacity");
+    if (this->threads == 0)
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Above the servers the queue climbs one level before emptying with
+    // probability about rho, so a spacing of log(0.2) / log(rho) levels
+    // makes each stage succeed about one time in five.
+    double rho = arrivalRate / (servers * serviceRate);
+    int spacing = rho < 1.0 ? static_cast<int>(std::lround(std::log(0.2) / std::log(rho))) : 1;
+    spacing = std::max(1, spacing);
+    std::vector<int> defaults;
+    for (int level = std::min(servers, capacity - 1) + spacing; level < capacity; level += spacing)
+        defaults.push_back(level);
+    setLevels(defaults);
+}
+
+void OverflowSplitting::setLevels(const std::vector<int>& intermediate) {
+    levels.clear();
+    for (int level : intermediate) {
+        if (level >= 1 && level < capacity && (levels.empty() || level > levels.back()))
+            levels.push_back(level);
+    }
+    levels.push_back(capacity);
+}
+
+const std::vector<int>& OverflowSplitting::getLevels() const {
+    return levels;
+}
+
+void OverflowSplitting::setEffort(int trialsPerStage) {
+    effort = std::max(1, trialsPerStage);
+}
+
+void OverflowSplitting::setCycles(int cycles) {
+    this->cycles = std::max(1, cycles);
+}
+
+OverflowSplitting::Replication OverflowSplitting::runReplication(std::uint64_t replication) const {
+    // Every queue in the replication, including each copy, takes its
+    // streams from this factory, so no two share random numbers.
+    RandomStreamFactory streams(masterSeed, replication);
+    Replication result{ 0.0, std::vector<double>(levels.size(), 0.0), 0.0, 0.0, 0 };
+
+    // Stage 0: plain cycles from an empty queue.
+    std::vector<State> entrances;
+    int arrivals = 0;
+    {
+        Simulation sim(masterSeed);
+        CANQueue queue(sim, arrivalRate, serviceRate, servers, capacity);
+        queue.setRandomStreams(streams.next(), streams.next());
+        Checkpoint checkpoint;
+        checkpoint.add(queue);
+        CycleWatcher watcher(sim, queue, levels.front(), cycles);
+        queue.setChangeListener(&watcher);
+        queue.start();
+        while (watcher.cycles < cycles) {
+            watcher.entered = false;
+            sim.run();
+            if (watcher.entered)
+                entrances.push_back(checkpoint.saveToMemory(sim));
+        }
+        arrivals = watcher.arrivals;
+        result.eventsProcessed += sim.getEventsProcessed();
+    }
+    result.arrivalsPerCycle = static_cast<double>(arrivals) / cycles;
+    result.levelProbabilities[0] = static_cast<double>(entrances.size()) / cycles;
+
+    // Restore the state into a fresh simulation with new random streams and
+    // run it until it reaches target (capacity + 1: never) or empties.
+    // Returns whether it reached target, with the state at that moment.
+    auto runCopy = [&](const State& start, int target, State& reachedState, int& rejections) {
+        Simulation sim(masterSeed);
+        CANQueue queue(sim, arrivalRate, serviceRate, servers, capacity);
+        Checkpoint checkpoint;
+        checkpoint.add(queue);
+        if (!checkpoint.restore(sim, start.data(), start.size()))
+            throw std::runtime_error("OverflowSplitting could not restore a saved state");
+        queue.setRandomStreams(streams.next(), streams.next());
+        std::uint64_t eventsBefore = sim.getEventsProcessed();
+        int rejectionsBefore = queue.getTotalRejections();
+
+        LevelWatcher watcher(sim, target);
+        queue.setChangeListener(&watcher);
+        sim.run();
+        if (watcher.reached)
+            reachedState = checkpoint.saveToMemory(sim);
+        rejections = queue.getTotalRejections() - rejectionsBefore;
+        result.eventsProcessed += sim.getEventsProcessed() - eventsBefore;
+        return watcher.reached;
+    };
+
+    // Stages 1 and on: from each level to the next.
+    double product = result.levelProbabilities[0];
+    for (std::size_t stage = 1; stage < levels.size() && !entrances.empty(); stage++) {
+        std::vector<State> next;
+        State reachedState;
+        int rejections = 0;
+        for (int trial = 0; trial < effort; trial++) {
+            if (runCopy(entrances[trial % entrances.size()], levels[stage], reachedState, rejections))
+                next.push_back(std::move(reachedState));
+        }
+        result.levelProbabilities[stage] = static_cast<double>(next.size()) / effort;
+        product *= result.levelProbabilities[stage];
+        entrances = std::move(next);
+    }
+
+    // Final stage: rejections from the first time the queue is full until it empties.
+    if (!entrances.empty()) {
+        State unused;
+        long long totalRejections = 0;
+        for (int trial = 0; trial < effort; trial++) {
+            int rejections = 0;
+            runCopy(entrances[trial % entrances.size()], capacity + 1, unused, rejections);
+            totalRejections += rejections;
+        }
+        result.rejectionsPerOverflow = static_cast<double>(totalRejections) / effort;
+    }
+    else {
+        product = 0.0;
+    }
+
+    result.estimate = arrivals > 0 ? product * result.rejectionsPerOverflow / result.arrivalsPerCycle : 0.0;
+    return result;
+}
+
+SplittingEstimate OverflowSplitting::estimate(int replications, double confidence) const {
+    replications = std::max(replications, 1);
+    std::vector<Replication> results(replications);
+    std::atomic<int> nextReplication(0);
+    auto worker = [&]() {
+        for (;;) {
+            int r = nextReplication.fetch_add(1);
+            if (r >= replications)
+                break;
+            results[r] = runReplication(static_cast<std::uint64_t>(r));
+        }
+    };
+
+    unsigned workerCount = std::min<unsigned>(threads, static_cast<unsigned>(replications));
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workerCount; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    SummaryStatistics blocking;
+    SplittingEstimate estimate{ {}, std::vector<double>(levels.size(), 0.0), 0.0, 0.0, 0 };
+    for (const Replication& result : results) {
+        blocking.add(result.estimate);
+        for (std::size_t stage = 0; stage < levels.size(); stage++)
+            estimate.levelProbabilities[stage] += result.levelProbabilities[stage] / replications;
+        estimate.rejectionsPerOverflow += result.rejectionsPerOverflow / replications;
+        estimate.arrivalsPerCycle += result.arrivalsPerCycle / replications;
+        estimate.eventsProcessed += result.eventsProcessed;
+    }
+    estimate.blockingProbability = blocking.getConfidenceInterval(confidence);
+    return estimate;
+}
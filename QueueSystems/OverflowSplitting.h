@@ -0,0 +1,87 @@
+#ifndef OVERFLOW_SPLITTING_H
+#define OVERFLOW_SPLITTING_H
+
+#include "Statistics.h"
+#include "RandomStream.h"
+#include <vector>
+#include <cstdint>
+
+// Result of OverflowSplitting::estimate.
+struct SplittingEstimate {
+    // Fraction of arrivals rejected because the queue is full.
+    ConfidenceInterval blockingProbability;
+    // Mean over the replications of each stage's estimate: entry 0 is the
+    // probability that a cycle reaches the first level, entry i the
+    // probability of going on from level i to level i + 1 before the queue
+    // empties.
+    std::vector<double> levelProbabilities;
+    // Mean number of rejections from the first time the queue is full until it empties.
+    double rejectionsPerOverflow;
+    // Mean number of arrivals (accepted or rejected) per regenerative cycle.
+    double arrivalsPerCycle;
+    // Events simulated over all stages and replications.
+    std::uint64_t eventsProcessed;
+};
+
+// OverflowSplitting estimates the blocking probability of a CANQueue (an
+// M/M/s queue with room for capacity customers and no downstream queue)
+// by fixed-effort multilevel splitting, for probabilities far too small to
+// observe in a plain run.
+//
+// A regenerative cycle runs from one moment the queue empties to the next.
+// The blocking probability is E[rejections per cycle] / E[arrivals per
+// cycle], and a cycle rejects arrivals only if it climbs through every level
+// L1 < L2 < ... < capacity of the number in system. So
+//   E[rejections per cycle] = P(cycle reaches L1)
+//                             * P(L1 -> L2 before emptying) * ...
+//                             * E[rejections from first reaching capacity until empty].
+// Stage 0 simulates plain cycles from an empty queue; it estimates the
+// arrivals per cycle and P(cycle reaches L1), and checkpoints the state at
+// each first entrance to L1. Each later stage restores effort copies of the
+// previous stage's entrance states (round robin) into fresh simulations,
+// gives every copy new random streams and runs it until it reaches the next
+// level, whose state it checkpoints, or empties. The copies started from
+// capacity run until the queue empties and count the rejections. The product
+// of the stage estimates is an unbiased estimate of E[rejections per cycle];
+// the blocking probability is its ratio to the arrivals per cycle.
+//
+// Independent replications, run in parallel, give the confidence interval.
+class OverflowSplitting {
+public:
+    // threads = 0 uses one thread per hardware core.
+    OverflowSplitting(double arrivalRate, double serviceRate, int servers, int capacity,
+        std::uint64_t masterSeed, unsigned threads = 0);
+
+    // Intermediate levels of the number in system, increasing and below the
+    // capacity (which is always the last level). By default the levels are
+    // spaced so that each is reached from the one below with probability
+    // about 0.2.
+    void setLevels(const std::vector<int>& levels);
+    const std::vector<int>& getLevels() const;
+
+    // Copies simulated from each level (default 1000).
+    void setEffort(int trialsPerStage);
+
+    // Plain regenerative cycles simulated in stage 0 (default 10000).
+    void setCycles(int cycles);
+
+    // Run the replications and return the estimate.
+    SplittingEstimate estimate(int replications, double confidence = 0.95) const;
+
+private:
+    struct Replication;
+
+    double arrivalRate;
+    double serviceRate;
+    int servers;
+    int capacity;
+    std::uint64_t masterSeed;
+    unsigned threads;
+    std::vector<int> levels;  // Ends with capacity.
+    int effort;
+    int cycles;
+
+    Replication runReplication(std::uint64_t replication) const;
+};
+
+#endif // OVERFLOW_SPLITTING_H
@@ -0,0 +1,164 @@
+#include "PartitionedJacksonNetwork.h"
+#include <barrier>
+#include <thread>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+PartitionedJacksonNetwork::PartitionedJacksonNetwork(int partitions, std::uint64_t masterSeed)
+    : partitionCount(std::max(1, partitions)), masterSeed(masterSeed), windows(0)
+{
+}
+
+int PartitionedJacksonNetwork::addMM1Queue(double arrivalRate, double serviceRate) {
+    nodeSpecs.push_back(NodeSpec{ arrivalRate, serviceRate, 0, -1 });
+    return static_cast<int>(nodeSpecs.size()) - 1;
+}
+
+int PartitionedJacksonNetwork::addMMSQueue(double arrivalRate, double serviceRate, int servers) {
+    nodeSpecs.push_back(NodeSpec{ arrivalRate, serviceRate, servers, -1 });
+    return static_cast<int>(nodeSpecs.size()) - 1;
+}
+
+void PartitionedJacksonNetwork::setRoutingMatrix(const std::vector<std::vector<double>>& matrix) {
+    routing = RoutingTable::fromDense(matrix).getEntries();
+}
+
+void PartitionedJacksonNetwork::setRouting(const std::vector<RoutingEntry>& entries) {
+    routing = entries;
+}
+
+void PartitionedJacksonNetwork::setPartition(int nodeId, int partition) {
+    if (nodeId >= 0 && nodeId < static_cast<int>(nodeSpecs.size()) && partition >= 0 && partition < partitionCount)
+        nodeSpecs[nodeId].partition = partition;
+}
+
+void PartitionedJacksonNetwork::buildPartitions() {
+    int nodeCount = static_cast<int>(nodeSpecs.size());
+    for (int node = 0; node < nodeCount; node++) {
+        if (nodeSpecs[node].partition < 0)
+            nodeSpecs[node].partition = static_cast<int>(static_cast<long long>(node) * partitionCount / nodeCount);
+    }
+
+    partitions.clear();
+    for (int p = 0; p < partitionCount; p++) {
+        auto partition = std::make_unique<Partition>();
+        partition->sim.seedRandomStreams(masterSeed, static_cast<std::uint64_t>(p));
+        partition->network = std::make_unique<JacksonNetwork>(partition->sim);
+        partition->outbox.resize(partitionCount);
+
+        // Global node ids are kept: nodes owned by other partitions become remote nodes,
+        // and only the routing rows of local nodes are copied.
+        for (int node = 0; node < nodeCount; node++) {
+            const NodeSpec& spec = nodeSpecs[node];
+            if (spec.partition != p) {
+                partition->network->addRemoteNode();
+                continue;
+            }
+            if (spec.servers > 0)
+                partition->network->addMMSQueue(spec.arrivalRate, spec.serviceRate, spec.servers);
+            else
+                partition->network->addMM1Queue(spec.arrivalRate, spec.serviceRate);
+        }
+        std::vector<RoutingEntry> localRouting;
+        for (const RoutingEntry& entry : routing) {
+            if (entry.from >= 0 && entry.from < nodeCount && nodeSpecs[entry.from].partition == p)
+                localRouting.push_back(entry);
+        }
+        partition->network->setRouting(localRouting);
+
+        Partition* source = partition.get();
+        partition->network->setRemoteRouter([this, source](int nodeId, double arrivalTime) {
+            source->outbox[nodeSpecs[nodeId].partition].push_back(RoutedCustomer{ arrivalTime, nodeId });
+            source->messagesSent++;
+        });
+        partitions.push_back(std::move(partition));
+    }
+}
+
+void PartitionedJacksonNetwork::deliverMessages(int p) {
+    Partition& partition = *partitions[p];
+    for (auto& source : partitions) {
+        std::vector<RoutedCustomer>& inbox = source->outbox[p];
+        for (const RoutedCustomer& customer : inbox) {
+            partition.network->getNode(customer.nodeId)->scheduleInternalArrival(partition.sim, customer.arrivalTime);
+        }
+        inbox.clear();
+    }
+}
+
+void PartitionedJacksonNetwork::run(double endTime) {
+    buildPartitions();
+    for (auto& partition : partitions) {
+        partition->network->start();
+    }
+
+    const double lookahead = epsilon;
+    windows = 0;
+    std::barrier<> sync(partitionCount);
+
+    auto worker = [&](int p) {
+        Partition& partition = *partitions[p];
+        double windowStart = 0.0;
+        for (;;) {
+            if (p == 0)
+                windows++;
+
+            // Phase 1: process every local event in [windowStart, windowStart + lookahead).
+            // Nothing received from another partition can arrive before the window ends.
+            double windowEnd = windowStart + lookahead;
+            bool lastWindow = windowEnd > endTime;
+            partition.sim.run(lastWindow ? endTime : std::nextafter(windowEnd, -std::numeric_limits<double>::infinity()));
+            sync.arrive_and_wait();
+
+            // Phase 2: take delivery of the customers routed here during the window.
+            deliverMessages(p);
+            partition.nextEventTime = partition.sim.getNextEventTime();
+            sync.arrive_and_wait();
+
+            // Phase 3: every partition computes the same next window. Windows
+            // with no events anywhere are skipped.
+            if (lastWindow)
+                break;
+            double nextEventTime = std::numeric_limits<double>::infinity();
+            for (const auto& other : partitions)
+                nextEventTime = std::min(nextEventTime, other->nextEventTime);
+            if (nextEventTime > endTime)
+                break;
+            windowStart = std::max(windowEnd, nextEventTime);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int p = 1; p < partitionCount; p++) {
+        threads.emplace_back(worker, p);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+QueueModel* PartitionedJacksonNetwork::getNode(int nodeId) {
+    if (nodeId < 0 || nodeId >= static_cast<int>(nodeSpecs.size()) || partitions.empty())
+        return nullptr;
+    return partitions[nodeSpecs[nodeId].partition]->network->getNode(nodeId);
+}
+
+std::uint64_t PartitionedJacksonNetwork::getEventsProcessed() const {
+    std::uint64_t events = 0;
+    for (const auto& partition : partitions)
+        events += partition->sim.getEventsProcessed();
+    return events;
+}
+
+std::uint64_t PartitionedJacksonNetwork::getCrossPartitionMessages() const {
+    std::uint64_t messages = 0;
+    for (const auto& partition : partitions)
+        messages += partition->messagesSent;
+    return messages;
+}
+
+std::uint64_t PartitionedJacksonNetwork::getWindows() const {
+    return windows;
+}
@@ -0,0 +1,87 @@
+#ifndef PARTITIONED_JACKSON_NETWORK_H
+#define PARTITIONED_JACKSON_NETWORK_H
+
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// PartitionedJacksonNetwork runs one Jackson network on several threads
+// using conservative parallel discrete-event simulation.
+//
+// The nodes are split into partitions, each with its own Simulation, event
+// queue and JacksonNetwork. Every routed customer reaches its destination
+// epsilon time units after leaving its source, so epsilon is a guaranteed
+// lookahead: nothing a partition does in the time window [t, t + epsilon)
+// can affect another partition before t + epsilon. The partitions therefore
+// advance in lock step through windows of width epsilon, with a barrier
+// between windows. Customers routed across partitions are written to
+// per-(source, destination) mailboxes during a window and delivered after
+// the barrier, so the message path needs no locks.
+//
+// The model is the same as a sequential JacksonNetwork; only the random
+// streams and the order of simultaneous events differ, so the results are
+// statistically identical to a sequential run.
+class PartitionedJacksonNetwork {
+public:
+    // Customers are seeded from masterSeed; partition p uses replication p of it.
+    PartitionedJacksonNetwork(int partitions, std::uint64_t masterSeed);
+
+    // Add nodes. Node ids are global and numbered in order of addition.
+    int addMM1Queue(double arrivalRate, double serviceRate);
+    int addMMSQueue(double arrivalRate, double serviceRate, int servers);
+
+    // Same meaning as JacksonNetwork::setRoutingMatrix and setRouting.
+    void setRoutingMatrix(const std::vector<std::vector<double>>& routingMatrix);
+    void setRouting(const std::vector<RoutingEntry>& entries);
+
+    // Optionally assign a node to a partition. Unassigned nodes are split
+    // into contiguous blocks of node ids.
+    void setPartition(int nodeId, int partition);
+
+    // Build the partitions, start every node and simulate until endTime.
+    void run(double endTime);
+
+    // Access a node after run(); the node lives in its partition's simulation.
+    QueueModel* getNode(int nodeId);
+
+    // Statistics about the last run.
+    std::uint64_t getEventsProcessed() const;
+    std::uint64_t getCrossPartitionMessages() const;
+    std::uint64_t getWindows() const;
+
+private:
+    struct NodeSpec {
+        double arrivalRate;
+        double serviceRate;
+        int servers;        // 0 for an M/M/1 node.
+        int partition;      // -1 until assigned.
+    };
+
+    // A customer routed to a node in another partition.
+    struct RoutedCustomer {
+        double arrivalTime;
+        int nodeId;
+    };
+
+    struct Partition {
+        Simulation sim;
+        std::unique_ptr<JacksonNetwork> network;  // Created once sim has been seeded.
+        std::vector<std::vector<RoutedCustomer>> outbox;  // Indexed by destination partition.
+        double nextEventTime = 0.0;  // Earliest pending event after the last window.
+        std::uint64_t messagesSent = 0;
+    };
+
+    int partitionCount;
+    std::uint64_t masterSeed;
+    std::vector<NodeSpec> nodeSpecs;
+    std::vector<RoutingEntry> routing;  // Nonzero entries only.
+    std::vector<std::unique_ptr<Partition>> partitions;
+    std::uint64_t windows;
+
+    void buildPartitions();
+    void deliverMessages(int partition);
+};
+
+#endif // PARTITIONED_JACKSON_NETWORK_H
@@ -0,0 +1,136 @@
+#include "ProductForm.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::vector<double> solveTrafficEquations(const std::vector<double>& externalRates,
+    const std::vector<RoutingEntry>& routing, int& iterations, double tolerance, int maxIterations)
+{
+    std::size_t n = externalRates.size();
+
+    // Incoming routes of each node (compressed by destination); self-loops
+    // are kept apart and solved for directly.
+    std::vector<std::size_t> start(n + 1, 0);
+    std::vector<double> selfLoop(n, 0.0);
+    for (const RoutingEntry& entry : routing) {
+        if (entry.from < 0 || entry.to < 0 || entry.from >= static_cast<int>(n) || entry.to >= static_cast<int>(n))
+            continue;
+        if (entry.from == entry.to)
+            selfLoop[entry.to] += entry.probability;
+        else
+            start[entry.to + 1]++;
+    }
+    for (std::size_t i = 0; i < n; i++)
+        start[i + 1] += start[i];
+    std::vector<int> sources(start[n]);
+    std::vector<double> probabilities(start[n]);
+    std::vector<std::size_t> next(start.begin(), start.end() - 1);
+    for (const RoutingEntry& entry : routing) {
+        if (entry.from < 0 || entry.to < 0 || entry.from >= static_cast<int>(n) || entry.to >= static_cast<int>(n)
+            || entry.from == entry.to)
+            continue;
+        sources[next[entry.to]] = entry.from;
+        probabilities[next[entry.to]++] = entry.probability;
+    }
+
+    std::vector<double> rates = externalRates;
+    for (iterations = 1; iterations <= maxIterations; iterations++) {
+        double change = 0.0;
+        for (std::size_t i = 0; i < n; i++) {
+            double inflow = externalRates[i];
+            for (std::size_t k = start[i]; k < start[i + 1]; k++)
+                inflow += probabilities[k] * rates[sources[k]];
+            double rate = selfLoop[i] < 1.0 ? inflow / (1.0 - selfLoop[i]) : std::numeric_limits<double>::infinity();
+            if (rate != rates[i])
+                change = std::max(change, std::abs(rate - rates[i]) / std::max(std::abs(rate), 1e-300));
+            rates[i] = rate;
+        }
+        if (!(change > tolerance))
+            return rates;
+    }
+    iterations = -1;
+    return rates;
+}
+
+NodeSolution solveMMSNode(double arrivalRate, double serviceRate, int servers) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    NodeSolution node{ arrivalRate, 0.0, infinity, infinity, infinity, infinity, false };
+    if (servers < 1 || !(serviceRate > 0.0))
+        return node;
+    double a = arrivalRate / serviceRate;  // Offered load.
+    node.utilization = a / servers;
+    if (!(node.utilization < 1.0))
+        return node;
+
+    // Erlang B by its recursion, then Erlang C (probability of waiting).
+    double erlangB = 1.0;
+    for (int k = 1; k <= servers; k++)
+        erlangB = a * erlangB / (k + a * erlangB);
+    double erlangC = erlangB / (1.0 - node.utilization * (1.0 - erlangB));
+
+    node.stable = true;
+    node.averageNumberWaiting = erlangC * node.utilization / (1.0 - node.utilization);
+    node.averageNumberInSystem = node.averageNumberWaiting + a;
+    // With no arrivals, report the times a customer would see.
+    node.averageWaitingTime = arrivalRate > 0.0 ? node.averageNumberWaiting / arrivalRate : 0.0;
+    node.averageSojournTime = node.averageWaitingTime + 1.0 / serviceRate;
+    return node;
+}
+
+NetworkSolution solveProductForm(const std::vector<ProductFormNode>& nodes,
+    const std::vector<RoutingEntry>& routing, double routingDelay)
+{
+    NetworkSolution solution;
+    std::vector<double> externalRates(nodes.size());
+    solution.externalArrivalRate = 0.0;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        externalRates[i] = nodes[i].externalArrivalRate;
+        solution.externalArrivalRate += externalRates[i];
+    }
+
+    std::vector<double> rates = solveTrafficEquations(externalRates, routing, solution.iterations);
+    solution.converged = solution.iterations >= 0;
+
+    solution.averageNumberInNetwork = 0.0;
+    double totalRate = 0.0;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        solution.nodes.push_back(solveMMSNode(rates[i], nodes[i].serviceRate, nodes[i].servers));
+        if (!solution.nodes.back().stable)
+            solution.unstableNodes.push_back(static_cast<int>(i));
+        solution.averageNumberInNetwork += solution.nodes.back().averageNumberInSystem;
+        totalRate += rates[i];
+    }
+
+    // Each customer makes (total rate - external rate) / external rate hops.
+    solution.averageSojournTime = std::numeric_limits<double>::infinity();
+    if (solution.externalArrivalRate > 0.0 && std::isfinite(solution.averageNumberInNetwork)) {
+        double hops = (totalRate - solution.externalArrivalRate) / solution.externalArrivalRate;
+        solution.averageSojournTime = solution.averageNumberInNetwork / solution.externalArrivalRate
+            + hops * routingDelay;
+    }
+    return solution;
+}
+
+std::vector<NodeValidation> validateSimulation(const NetworkSolution& solution,
+    const std::vector<ConfidenceInterval>& simulated, double relativeTolerance)
+{
+    std::vector<NodeValidation> validation;
+    std::size_t count = std::min(solution.nodes.size(), simulated.size());
+    for (std::size_t i = 0; i < count; i++) {
+        double analytic = solution.nodes[i].averageNumberInSystem;
+        double difference = std::abs(simulated[i].mean - analytic);
+        NodeValidation node{ analytic, simulated[i], analytic > 0.0 ? difference / analytic : difference, false };
+        node.consistent = std::isfinite(analytic) && difference <= simulated[i].halfWidth + relativeTolerance * analytic;
+        validation.push_back(node);
+    }
+    return validation;
+}
+
+std::vector<NodeValidation> validateSimulation(const NetworkSolution& solution,
+    const std::vector<NodeSummary>& simulated, double relativeTolerance)
+{
+    std::vector<ConfidenceInterval> intervals;
+    for (const NodeSummary& summary : simulated)
+        intervals.push_back(summary.averageNumberInSystem);
+    return validateSimulation(solution, intervals, relativeTolerance);
+}
@@ -0,0 +1,81 @@
+#ifndef PRODUCT_FORM_H
+#define PRODUCT_FORM_H
+
+#include "Statistics.h"
+#include "ReplicationRunner.h"
+#include "RoutingTable.h"
+#include <vector>
+
+// Closed-form steady state of open Jackson networks: solve the traffic
+// equations lambda = gamma + P^T lambda for the total arrival rate of every
+// node, then treat each node as an independent M/M/s queue (Jackson's
+// theorem). See JacksonNetwork::solveProductForm.
+
+// A node as the solver sees it.
+struct ProductFormNode {
+    double externalArrivalRate;
+    double serviceRate;
+    int servers;
+};
+
+// Steady state of one node. Unstable nodes (utilization >= 1) have
+// infinite queue lengths and times.
+struct NodeSolution {
+    double arrivalRate;            // Total (external + routed) arrival rate.
+    double utilization;            // arrivalRate / (servers * serviceRate).
+    double averageNumberInSystem;  // L
+    double averageNumberWaiting;   // Lq
+    double averageSojournTime;     // W = L / arrivalRate
+    double averageWaitingTime;     // Wq = Lq / arrivalRate
+    bool stable;
+};
+
+struct NetworkSolution {
+    std::vector<NodeSolution> nodes;
+    std::vector<int> unstableNodes;
+    double externalArrivalRate;     // Sum of the external rates.
+    double averageNumberInNetwork;  // Sum of the nodes' L.
+    // Mean time from a customer's external arrival to its exit, including
+    // the routing delay of every hop (Little's law over the network).
+    double averageSojournTime;
+    // Whether the traffic equations converged. They do not if customers can
+    // circulate forever (a routing cycle with no exit).
+    bool converged;
+    int iterations;
+    bool stable() const { return converged && unstableNodes.empty(); }
+};
+
+// Solve lambda = gamma + P^T lambda by Gauss-Seidel sweeps over each node's
+// incoming routes, which costs O(nodes + routes) per sweep. Stops when no
+// rate changes by more than tolerance (relative) in a sweep; iterations
+// receives the number of sweeps, or -1 if maxIterations was not enough.
+std::vector<double> solveTrafficEquations(const std::vector<double>& externalRates,
+    const std::vector<RoutingEntry>& routing, int& iterations,
+    double tolerance = 1e-12, int maxIterations = 100000);
+
+// Steady state of an M/M/s queue with the given total arrival rate (Erlang C).
+NodeSolution solveMMSNode(double arrivalRate, double serviceRate, int servers);
+
+// Solve a whole network. routingDelay is the time a routed customer spends
+// between two nodes (epsilon in JacksonNetwork).
+NetworkSolution solveProductForm(const std::vector<ProductFormNode>& nodes,
+    const std::vector<RoutingEntry>& routing, double routingDelay = 0.0);
+
+// Analytic and simulated average number in system of one node.
+struct NodeValidation {
+    double analytic;
+    ConfidenceInterval simulated;
+    double relativeError;  // |simulated - analytic| / analytic.
+    // The analytic value lies within the simulated half-width, widened by
+    // relativeTolerance * analytic.
+    bool consistent;
+};
+
+// Compare simulated average numbers in system with a solution.
+std::vector<NodeValidation> validateSimulation(const NetworkSolution& solution,
+    const std::vector<ConfidenceInterval>& simulated, double relativeTolerance = 0.0);
+// The same for the per-node summaries of ReplicationRunner::run.
+std::vector<NodeValidation> validateSimulation(const NetworkSolution& solution,
+    const std::vector<NodeSummary>& simulated, double relativeTolerance = 0.0);
+
+#endif // PRODUCT_FORM_H
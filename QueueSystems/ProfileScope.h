@@ -0,0 +1,15 @@
+#ifndef PROFILE_SCOPE_H
+#define PROFILE_SCOPE_H
+
+// QS_PROFILE_SCOPE(phase) times the enclosing block as a ProfilePhase of the
+// active profiler (see SimulationProfiler.h). Without QS_PROFILE it expands
+// to nothing, and the hot-path headers that use it need not include the
+// profiler.
+#ifdef QS_PROFILE
+#include "SimulationProfiler.h"
+#define QS_PROFILE_SCOPE(phase) ProfileScope profileScope(ProfilePhase::phase)
+#else
+#define QS_PROFILE_SCOPE(phase)
+#endif
+
+#endif // PROFILE_SCOPE_H
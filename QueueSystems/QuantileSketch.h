@@ -0,0 +1,143 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+// QuantileSketch estimates quantiles of a stream of non-negative values
+// (e.g. waiting times) in bounded memory, in the manner of an HDR
+// histogram. Every power of two is split into 2^precisionBits equal
+// buckets, so a quantile is reported with a relative error of at most
+// 2^-(precisionBits + 1): 0.8% with the default of 6 bits. Memory depends
+// on the range of the values (one counter per bucket between the smallest
+// and the largest power of two seen), not on their number. Sketches of the
+// same precision can be merged, e.g. to combine the nodes of a network or
+// several replications.
+class QuantileSketch {
+public:
+    static const int defaultPrecisionBits = 6;
+
+    explicit QuantileSketch(int precisionBits = defaultPrecisionBits)
+        : precisionBits(std::clamp(precisionBits, 0, 16)), subBuckets(1 << this->precisionBits)
+    {
+        reset();
+    }
+
+    // Add one value. Negative, infinite and NaN values are ignored.
+    void add(double value) {
+        if (!(value >= 0.0) || !std::isfinite(value))
+            return;
+        count++;
+        sum += value;
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        if (value == 0.0) {
+            zeroCount++;
+            return;
+        }
+        int exponent;
+        double mantissa = std::frexp(value, &exponent);  // In [0.5, 1).
+        int subBucket = static_cast<int>((mantissa * 2.0 - 1.0) * subBuckets);
+        cover(exponent);
+        counts[static_cast<std::size_t>(exponent - minExponent) * subBuckets + subBucket]++;
+    }
+
+    // Add the values of another sketch. Returns false (and changes nothing)
+    // if the precisions differ.
+    bool merge(const QuantileSketch& other) {
+        if (other.precisionBits != precisionBits)
+            return false;
+        if (other.count == 0)
+            return true;
+        count += other.count;
+        zeroCount += other.zeroCount;
+        sum += other.sum;
+        minimum = std::min(minimum, other.minimum);
+        maximum = std::max(maximum, other.maximum);
+        if (!other.counts.empty()) {
+            int otherOctaves = static_cast<int>(other.counts.size()) / subBuckets;
+            cover(other.minExponent);
+            cover(other.minExponent + otherOctaves - 1);
+            std::size_t offset = static_cast<std::size_t>(other.minExponent - minExponent) * subBuckets;
+            for (std::size_t i = 0; i < other.counts.size(); i++)
+                counts[offset + i] += other.counts[i];
+        }
+        return true;
+    }
+
+    // The value below which a fraction q of the values lie (q in [0, 1]).
+    // Returns NaN if the sketch is empty.
+    double quantile(double q) const {
+        if (count == 0)
+            return std::numeric_limits<double>::quiet_NaN();
+        q = std::clamp(q, 0.0, 1.0);
+        if (q == 0.0)
+            return minimum;
+        std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * count)));
+        std::uint64_t cumulative = zeroCount;
+        if (cumulative >= rank)
+            return 0.0;
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            cumulative += counts[i];
+            if (cumulative >= rank)
+                return std::clamp(bucketMidpoint(i), minimum, maximum);
+        }
+        return maximum;
+    }
+
+    void reset() {
+        counts.clear();
+        minExponent = 0;
+        count = 0;
+        zeroCount = 0;
+        sum = 0.0;
+        minimum = std::numeric_limits<double>::infinity();
+        maximum = -std::numeric_limits<double>::infinity();
+    }
+
+    std::uint64_t getCount() const { return count; }
+    double getMean() const { return count > 0 ? sum / count : 0.0; }
+    double getMin() const { return count > 0 ? minimum : 0.0; }
+    double getMax() const { return count > 0 ? maximum : 0.0; }
+    int getPrecisionBits() const { return precisionBits; }
+    // Number of bucket counters currently held.
+    std::size_t getBucketCount() const { return counts.size(); }
+
+private:
+    int precisionBits;
+    int subBuckets;                     // Buckets per power of two.
+    std::vector<std::uint64_t> counts;  // Buckets of the powers of two from minExponent up.
+    int minExponent;
+    std::uint64_t count;
+    std::uint64_t zeroCount;
+    double sum;
+    double minimum;
+    double maximum;
+
+    // Make sure the buckets cover the values with frexp exponent exponent.
+    void cover(int exponent) {
+        if (counts.empty()) {
+            minExponent = exponent;
+            counts.assign(subBuckets, 0);
+            return;
+        }
+        if (exponent < minExponent) {
+            counts.insert(counts.begin(), static_cast<std::size_t>(minExponent - exponent) * subBuckets, 0);
+            minExponent = exponent;
+        }
+        std::size_t needed = static_cast<std::size_t>(exponent - minExponent + 1) * subBuckets;
+        if (counts.size() < needed)
+            counts.resize(needed, 0);
+    }
+
+    double bucketMidpoint(std::size_t index) const {
+        int exponent = minExponent + static_cast<int>(index / subBuckets);
+        double subBucket = static_cast<double>(index % subBuckets);
+        return std::ldexp(1.0 + (subBucket + 0.5) / subBuckets, exponent - 1);
+    }
+};
+
+#endif // QUANTILE_SKETCH_H
@@ -0,0 +1,85 @@
+#ifndef QUEUE_EVENT_DISPATCH_H
+#define QUEUE_EVENT_DISPATCH_H
+
+#include "StaticQueueEvent.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "DD1Queue.h"
+#include "CANQueue.h"
+#include "JacksonNetwork.h"
+#include "CompactJacksonNetwork.h"
+#include <variant>
+#include <type_traits>
+#include <cstddef>
+
+// Static dispatch of StaticQueueEvents, inline so that the type switch and
+// the handler calls compile into the event loop (Simulation.cpp). The
+// compilers' size heuristics would otherwise leave a call per model type.
+#if defined(_MSC_VER)
+#define QS_FORCE_INLINE __forceinline
+#else
+#define QS_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+// Call the handler for one event type on a model of static type Model.
+// Built-in models get a qualified (non-virtual) call; anything else goes
+// through the QueueModel virtual interface.
+template <typename Model>
+QS_FORCE_INLINE void handleQueueEvent(Model* queue, Simulation& sim, const StaticQueueEvent& event) {
+    if constexpr (std::is_same<Model, CompactJacksonNetwork>::value) {
+        queue->handleNodeEvent(sim, event.type, event.server);
+    }
+    else if constexpr (std::is_same<Model, QueueModel>::value) {
+        switch (event.type) {
+        case QueueEventType::ExternalArrival: queue->handleExternalArrival(sim); break;
+        case QueueEventType::InternalArrival: queue->handleInternalArrival(sim); break;
+        case QueueEventType::Departure:       queue->handleDeparture(sim); break;
+        case QueueEventType::ServiceCompletion:
+            static_cast<MMSQueue*>(queue)->completeService(sim, event.server);
+            break;
+        case QueueEventType::ForwardAttempt:
+            static_cast<CANQueue*>(queue)->attemptForward(sim);
+            break;
+        }
+    }
+    else {
+        switch (event.type) {
+        case QueueEventType::ExternalArrival: queue->Model::handleExternalArrival(sim); break;
+        case QueueEventType::InternalArrival: queue->Model::handleInternalArrival(sim); break;
+        case QueueEventType::Departure:       queue->Model::handleDeparture(sim); break;
+        case QueueEventType::ServiceCompletion:
+            if constexpr (std::is_base_of<MMSQueue, Model>::value) {
+                queue->releaseServer(event.server);
+                queue->Model::handleDeparture(sim);
+            }
+            break;
+        case QueueEventType::ForwardAttempt:
+            if constexpr (std::is_base_of<CANQueue, Model>::value)
+                queue->attemptForward(sim);
+            break;
+        }
+    }
+}
+
+template <std::size_t Index>
+QS_FORCE_INLINE void handleQueueEventAs(Simulation& sim, const StaticQueueEvent& event) {
+    handleQueueEvent(*std::get_if<Index>(&event.queue), sim, event);
+}
+
+// A switch on the model type rather than std::visit, which GCC leaves as a
+// call when the variant has this many alternatives.
+inline void dispatchQueueEvent(Simulation& sim, const StaticQueueEvent& event) {
+    static_assert(std::variant_size<QueueModelRef>::value == 8, "add a case for the new model type");
+    switch (event.queue.index()) {
+    case 0: handleQueueEventAs<0>(sim, event); break;
+    case 1: handleQueueEventAs<1>(sim, event); break;
+    case 2: handleQueueEventAs<2>(sim, event); break;
+    case 3: handleQueueEventAs<3>(sim, event); break;
+    case 4: handleQueueEventAs<4>(sim, event); break;
+    case 5: handleQueueEventAs<5>(sim, event); break;
+    case 6: handleQueueEventAs<6>(sim, event); break;
+    case 7: handleQueueEventAs<7>(sim, event); break;
+    }
+}
+
+#endif // QUEUE_EVENT_DISPATCH_H
@@ -0,0 +1,85 @@
+#include "QueueEvents.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "DD1Queue.h"
+#include "CANQueue.h"
+#include "JacksonNetwork.h"
+#include "CompactJacksonNetwork.h"
+#include <typeinfo>
+
+namespace {
+
+    // Pointer to a model as its QueueModel base.
+    QueueModel* baseOf(const QueueModelRef& ref) {
+        return std::visit([](auto* queue) -> QueueModel* { return queue; }, ref);
+    }
+
+    template <typename Model>
+    bool resolveAs(QueueModel* queue, QueueModelRef& ref) {
+        if (typeid(*queue) != typeid(Model))
+            return false;
+        ref = static_cast<Model*>(queue);
+        return true;
+    }
+
+}
+
+EventHandle scheduleVirtualQueueEvent(Simulation& sim, double time, const StaticQueueEvent& event) {
+    if (auto network = std::get_if<CompactJacksonNetwork*>(&event.queue))
+        return sim.scheduleEvent<CompactNodeEvent>(time, *network, event.type, event.server);
+    QueueModel* queue = baseOf(event.queue);
+    switch (event.type) {
+    case QueueEventType::ExternalArrival:
+        return sim.scheduleEvent<ExternalArrivalEvent>(time, queue);
+    case QueueEventType::InternalArrival:
+        return sim.scheduleEvent<InternalArrivalEvent>(time, queue);
+    case QueueEventType::ServiceCompletion:
+        return sim.scheduleEvent<ServiceCompletionEvent>(time, static_cast<MMSQueue*>(queue), event.server);
+    case QueueEventType::ForwardAttempt:
+        return sim.scheduleEvent<ForwardAttemptEvent>(time, static_cast<CANQueue*>(queue));
+    case QueueEventType::Departure:
+    default:
+        return sim.scheduleEvent<GenericDepartureEvent>(time, queue);
+    }
+}
+
+bool describeQueueEvent(const Event& event, StaticQueueEvent& result) {
+    if (auto node = dynamic_cast<const CompactNodeEvent*>(&event)) {
+        result = StaticQueueEvent{ node->type, node->node, node->network };
+        return true;
+    }
+    if (auto completion = dynamic_cast<const ServiceCompletionEvent*>(&event)) {
+        result = StaticQueueEvent{ QueueEventType::ServiceCompletion, completion->server,
+            resolveQueueModelRef(completion->queue) };
+        return true;
+    }
+    if (auto forward = dynamic_cast<const ForwardAttemptEvent*>(&event)) {
+        result = StaticQueueEvent{ QueueEventType::ForwardAttempt, 0, resolveQueueModelRef(forward->queue) };
+        return true;
+    }
+    if (auto arrival = dynamic_cast<const ExternalArrivalEvent*>(&event)) {
+        result = StaticQueueEvent{ QueueEventType::ExternalArrival, 0, resolveQueueModelRef(arrival->queue) };
+        return true;
+    }
+    if (auto arrival = dynamic_cast<const InternalArrivalEvent*>(&event)) {
+        result = StaticQueueEvent{ QueueEventType::InternalArrival, 0, resolveQueueModelRef(arrival->queue) };
+        return true;
+    }
+    if (auto departure = dynamic_cast<const GenericDepartureEvent*>(&event)) {
+        result = StaticQueueEvent{ QueueEventType::Departure, 0, resolveQueueModelRef(departure->queue) };
+        return true;
+    }
+    return false;
+}
+
+QueueModelRef resolveQueueModelRef(QueueModel* queue) {
+    QueueModelRef ref = queue;
+    resolveAs<MM1Queue>(queue, ref)
+        || resolveAs<MMSQueue>(queue, ref)
+        || resolveAs<DD1Queue>(queue, ref)
+        || resolveAs<CANQueue>(queue, ref)
+        || resolveAs<JacksonMM1Queue>(queue, ref)
+        || resolveAs<JacksonMMSQueue>(queue, ref)
+        || resolveAs<CompactJacksonNetwork>(queue, ref);
+    return ref;
+}
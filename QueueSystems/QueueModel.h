@@ -2,10 +2,16 @@
 #define QUEUEMODEL_H
 
 #include "Simulation.h"
+#include "StaticQueueEvent.h"
+
+class CheckpointWriter;
+class CheckpointReader;
 
 // Abstract base class for queueing systems.
 class QueueModel {
 public:
+    QueueModel() : dispatchRef(static_cast<QueueModel*>(nullptr)), dispatchRefResolved(false) {}
+
     virtual ~QueueModel() {}
 
     // Handle an external arrival event (e.g. arrivals from outside the network).
@@ -14,8 +20,47 @@ public:
     virtual void handleInternalArrival(Simulation& sim) = 0;
     // Handle a departure event.
     virtual void handleDeparture(Simulation& sim) = 0;
+
+    // Schedule events for this queue. Built-in models are dispatched statically.
+    EventHandle scheduleExternalArrival(Simulation& sim, double time) {
+        return sim.scheduleEvent(time, StaticQueueEvent{ QueueEventType::ExternalArrival, 0, getDispatchRef() });
+    }
+    EventHandle scheduleInternalArrival(Simulation& sim, double time) {
+        return sim.scheduleEvent(time, StaticQueueEvent{ QueueEventType::InternalArrival, 0, getDispatchRef() });
+    }
+    EventHandle scheduleDeparture(Simulation& sim, double time) {
+        return sim.scheduleEvent(time, StaticQueueEvent{ QueueEventType::Departure, 0, getDispatchRef() });
+    }
+
+    // Checkpointing (see Checkpoint.h). Save and restore the model's
+    // changing state; parameters set by the constructor are left alone.
+    virtual void saveState(CheckpointWriter&) const {}
+    virtual void restoreState(CheckpointReader&) {}
+    // Called for each pending event of this model recreated by a restore.
+    virtual void restoreEvent(const StaticQueueEvent&, const EventHandle&) {}
+    // Whether the model can process a saved event of this type and server
+    // (checked after restoreState). Every model handles the arrival and
+    // departure events; models with other events or servers override this.
+    virtual bool acceptsEvent(QueueEventType type, int) const {
+        return type == QueueEventType::ExternalArrival || type == QueueEventType::InternalArrival
+            || type == QueueEventType::Departure;
+    }
+
+protected:
+    // Pointer to this model as its most-derived built-in type. It is looked
+    // up on first use, once construction of the whole object has finished.
+    const QueueModelRef& getDispatchRef() {
+        if (!dispatchRefResolved) {
+            dispatchRef = resolveQueueModelRef(this);
+            dispatchRefResolved = true;
+        }
+        return dispatchRef;
+    }
+
+private:
+    QueueModelRef dispatchRef;
+    bool dispatchRefResolved;
 };
 
 #endif // QUEUEMODEL_H
 
-
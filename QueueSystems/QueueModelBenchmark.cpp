@@ -0,0 +1,374 @@
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "DD1Queue.h"
+#include "CANQueue.h"
+#include "JacksonNetwork.h"
+#include "MarkovJacksonNetwork.h"
+#include "ProductForm.h"
+#include "BenchmarkNetworks.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Throughput of every queue model, as JSON on standard output so that runs
+// of different commits can be compared:
+//
+//   QueueModelBenchmark [scenario ...]
+//
+// Each scenario builds a model, runs a warm-up period, restarts the
+// statistics and times a run, reporting events per second, nanoseconds and
+// heap allocations per event, and the process's peak resident set size so
+// far (run one scenario per process for its own peak). Its result is
+// checked against the analytic value; the exit code is 1 if any check fails.
+
+namespace {
+    std::atomic<std::uint64_t> allocationCount{ 0 };
+}
+
+// Count every heap allocation of the program.
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    struct Measurement {
+        std::uint64_t events = 0;
+        double seconds = 0.0;
+        std::uint64_t allocations = 0;
+    };
+
+    struct ScenarioResult {
+        std::string parameters;
+        double simulatedTime;
+        Measurement run;
+        std::string metric;
+        double expected;
+        double simulated;
+        double tolerance;  // Relative.
+    };
+
+    struct Scenario {
+        const char* name;
+        const char* model;
+        std::function<ScenarioResult()> run;
+    };
+
+    // Run sim to endTime, counting events, wall time and allocations.
+    Measurement measureRun(Simulation& sim, double endTime) {
+        Measurement m;
+        std::uint64_t events = sim.getEventsProcessed();
+        std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+        auto begin = std::chrono::steady_clock::now();
+        sim.run(endTime);
+        m.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        m.events = sim.getEventsProcessed() - events;
+        m.allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+        return m;
+    }
+
+    std::uint64_t peakResidentBytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize;
+        return 0;
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return static_cast<std::uint64_t>(usage.ru_maxrss);         // Bytes.
+#else
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;  // Kilobytes.
+#endif
+#endif
+    }
+
+    std::string describe(std::initializer_list<std::pair<const char*, double>> values) {
+        std::ostringstream out;
+        for (const auto& value : values)
+            out << (out.tellp() > 0 ? " " : "") << value.first << "=" << value.second;
+        return out.str();
+    }
+
+    // Average number in an M/M/s/K queue (birth-death chain, K >= s).
+    double mmskAverageNumber(double lambda, double mu, int s, int k) {
+        double p = 1.0, sum = 0.0, weighted = 0.0;
+        for (int n = 0; n <= k; n++) {
+            if (n > 0)
+                p *= lambda / (mu * std::min(n, s));
+            sum += p;
+            weighted += n * p;
+        }
+        return weighted / sum;
+    }
+
+    ScenarioResult runMM1() {
+        const double lambda = 0.8, mu = 1.0, warmUp = 1000.0, endTime = 2.0e6;
+        Simulation sim(1);
+        MM1Queue queue(sim, lambda, mu);
+        queue.start();
+        sim.run(warmUp);
+        queue.resetStatistics(warmUp);
+        Measurement m = measureRun(sim, endTime);
+        double rho = lambda / mu;
+        return { describe({ { "lambda", lambda }, { "mu", mu } }), endTime, m,
+            "L", rho / (1 - rho), queue.getAverageNumberInSystem(), 0.05 };
+    }
+
+    ScenarioResult runMMS(int servers, double lambda, double endTime, bool aggregate = false, double warmUp = 1000.0) {
+        const double mu = 1.0;
+        Simulation sim(2);
+        MMSQueue queue(sim, lambda, mu, servers);
+        queue.setAggregateDepartures(aggregate);
+        queue.start();
+        sim.run(warmUp);
+        queue.resetStatistics(warmUp);
+        Measurement m = measureRun(sim, endTime);
+        return { describe({ { "lambda", lambda }, { "mu", mu }, { "servers", double(servers) },
+                { "aggregate", aggregate ? 1.0 : 0.0 } }), endTime, m,
+            "L", solveMMSNode(lambda, mu, servers).averageNumberInSystem, queue.getAverageNumberInSystem(), 0.03 };
+    }
+
+    ScenarioResult runDD1() {
+        const double interarrival = 1.0, service = 0.5, endTime = 5.0e6;
+        Simulation sim(3);
+        DD1Queue queue(sim, interarrival, service);
+        queue.start();
+        Measurement m = measureRun(sim, endTime);
+        return { describe({ { "interarrival", interarrival }, { "service", service } }), endTime, m,
+            "L", service / interarrival, queue.getAverageNumberInSystem(), 1e-3 };
+    }
+
+    // Three M/M/2 nodes in a chain with blocking. The downstream capacities
+    // are large enough that the head is almost never blocked, so it behaves
+    // as an M/M/2/10 queue.
+    ScenarioResult runCANChain() {
+        const double lambda = 1.5, mu = 1.0, warmUp = 1000.0, endTime = 1.0e6;
+        const int servers = 2, headCapacity = 10, capacity = 60;
+        Simulation sim(4);
+        CANQueue head(sim, lambda, mu, servers, headCapacity);
+        CANQueue middle(sim, 0.0, mu, servers, capacity);
+        CANQueue tail(sim, 0.0, mu, servers, capacity);
+        head.setDownstream(&middle);
+        middle.setDownstream(&tail);
+        head.start();
+        sim.run(warmUp);
+        for (CANQueue* queue : { &head, &middle, &tail })
+            queue->resetStatistics(warmUp);
+        Measurement m = measureRun(sim, endTime);
+        return { describe({ { "lambda", lambda }, { "mu", mu }, { "servers", double(servers) },
+            { "headCapacity", double(headCapacity) }, { "capacity", double(capacity) } }), endTime, m,
+            "head L", mmskAverageNumber(lambda, mu, servers, headCapacity), head.getAverageNumberInSystem(), 0.03 };
+    }
+
+    // The worst relative error of a node's L in a network.
+    double worstNodeError(const JacksonNetwork& network) {
+        double worst = 0.0;
+        for (const NodeValidation& node : network.validateAgainstProductForm())
+            worst = std::max(worst, node.relativeError);
+        return worst;
+    }
+
+    // Mean over nodes of the simulated and analytic L.
+    void meanNodeL(JacksonNetwork& network, double& simulated, double& expected) {
+        NetworkSolution solution = network.solveProductForm();
+        simulated = 0.0;
+        for (int node = 0; node < network.getNodeCount(); node++)
+            simulated += static_cast<MM1Queue*>(network.getNode(node))->getAverageNumberInSystem();
+        simulated /= network.getNodeCount();
+        expected = solution.averageNumberInNetwork / network.getNodeCount();
+    }
+
+    ScenarioResult runJackson3() {
+        const double warmUp = 1000.0, endTime = 1.0e6;
+        Simulation sim(5);
+        JacksonNetwork network(sim);
+        network.addMM1Queue(4, 8);
+        network.addMMSQueue(1, 10, 2);
+        network.addMM1Queue(0, 6);
+        network.setRoutingMatrix({ { 0.0, 0.2, 0.1 }, { 0.2, 0.0, 0.3 }, { 0.1, 0.2, 0.0 } });
+        network.start();
+        sim.run(warmUp);
+        static_cast<MM1Queue*>(network.getNode(0))->resetStatistics(warmUp);
+        static_cast<MMSQueue*>(network.getNode(1))->resetStatistics(warmUp);
+        static_cast<MM1Queue*>(network.getNode(2))->resetStatistics(warmUp);
+        Measurement m = measureRun(sim, endTime);
+        // The check is on the worst node: expected 0 relative error.
+        return { "Main.cpp network", endTime, m, "worst node relative error of L", 0.0, worstNodeError(network), 0.03 };
+    }
+
+    // M/M/1 nodes with five random successors each (see BenchmarkNetworks.h).
+    ScenarioResult runJacksonRandom(int nodeCount, double endTime) {
+        const double lambda = 0.05, mu = 1.0, warmUp = 20.0;
+        Simulation sim(6);
+        JacksonNetwork network(sim);
+        for (int node = 0; node < nodeCount; node++)
+            network.addMM1Queue(lambda, mu);
+        std::vector<RoutingEntry> routing = randomRouting(nodeCount, 7);
+        network.setRouting(routing);
+        network.start();
+        sim.run(warmUp);
+        for (int node = 0; node < nodeCount; node++)
+            static_cast<MM1Queue*>(network.getNode(node))->resetStatistics(warmUp);
+        Measurement m = measureRun(sim, endTime);
+        double simulated, expected;
+        meanNodeL(network, simulated, expected);
+        return { describe({ { "nodes", double(nodeCount) }, { "lambda", lambda }, { "mu", mu }, { "successors", double(successors) } }),
+            endTime, m, "mean node L", expected, simulated, 0.03 };
+    }
+
+    // The network of runJacksonRandom as a Markov chain; events are transitions.
+    ScenarioResult runMarkovRandom(int nodeCount, double endTime) {
+        const double lambda = 0.05, mu = 1.0, warmUp = 20.0;
+        MarkovJacksonNetwork network(6);
+        network.reserve(nodeCount);
+        for (int node = 0; node < nodeCount; node++)
+            network.addMM1Queue(lambda, mu);
+        std::vector<RoutingEntry> routing = randomRouting(nodeCount, 7);
+        network.setRouting(routing);
+        network.run(warmUp);
+        network.resetStatistics();
+
+        Measurement m;
+        std::uint64_t transitions = network.getTransitionCount();
+        std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+        auto begin = std::chrono::steady_clock::now();
+        network.run(endTime);
+        m.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        m.events = network.getTransitionCount() - transitions;
+        m.allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+
+        std::vector<ProductFormNode> specs(nodeCount, ProductFormNode{ lambda, mu, 1 });
+        double expected = solveProductForm(specs, routing).averageNumberInNetwork / nodeCount;
+        double simulated = 0.0;
+        for (int node = 0; node < nodeCount; node++)
+            simulated += network.getAverageNumberInSystem(node);
+        simulated /= nodeCount;
+        return { describe({ { "nodes", double(nodeCount) }, { "lambda", lambda }, { "mu", mu }, { "successors", double(successors) } }),
+            endTime, m, "mean node L", expected, simulated, 0.03 };
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    // JSON has no infinity or NaN (e.g. a rate over a run of 0 events or 0 s).
+    std::string jsonNumber(double value) {
+        if (!std::isfinite(value))
+            return "null";
+        std::ostringstream text;
+        text << std::setprecision(6) << value;
+        return text.str();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<Scenario> scenarios = {
+        { "mm1", "MM1Queue", runMM1 },
+        { "mms_small", "MMSQueue", [] { return runMMS(4, 3.0, 1.0e6); } },
+        { "mms_large", "MMSQueue", [] { return runMMS(256, 230.0, 2.0e4); } },
+        { "mms_large_aggregate", "MMSQueue", [] { return runMMS(256, 230.0, 2.0e4, true); } },
+        { "mms_10k", "MMSQueue", [] { return runMMS(10000, 9000.0, 300.0, false, 20.0); } },
+        { "mms_10k_aggregate", "MMSQueue", [] { return runMMS(10000, 9000.0, 300.0, true, 20.0); } },
+        { "dd1", "DD1Queue", runDD1 },
+        { "can_chain", "CANQueue", runCANChain },
+        { "jackson_3", "JacksonNetwork", runJackson3 },
+        { "jackson_1k", "JacksonNetwork", [] { return runJacksonRandom(1000, 2.0e4); } },
+        { "jackson_100k", "JacksonNetwork", [] { return runJacksonRandom(100000, 200.0); } },
+        { "markov_100k", "MarkovJacksonNetwork", [] { return runMarkovRandom(100000, 200.0); } },
+    };
+
+    std::vector<std::string> selected(argv + 1, argv + argc);
+    for (const std::string& name : selected) {
+        bool known = false;
+        for (const Scenario& scenario : scenarios)
+            known = known || name == scenario.name;
+        if (!known) {
+            std::cerr << "Unknown scenario " << name << "; scenarios are:";
+            for (const Scenario& scenario : scenarios)
+                std::cerr << " " << scenario.name;
+            std::cerr << "\n";
+            return 2;
+        }
+    }
+
+    bool allPassed = true;
+    bool first = true;
+    std::cout << "{\n  \"benchmark\": \"QueueModelBenchmark\",\n  \"scenarios\": [";
+    for (const Scenario& scenario : scenarios) {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), scenario.name) == selected.end())
+            continue;
+        std::cerr << "Running " << scenario.name << "...\n";
+        ScenarioResult result = scenario.run();
+        std::uint64_t peakRss = peakResidentBytes();
+
+        double error = (result.expected != 0.0) ? std::abs(result.simulated - result.expected) / result.expected
+            : std::abs(result.simulated);
+        bool passed = error <= result.tolerance;
+        allPassed = allPassed && passed;
+        double events = static_cast<double>(result.run.events);
+
+        std::cout << (first ? "\n" : ",\n") << "    {\n"
+                  << "      \"name\": " << jsonString(scenario.name) << ",\n"
+                  << "      \"model\": " << jsonString(scenario.model) << ",\n"
+                  << "      \"parameters\": " << jsonString(result.parameters) << ",\n"
+                  << "      \"simulatedTime\": " << jsonNumber(result.simulatedTime) << ",\n"
+                  << "      \"events\": " << result.run.events << ",\n"
+                  << "      \"seconds\": " << jsonNumber(result.run.seconds) << ",\n"
+                  << "      \"eventsPerSecond\": " << jsonNumber(events / result.run.seconds) << ",\n"
+                  << "      \"nsPerEvent\": " << jsonNumber(1.0e9 * result.run.seconds / events) << ",\n"
+                  << "      \"allocationsPerEvent\": " << jsonNumber(result.run.allocations / events) << ",\n"
+                  << "      \"peakRssBytes\": " << peakRss << ",\n"
+                  << "      \"check\": {\n"
+                  << "        \"metric\": " << jsonString(result.metric) << ",\n"
+                  << "        \"expected\": " << jsonNumber(result.expected) << ",\n"
+                  << "        \"simulated\": " << jsonNumber(result.simulated) << ",\n"
+                  << "        \"tolerance\": " << jsonNumber(result.tolerance) << ",\n"
+                  << "        \"passed\": " << (passed ? "true" : "false") << "\n"
+                  << "      }\n"
+                  << "    }";
+        first = false;
+    }
+    std::cout << "\n  ],\n  \"passed\": " << (allPassed ? "true" : "false") << "\n}\n";
+    return allPassed ? 0 : 1;
+}
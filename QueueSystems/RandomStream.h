@@ -0,0 +1,138 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+//----------------------------------------------------------------
+// RandomStream: xoshiro256** generator (Blackman and Vigna, 2018)
+//----------------------------------------------------------------
+// Satisfies UniformRandomBitGenerator, so it works with the <random>
+// distributions. jump() advances the stream by 2^128 draws and longJump()
+// by 2^192 draws, which is how non-overlapping substreams are carved out.
+//
+// An antithetic stream returns the bitwise complement of every draw, so
+// nextUniform() gives 1 - u + 2^-53 where the plain stream gives u. A run
+// on antithetic copies of its streams is negatively correlated with the
+// plain run.
+class RandomStream {
+public:
+    using result_type = std::uint64_t;
+    using State = std::array<std::uint64_t, 4>;
+
+    explicit RandomStream(std::uint64_t seed = 0) : mirror(0) {
+        // Expand the seed with SplitMix64 so that similar seeds give unrelated states.
+        for (auto& word : state) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result ^ mirror;
+    }
+
+    // Uniform double in (0, 1], built from the top 53 bits.
+    double nextUniform() {
+        return (static_cast<double>((*this)() >> 11) + 1.0) * 0x1.0p-53;
+    }
+
+    // Advance by 2^128 draws.
+    void jump() {
+        static const std::uint64_t polynomial[] = {
+            0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        applyJump(polynomial);
+    }
+
+    // Advance by 2^192 draws.
+    void longJump() {
+        static const std::uint64_t polynomial[] = {
+            0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+        applyJump(polynomial);
+    }
+
+    // Mirror the draws (see above). This is part of the stream's
+    // configuration, not of its state.
+    void setAntithetic(bool antithetic) { mirror = antithetic ? ~std::uint64_t(0) : 0; }
+    bool isAntithetic() const { return mirror != 0; }
+
+    // Raw generator state, for saving and restoring a stream.
+    const State& getState() const { return state; }
+    void setState(const State& newState) { state = newState; }
+
+private:
+    State state;
+    std::uint64_t mirror;  // XORed into every draw: zero, or all ones when antithetic.
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    void applyJump(const std::uint64_t (&polynomial)[4]) {
+        State jumped{ 0, 0, 0, 0 };
+        for (std::uint64_t word : polynomial) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (word & (std::uint64_t(1) << bit)) {
+                    for (int i = 0; i < 4; i++)
+                        jumped[i] ^= state[i];
+                }
+                (*this)();
+            }
+        }
+        state = jumped;
+    }
+};
+
+//----------------------------------------------------------------
+// RandomStreamFactory: hands out non-overlapping substreams
+//----------------------------------------------------------------
+// Replication r starts r long jumps (r * 2^192 draws) after the master
+// seed, and each stream within a replication is one jump (2^128 draws)
+// after the previous one. Streams therefore never overlap as long as a
+// replication uses fewer than 2^64 streams of fewer than 2^128 draws each.
+//
+// The k-th stream handed out depends only on the seed, the replication and
+// k. Models that take their streams in the same order therefore get the
+// same streams under different configurations (common random numbers).
+class RandomStreamFactory {
+public:
+    explicit RandomStreamFactory(std::uint64_t masterSeed = 0, std::uint64_t replication = 0, bool antithetic = false)
+        : base(masterSeed), antithetic(antithetic)
+    {
+        for (std::uint64_t r = 0; r < replication; r++)
+            base.longJump();
+    }
+
+    // Return the next substream; antithetic if the factory is.
+    RandomStream next() {
+        RandomStream stream = base;
+        stream.setAntithetic(antithetic);
+        base.jump();
+        return stream;
+    }
+
+    // State of the next stream to be handed out, for checkpointing.
+    const RandomStream::State& getState() const { return base.getState(); }
+    void setState(const RandomStream::State& state) { base.setState(state); }
+
+private:
+    RandomStream base;
+    bool antithetic;
+};
+
+#endif // RANDOM_STREAM_H
@@ -0,0 +1,157 @@
+#include "ReplicationRunner.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+    using Results = std::vector<std::vector<NodeMetrics>>;
+
+    // The metrics of NodeMetrics, NodeSummary and NodeComparison, in the same order.
+    const std::array<double NodeMetrics::*, 3> metricFields = {
+        &NodeMetrics::averageNumberInSystem, &NodeMetrics::totalArrivals, &NodeMetrics::totalDepartures };
+    const std::array<ConfidenceInterval NodeSummary::*, 3> summaryFields = {
+        &NodeSummary::averageNumberInSystem, &NodeSummary::totalArrivals, &NodeSummary::totalDepartures };
+    const std::array<ConfidenceInterval NodeComparison::*, 3> comparisonFields = {
+        &NodeComparison::averageNumberInSystem, &NodeComparison::totalArrivals, &NodeComparison::totalDepartures };
+
+    std::size_t nodeCount(const Results& results) {
+        std::size_t nodes = 0;
+        for (const auto& result : results) {
+            nodes = std::max(nodes, result.size());
+        }
+        return nodes;
+    }
+
+    // Average a metric over the runs of one observation. Returns false if a
+    // run has no such node.
+    bool observation(const Results& results, int first, int runs, std::size_t node,
+        double NodeMetrics::* field, double& mean) {
+        double sum = 0.0;
+        for (int r = first; r < first + runs; r++) {
+            if (node >= results[r].size())
+                return false;
+            sum += results[r][node].*field;
+        }
+        mean = sum / runs;
+        return true;
+    }
+
+    double reductionFactor(double independentVariance, double achievedVariance) {
+        if (achievedVariance > 0.0)
+            return independentVariance / achievedVariance;
+        return (independentVariance > 0.0) ? std::numeric_limits<double>::infinity() : 1.0;
+    }
+}
+
+ReplicationRunner::ReplicationRunner(std::uint64_t masterSeed, unsigned threads)
+    : masterSeed(masterSeed), threads(threads), antithetic(false)
+{
+    if (this->threads == 0) {
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+void ReplicationRunner::setAntithetic(bool antithetic) {
+    this->antithetic = antithetic;
+}
+
+int ReplicationRunner::runsPerObservation() const {
+    return antithetic ? 2 : 1;
+}
+
+Results ReplicationRunner::runAll(int replications, const Replication& replication) const {
+    Results runResults(replications);
+    int runs = runsPerObservation();
+
+    // Workers claim replication indices from a shared counter; each writes
+    // only its own slot of the results vector.
+    std::atomic<int> nextReplication(0);
+    auto worker = [&]() {
+        for (;;) {
+            int r = nextReplication.fetch_add(1);
+            if (r >= replications)
+                break;
+            // Seeded, so that no replication reads std::random_device.
+            Simulation sim(masterSeed);
+            sim.seedRandomStreams(masterSeed, static_cast<std::uint64_t>(r / runs), r % runs == 1);
+            runResults[r] = replication(sim);
+        }
+    };
+
+    unsigned workerCount = std::min<unsigned>(threads, static_cast<unsigned>(std::max(replications, 1)));
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workerCount; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return runResults;
+}
+
+std::vector<NodeSummary> ReplicationRunner::run(int replications, const Replication& replication, double confidence) {
+    int runs = runsPerObservation();
+    int observations = (std::max(replications, 0) + runs - 1) / runs;
+    results = runAll(observations * runs, replication);
+
+    // Merge the node metrics. The variance of a single run, divided by the
+    // runs per observation, is what an observation of independent runs
+    // would have had.
+    std::vector<NodeSummary> summaries(nodeCount(results));
+    for (std::size_t node = 0; node < summaries.size(); node++) {
+        for (std::size_t m = 0; m < metricFields.size(); m++) {
+            SummaryStatistics single, merged;
+            for (int o = 0; o < observations; o++) {
+                double mean;
+                if (!observation(results, o * runs, runs, node, metricFields[m], mean))
+                    continue;
+                merged.add(mean);
+                for (int r = o * runs; r < (o + 1) * runs; r++)
+                    single.add(results[r][node].*metricFields[m]);
+            }
+            summaries[node].*summaryFields[m] = merged.getConfidenceInterval(confidence);
+            summaries[node].varianceReduction.*metricFields[m] =
+                reductionFactor(single.getVariance() / runs, merged.getVariance());
+        }
+    }
+    return summaries;
+}
+
+std::vector<NodeComparison> ReplicationRunner::compare(int replications, const Replication& baseline,
+    const Replication& alternative, double confidence) {
+    int runs = runsPerObservation();
+    int observations = (std::max(replications, 0) + runs - 1) / runs;
+    Results baselineResults = runAll(observations * runs, baseline);
+    results = runAll(observations * runs, alternative);
+
+    // With independent seeding the variance of a difference would be the
+    // sum of the variances of the two configurations.
+    std::vector<NodeComparison> comparisons(std::min(nodeCount(baselineResults), nodeCount(results)));
+    for (std::size_t node = 0; node < comparisons.size(); node++) {
+        for (std::size_t m = 0; m < metricFields.size(); m++) {
+            SummaryStatistics singleBaseline, singleAlternative, difference;
+            for (int o = 0; o < observations; o++) {
+                double baselineMean, alternativeMean;
+                if (!observation(baselineResults, o * runs, runs, node, metricFields[m], baselineMean)
+                    || !observation(results, o * runs, runs, node, metricFields[m], alternativeMean))
+                    continue;
+                difference.add(alternativeMean - baselineMean);
+                for (int r = o * runs; r < (o + 1) * runs; r++) {
+                    singleBaseline.add(baselineResults[r][node].*metricFields[m]);
+                    singleAlternative.add(results[r][node].*metricFields[m]);
+                }
+            }
+            comparisons[node].*comparisonFields[m] = difference.getConfidenceInterval(confidence);
+            comparisons[node].varianceReduction.*metricFields[m] = reductionFactor(
+                (singleBaseline.getVariance() + singleAlternative.getVariance()) / runs, difference.getVariance());
+        }
+    }
+    return comparisons;
+}
+
+const std::vector<std::vector<NodeMetrics>>& ReplicationRunner::getResults() const {
+    return results;
+}
@@ -0,0 +1,96 @@
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include "Simulation.h"
+#include "Statistics.h"
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// Metrics collected from one node in one replication.
+struct NodeMetrics {
+    double averageNumberInSystem;
+    double totalArrivals;
+    double totalDepartures;
+};
+
+// Metrics for one node merged across replications.
+struct NodeSummary {
+    ConfidenceInterval averageNumberInSystem;
+    ConfidenceInterval totalArrivals;
+    ConfidenceInterval totalDepartures;
+    // For each metric, the variance of the estimate with independent
+    // replications divided by the variance achieved, both for the same
+    // number of runs: 1 without variance reduction, 4 if the runs are worth
+    // four times as many independent ones.
+    NodeMetrics varianceReduction;
+};
+
+// Difference (alternative minus baseline) of the metrics of one node under
+// two configurations.
+struct NodeComparison {
+    ConfidenceInterval averageNumberInSystem;
+    ConfidenceInterval totalArrivals;
+    ConfidenceInterval totalDepartures;
+    // Variance of the difference with independently seeded configurations
+    // divided by the variance achieved (see NodeSummary).
+    NodeMetrics varianceReduction;
+};
+
+// Runs independent replications of a model in parallel and merges their
+// per-node metrics into t-based confidence intervals.
+//
+// Every replication gets its own Simulation, seeded with the runner's master
+// seed and the replication index, so it draws from random streams that do
+// not overlap those of any other replication. A run with the same master
+// seed reproduces the same results regardless of the number of threads.
+//
+// Two variance-reduction techniques are available:
+// - compare() runs two configurations on the same seeds, so both see the
+//   same random numbers (common random numbers; models must take their
+//   streams in the same order, as JacksonNetwork does).
+// - setAntithetic(true) runs replications in pairs, the second on the
+//   antithetic copies of the first one's streams, and treats the average
+//   of each pair as one observation.
+// Either way the summaries report the variance reduction achieved: the
+// factor by which independent replications would have to be increased to
+// reach the same precision.
+class ReplicationRunner {
+public:
+    // Builds the model on the given (already seeded) simulation, runs it and
+    // returns the metrics of each node. Called concurrently from several threads.
+    using Replication = std::function<std::vector<NodeMetrics>(Simulation& sim)>;
+
+    // threads = 0 uses one thread per hardware core.
+    ReplicationRunner(std::uint64_t masterSeed, unsigned threads = 0);
+
+    // Run the replications in antithetic pairs (replications is rounded up to even).
+    void setAntithetic(bool antithetic);
+
+    // Run the replications and return the confidence interval of every node metric.
+    std::vector<NodeSummary> run(int replications, const Replication& replication, double confidence = 0.95);
+
+    // Run both configurations with common random numbers and return the
+    // confidence interval of every node metric's difference.
+    std::vector<NodeComparison> compare(int replications, const Replication& baseline,
+        const Replication& alternative, double confidence = 0.95);
+
+    // Raw per-replication results of the last run, indexed [replication][node].
+    // After compare(), these are the results of the alternative.
+    const std::vector<std::vector<NodeMetrics>>& getResults() const;
+
+private:
+    std::uint64_t masterSeed;
+    unsigned threads;
+    bool antithetic;
+    std::vector<std::vector<NodeMetrics>> results;
+
+    // Run the replications in parallel; replication r uses seed index r / 2
+    // and is antithetic for odd r in antithetic mode.
+    std::vector<std::vector<NodeMetrics>> runAll(int replications, const Replication& replication) const;
+
+    // Runs averaged into one observation (2 for antithetic pairs).
+    int runsPerObservation() const;
+};
+
+#endif // REPLICATION_RUNNER_H
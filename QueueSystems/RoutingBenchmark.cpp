@@ -0,0 +1,126 @@
+#include "RoutingTable.h"
+#include "RandomStream.h"
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "BenchmarkNetworks.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+
+namespace {
+    volatile long long sink;  // Keeps the compiler from dropping the timed loops.
+
+    // Routing decisions per second: the dense scan with a distribution per
+    // call, as JacksonNetwork::routeCustomer did, and the alias tables.
+    void compareDecisions(int nodeCount, std::size_t decisions) {
+        std::vector<RoutingEntry> entries = randomRouting(nodeCount, 1);
+        std::vector<std::vector<double>> dense(nodeCount, std::vector<double>(nodeCount, 0.0));
+        for (const RoutingEntry& entry : entries)
+            dense[entry.from][entry.to] += entry.probability;
+        RoutingTable table(nodeCount, entries);
+
+        RandomStream rng(2);
+        long long checksum = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < decisions; i++) {
+            const std::vector<double>& row = dense[i % nodeCount];
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            double r = uniform(rng), cumulative = 0.0;
+            int destination = -1;
+            for (std::size_t j = 0; j < row.size(); j++) {
+                cumulative += row[j];
+                if (r < cumulative) {
+                    destination = static_cast<int>(j);
+                    break;
+                }
+            }
+            checksum += destination;
+        }
+        double denseSeconds = secondsSince(begin);
+
+        begin = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < decisions; i++)
+            checksum += table.sample(static_cast<int>(i % nodeCount), rng.nextUniform());
+        double aliasSeconds = secondsSince(begin);
+
+        std::cout << "  " << std::setw(6) << nodeCount << " nodes: dense scan " << std::setw(8)
+                  << 1.0e9 * denseSeconds / decisions << " ns, alias " << std::setw(6)
+                  << 1.0e9 * aliasSeconds / decisions << " ns per decision  (x"
+                  << denseSeconds / aliasSeconds << ")\n";
+        sink = checksum;
+    }
+
+    // Chi-square of alias sampling against a row's probabilities.
+    bool checkDistribution(std::size_t draws) {
+        std::vector<RoutingEntry> entries = {
+            { 0, 3, 0.05 }, { 0, 1, 0.3 }, { 0, 7, 0.125 }, { 0, 2, 0.2 }, { 0, 3, 0.05 }, { 0, 9, 0.01 }
+        };
+        RoutingTable table(1, entries);
+        std::vector<double> expected(11, 0.0);
+        double sum = 0.0;
+        for (const RoutingEntry& entry : entries) {
+            expected[entry.to] += entry.probability;
+            sum += entry.probability;
+        }
+        expected[10] = 1.0 - sum;  // Exit.
+
+        std::vector<double> counts(11, 0.0);
+        RandomStream rng(3);
+        for (std::size_t i = 0; i < draws; i++) {
+            int destination = table.sample(0, rng.nextUniform());
+            counts[destination == RoutingTable::exitNetwork ? 10 : destination] += 1.0;
+        }
+        double chiSquare = 0.0;
+        int cells = 0;
+        bool impossible = false;
+        for (int j = 0; j < 11; j++) {
+            if (expected[j] > 0.0) {
+                double e = expected[j] * draws;
+                chiSquare += (counts[j] - e) * (counts[j] - e) / e;
+                cells++;
+            }
+            else if (counts[j] > 0.0) {
+                impossible = true;
+            }
+        }
+        // 99.9% point of chi-square with 5 degrees of freedom.
+        bool passed = !impossible && cells == 6 && chiSquare < 20.52;
+        std::cout << "Alias sampling, " << draws << " draws over 5 destinations and the exit: chi-square "
+                  << chiSquare << " (limit 20.52)" << (passed ? "  ok\n" : "  FAILED\n");
+        return passed;
+    }
+}
+
+int main() {
+    std::cout << std::setprecision(4);
+    bool passed = checkDistribution(10000000);
+
+    std::cout << "\nRouting decisions, " << successors << " successors per node:\n";
+    for (int nodeCount : { 100, 1000, 4000 })
+        compareDecisions(nodeCount, 1000000);
+
+    // A 20,000-node network.
+    const int nodeCount = 20000;
+    std::vector<RoutingEntry> entries = randomRouting(nodeCount, 4);
+    RoutingTable table(nodeCount, entries);
+    std::cout << "\n" << nodeCount << " nodes: dense matrix " << double(nodeCount) * nodeCount * sizeof(double) / 1.0e9
+              << " GB, routing table " << table.getMemoryUsage() / 1.0e6 << " MB\n";
+
+    Simulation sim(20241018);
+    JacksonNetwork network(sim);
+    for (int node = 0; node < nodeCount; node++)
+        network.addMM1Queue(0.05, 1.0);
+    network.setRouting(entries);
+    network.start();
+    auto begin = std::chrono::steady_clock::now();
+    sim.run(200.0);
+    double seconds = secondsSince(begin);
+    std::cout << "Simulated T = 200: " << sim.getEventsProcessed() << " events in " << seconds << " s ("
+              << sim.getEventsProcessed() / seconds / 1.0e6 << " M events/s)\n";
+
+    std::cout << "\n" << (passed ? "All checks passed." : "Some checks FAILED.") << "\n";
+    return passed ? 0 : 1;
+}
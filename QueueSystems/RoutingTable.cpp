@@ -0,0 +1,126 @@
+#include "RoutingTable.h"
+#include <algorithm>
+
+RoutingTable::RoutingTable(int rowCount, const std::vector<RoutingEntry>& entries) {
+    rowCount = std::max(rowCount, 0);
+    std::vector<RoutingEntry> sorted;
+    sorted.reserve(entries.size());
+    for (const RoutingEntry& entry : entries) {
+        if (entry.from >= 0 && entry.from < rowCount && entry.probability != 0.0)
+            sorted.push_back(entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const RoutingEntry& a, const RoutingEntry& b) {
+        return a.from < b.from || (a.from == b.from && a.to < b.to);
+    });
+
+    rowStart.assign(static_cast<std::size_t>(rowCount) + 1, 0);
+
+    // Fill the rows, merging duplicate destinations.
+    std::size_t i = 0;
+    for (int row = 0; row < rowCount; row++) {
+        rowStart[row] = destinations.size();
+        for (; i < sorted.size() && sorted[i].from == row; i++) {
+            if (destinations.size() > rowStart[row] && destinations.back() == sorted[i].to)
+                probabilities.back() += sorted[i].probability;
+            else {
+                destinations.push_back(sorted[i].to);
+                probabilities.push_back(sorted[i].probability);
+            }
+        }
+    }
+    rowStart[rowCount] = destinations.size();
+
+    aliasStart.assign(static_cast<std::size_t>(rowCount) + 1, 0);
+    for (int row = 0; row < rowCount; row++)
+        buildAlias(row);
+}
+
+RoutingTable RoutingTable::fromEntries(int nodeCount, const std::vector<RoutingEntry>& entries) {
+    int rows = nodeCount;
+    for (const RoutingEntry& entry : entries)
+        rows = std::max(rows, entry.from + 1);
+    return RoutingTable(rows, entries);
+}
+
+RoutingTable RoutingTable::fromDense(const std::vector<std::vector<double>>& matrix) {
+    std::vector<RoutingEntry> entries;
+    for (std::size_t from = 0; from < matrix.size(); from++) {
+        for (std::size_t to = 0; to < matrix[from].size(); to++) {
+            if (matrix[from][to] != 0.0)
+                entries.push_back({ static_cast<int>(from), static_cast<int>(to), matrix[from][to] });
+        }
+    }
+    return RoutingTable(static_cast<int>(matrix.size()), entries);
+}
+
+RoutingTable RoutingTable::fromRows(int rowCount, const std::uint64_t* rowStart, const std::int32_t* destinations,
+    const double* probabilities)
+{
+    RoutingTable table;
+    rowCount = std::max(rowCount, 0);
+    std::size_t entryCount = static_cast<std::size_t>(rowStart[rowCount]);
+    table.rowStart.assign(rowStart, rowStart + rowCount + 1);
+    table.destinations.assign(destinations, destinations + entryCount);
+    table.probabilities.assign(probabilities, probabilities + entryCount);
+    table.aliasStart.assign(static_cast<std::size_t>(rowCount) + 1, 0);
+    table.aliasSlots.reserve(entryCount + rowCount);
+    for (int row = 0; row < rowCount; row++)
+        table.buildAlias(row);
+    return table;
+}
+
+std::vector<RoutingEntry> RoutingTable::getEntries() const {
+    std::vector<RoutingEntry> entries;
+    entries.reserve(destinations.size());
+    for (int row = 0; row < getRowCount(); row++) {
+        for (std::size_t k = rowStart[row]; k < rowStart[row + 1]; k++)
+            entries.push_back({ row, destinations[k], probabilities[k] });
+    }
+    return entries;
+}
+
+void RoutingTable::buildAlias(int row) {
+    // Outcomes of the row: its destinations with positive probability, then the exit.
+    std::vector<int> outcomes;
+    std::vector<double> weights;
+    double sum = 0.0;
+    for (std::size_t k = rowStart[row]; k < rowStart[row + 1]; k++) {
+        if (probabilities[k] > 0.0) {
+            outcomes.push_back(destinations[k]);
+            weights.push_back(probabilities[k]);
+            sum += probabilities[k];
+        }
+    }
+    if (sum < 1.0) {
+        outcomes.push_back(exitNetwork);
+        weights.push_back(1.0 - sum);
+        sum = 1.0;
+    }
+
+    // Vose's method: scale the weights to average one, then pair each slot
+    // below one with a slot above one that tops it up.
+    std::size_t n = outcomes.size();
+    std::size_t first = aliasSlots.size();
+    aliasSlots.resize(first + n);
+    std::vector<std::size_t> small, large;
+    for (std::size_t j = 0; j < n; j++) {
+        weights[j] *= n / sum;
+        (weights[j] < 1.0 ? small : large).push_back(j);
+    }
+    while (!small.empty() && !large.empty()) {
+        std::size_t s = small.back(), l = large.back();
+        small.pop_back();
+        aliasSlots[first + s] = AliasSlot{ weights[s], outcomes[s], outcomes[l] };
+        weights[l] -= 1.0 - weights[s];
+        if (weights[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Whatever is left is one up to rounding.
+    for (std::size_t j : large)
+        aliasSlots[first + j] = AliasSlot{ 1.0, outcomes[j], outcomes[j] };
+    for (std::size_t j : small)
+        aliasSlots[first + j] = AliasSlot{ 1.0, outcomes[j], outcomes[j] };
+    aliasStart[row + 1] = static_cast<std::uint32_t>(aliasSlots.size());
+}
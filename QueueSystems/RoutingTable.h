@@ -0,0 +1,101 @@
+#ifndef ROUTING_TABLE_H
+#define ROUTING_TABLE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// One nonzero routing probability: a customer leaving from goes to to.
+struct RoutingEntry {
+    int from;
+    int to;
+    double probability;
+};
+
+//----------------------------------------------------------------
+// RoutingTable: sparse routing probabilities with O(1) sampling
+//----------------------------------------------------------------
+// Holds the routing matrix in compressed sparse row form: the nonzero
+// probabilities of each row, sorted by destination. Every row also has a
+// Walker alias table over its destinations and the exit (one minus the row
+// sum, when positive), so choosing where a customer goes takes one uniform
+// and one alias slot whatever the number of successors. Memory is
+// proportional to the number of nonzero entries, not to the square of the
+// number of nodes.
+//
+// A row whose probabilities sum to more than one is scaled to sum to one.
+// Negative probabilities are kept in the sparse rows but never sampled.
+class RoutingTable {
+public:
+    // Returned by sample() for a customer that leaves the network.
+    static constexpr int exitNetwork = -1;
+
+    RoutingTable() = default;
+
+    // Rows 0 .. rowCount - 1. Entries of other rows, and zero entries, are
+    // dropped; duplicate entries are added up.
+    RoutingTable(int rowCount, const std::vector<RoutingEntry>& entries);
+
+    // For a network of nodeCount nodes: one row per node, plus rows for any
+    // entries from further sources (so none is dropped).
+    static RoutingTable fromEntries(int nodeCount, const std::vector<RoutingEntry>& entries);
+
+    // From a dense matrix: matrix[i][j] is the probability of going from i to j.
+    static RoutingTable fromDense(const std::vector<std::vector<double>>& matrix);
+
+    // From rows already in sparse row form: the entries of row r are
+    // rowStart[r] .. rowStart[r + 1] - 1, with strictly increasing
+    // destinations (as in a NetworkDescription). Skips the sort.
+    static RoutingTable fromRows(int rowCount, const std::uint64_t* rowStart, const std::int32_t* destinations,
+        const double* probabilities);
+
+    int getRowCount() const { return static_cast<int>(rowStart.size()) - 1; }
+    std::size_t getEntryCount() const { return destinations.size(); }
+
+    // The nonzero entries of row are the indexes rowBegin(row) .. rowEnd(row) - 1.
+    std::size_t rowBegin(int row) const { return rowStart[row]; }
+    std::size_t rowEnd(int row) const { return rowStart[row + 1]; }
+    int getDestination(std::size_t entry) const { return destinations[entry]; }
+    double getProbability(std::size_t entry) const { return probabilities[entry]; }
+
+    // Every nonzero entry, row by row.
+    std::vector<RoutingEntry> getEntries() const;
+
+    // Bytes held by the table's arrays.
+    std::size_t getMemoryUsage() const {
+        return rowStart.size() * sizeof(std::size_t) + destinations.size() * sizeof(int)
+            + probabilities.size() * sizeof(double) + aliasStart.size() * sizeof(std::uint32_t)
+            + aliasSlots.size() * sizeof(AliasSlot);
+    }
+
+    // Destination of a customer leaving row, or exitNetwork, for a uniform u
+    // in [0, 1). The integer part of u times the row's outcome count picks
+    // an alias slot, the fraction picks one of its two outcomes.
+    int sample(int row, double u) const {
+        std::uint32_t begin = aliasStart[row];
+        std::uint32_t count = aliasStart[row + 1] - begin;
+        double scaled = u * count;
+        std::uint32_t k = static_cast<std::uint32_t>(scaled);
+        if (k >= count)
+            k = count - 1;
+        const AliasSlot& slot = aliasSlots[begin + k];
+        return scaled - k < slot.threshold ? slot.primary : slot.alternative;
+    }
+
+private:
+    struct AliasSlot {
+        double threshold;  // Probability of primary within the slot.
+        int primary;
+        int alternative;
+    };
+
+    std::vector<std::size_t> rowStart{ 0 };  // Sparse rows; rowCount + 1 offsets.
+    std::vector<int> destinations;
+    std::vector<double> probabilities;
+    std::vector<std::uint32_t> aliasStart{ 0 };  // Alias slots of each row; rowCount + 1 offsets.
+    std::vector<AliasSlot> aliasSlots;
+
+    void buildAlias(int row);
+};
+
+#endif // ROUTING_TABLE_H
@@ -0,0 +1,83 @@
+#include "Simulation.h"
+#include "SimulationProfiler.h"
+#include "QueueEventDispatch.h"
+
+template <typename EventSet>
+void Simulation::runLoop(EventSet& events, double endTime) {
+#ifdef QS_PROFILE
+    if (profiler != nullptr) {
+        profiledRunLoop(events, endTime);
+        return;
+    }
+#endif
+    running = true;
+    while (!events.empty() && running) {
+        ScheduledEvent next = events.top();
+        if (eventPool.getSequence(next.handle) != next.sequence) {
+            events.pop();  // Entry left behind by a cancelled or rescheduled event.
+            continue;
+        }
+        if (next.eventTime > endTime)
+            break;  // Stop if the next event is beyond the simulation end time.
+        events.pop();
+        pendingEvents--;
+        currentTime = next.eventTime;    // Advance simulation time.
+        // The event is no longer pending while it is being processed.
+        eventPool.setSequence(next.handle, EventPool::noSequence);
+        // Process the event.
+        if (eventPool.holdsStatic(next.handle))
+            dispatchQueueEvent(*this, eventPool.getStatic(next.handle));
+        else
+            eventPool.get(next.handle)->process(*this);
+        eventPool.destroy(next.handle);
+        eventsProcessed++;
+    }
+}
+
+#ifdef QS_PROFILE
+template <typename EventSet>
+void Simulation::profiledRunLoop(EventSet& events, double endTime) {
+    SimulationProfiler* outerProfiler = activeProfiler;
+    activeProfiler = profiler;
+    profiler->beginRun(currentTime);
+    running = true;
+    while (running) {
+        ProfileScope dequeue(ProfilePhase::EventSet);
+        if (events.empty())
+            break;
+        ScheduledEvent next = events.top();
+        if (eventPool.getSequence(next.handle) != next.sequence) {
+            events.pop();
+            continue;
+        }
+        if (next.eventTime > endTime)
+            break;
+        events.pop();
+        dequeue.finish();
+        pendingEvents--;
+        currentTime = next.eventTime;
+        eventPool.setSequence(next.handle, EventPool::noSequence);
+        profiler->recordQueueSize(pendingEvents);
+        if (eventPool.holdsStatic(next.handle)) {
+            StaticQueueEvent event = eventPool.getStatic(next.handle);
+            ProfileScope handler(ProfilePhase::Handlers);
+            dispatchQueueEvent(*this, event);
+            profiler->recordEvent(event, handler.finish(), currentTime);
+        }
+        else {
+            Event* event = eventPool.get(next.handle);
+            ProfileScope handler(ProfilePhase::Handlers);
+            event->process(*this);
+            profiler->recordEvent(*event, handler.finish(), currentTime);
+        }
+        eventPool.destroy(next.handle);
+        eventsProcessed++;
+        profiler->endEvent(pendingEvents, currentTime);
+    }
+    profiler->endRun(currentTime);
+    activeProfiler = outerProfiler;
+}
+#endif
+
+template void Simulation::runLoop(BinaryHeapEventSet& events, double endTime);
+template void Simulation::runLoop(LadderEventSet& events, double endTime);
@@ -1,13 +1,24 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
-#include <queue>
+#include "FutureEventSet.h"
+#include "StaticQueueEvent.h"
+#include "RandomStream.h"
+#include "ProfileScope.h"
+#include <random>
+#include <variant>
 #include <vector>
 #include <memory>
 #include <limits>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
 
 // Forward declaration of Simulation is required for the Event class.
 class Simulation;
+class SimulationProfiler;
 
 //----------------------------------------------------------------
 // Event Base Class
@@ -27,13 +38,159 @@ public:
 };
 
 //----------------------------------------------------------------
-// Comparator for the event priority queue (min-heap based on eventTime)
+// Adapter that lets a shared_ptr event live in the event pool.
 //----------------------------------------------------------------
-struct EventComparator {
-    bool operator()(const std::shared_ptr<Event>& e1, const std::shared_ptr<Event>& e2) {
-        // The event with the smaller time has higher priority.
-        return e1->eventTime > e2->eventTime;
+class SharedEventAdapter : public Event {
+public:
+    SharedEventAdapter(const std::shared_ptr<Event>& event)
+        : Event(event->eventTime), event(event) {}
+
+    virtual void process(Simulation& sim) override {
+        event->process(sim);
     }
+
+private:
+    std::shared_ptr<Event> event;
+};
+
+//----------------------------------------------------------------
+// Event Pool
+//----------------------------------------------------------------
+// Events are constructed in place inside fixed-size slots. Slots are
+// allocated in slabs that never move, so an event stays valid while it is
+// being processed even if processing schedules (and allocates) new events.
+// Released slots are threaded onto an intrusive freelist and reused.
+// A slot holds either a virtual Event or, by value, a StaticQueueEvent.
+// Each slot also records the sequence number of the scheduled entry that
+// owns it, which lets handles and queue entries detect that their event has
+// been cancelled, rescheduled or already processed.
+class EventPool {
+public:
+    using Handle = std::uint32_t;
+
+    static constexpr std::size_t slotSize = 32;      // Bytes available for one event.
+    static constexpr std::size_t slotsPerSlab = 4096;
+    static constexpr std::uint64_t noSequence = 0;   // Sequence of a slot that is not scheduled.
+
+    EventPool() : freeHead(noSlot), slotCount(0) {}
+
+    EventPool(const EventPool&) = delete;
+    EventPool& operator=(const EventPool&) = delete;
+
+    // Construct an event of type T in a free slot and return its handle.
+    template <typename T, typename... Args>
+    Handle create(Args&&... args) {
+        static_assert(std::is_base_of<Event, T>::value, "pooled events must derive from Event");
+        static_assert(sizeof(T) <= slotSize, "event type is too large for an event pool slot");
+        static_assert(alignof(T) <= slotAlignment, "event type is over-aligned for an event pool slot");
+        Handle handle = acquire();
+        Slot* slot = slotAt(handle);
+        new (slot->storage) T(std::forward<Args>(args)...);
+        slot->holdsStaticEvent = false;
+        return handle;
+    }
+
+    // Store a static queue event in a free slot and return its handle.
+    Handle createStatic(const StaticQueueEvent& event) {
+        static_assert(sizeof(StaticQueueEvent) <= slotSize, "StaticQueueEvent is too large for an event pool slot");
+        Handle handle = acquire();
+        Slot* slot = slotAt(handle);
+        new (slot->storage) StaticQueueEvent(event);
+        slot->holdsStaticEvent = true;
+        return handle;
+    }
+
+    // True if the slot holds a StaticQueueEvent rather than an Event.
+    bool holdsStatic(Handle handle) { return slotAt(handle)->holdsStaticEvent; }
+
+    // Access the static event stored under a handle.
+    StaticQueueEvent& getStatic(Handle handle) {
+        return *std::launder(reinterpret_cast<StaticQueueEvent*>(slotAt(handle)->storage));
+    }
+
+    // Access the event stored under a handle.
+    Event* get(Handle handle) {
+        return std::launder(reinterpret_cast<Event*>(slotAt(handle)->storage));
+    }
+
+    // Sequence number of the entry that currently owns the slot.
+    std::uint64_t getSequence(Handle handle) { return slotAt(handle)->sequence; }
+    void setSequence(Handle handle, std::uint64_t sequence) { slotAt(handle)->sequence = sequence; }
+
+    // Destroy the event and return its slot to the freelist.
+    void destroy(Handle handle) {
+        Slot* slot = slotAt(handle);
+        if (!slot->holdsStaticEvent)
+            get(handle)->~Event();
+        slot->sequence = noSequence;
+        *reinterpret_cast<Handle*>(slot->storage) = freeHead;
+        freeHead = handle;
+    }
+
+    // Total number of slots ever carved out of the slabs.
+    std::size_t capacity() const { return slotCount; }
+
+private:
+    static constexpr Handle noSlot = std::numeric_limits<Handle>::max();
+
+    static constexpr std::size_t slotAlignment = alignof(double);
+
+    struct Slot {
+        std::uint64_t sequence = noSequence;
+        bool holdsStaticEvent = false;
+        alignas(slotAlignment) unsigned char storage[slotSize];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    Handle freeHead;        // First free slot, or noSlot.
+    std::size_t slotCount;  // Slots handed out from the slabs so far.
+
+    Slot* slotAt(Handle handle) {
+        return &slabs[handle / slotsPerSlab][handle % slotsPerSlab];
+    }
+
+    Handle acquire() {
+        if (freeHead != noSlot) {
+            Handle handle = freeHead;
+            freeHead = *reinterpret_cast<Handle*>(slotAt(handle)->storage);
+            return handle;
+        }
+        if (slotCount == slabs.size() * slotsPerSlab) {
+            slabs.emplace_back(new Slot[slotsPerSlab]);
+        }
+        return static_cast<Handle>(slotCount++);
+    }
+};
+
+//----------------------------------------------------------------
+// Event Handle
+//----------------------------------------------------------------
+// Returned by Simulation::scheduleEvent. A handle refers to one scheduled
+// event; it stops being pending once the event is processed or cancelled.
+// Rescheduling through a handle updates that handle; other copies of it
+// become stale.
+class EventHandle {
+public:
+    EventHandle() : sim(nullptr), handle(0), sequence(EventPool::noSequence) {}
+
+    // True while the event is still waiting to be processed.
+    bool isPending() const;
+
+    // Remove the event from the event queue. Returns false if it is no longer pending.
+    bool cancel();
+
+    // Move the event to a new time. Returns false if it is no longer pending.
+    bool reschedule(double newTime);
+
+private:
+    friend class Simulation;
+
+    EventHandle(Simulation* sim, EventPool::Handle handle, std::uint64_t sequence)
+        : sim(sim), handle(handle), sequence(sequence) {}
+
+    Simulation* sim;
+    EventPool::Handle handle;
+    std::uint64_t sequence;
 };
 
 //----------------------------------------------------------------
@@ -41,49 +198,232 @@ struct EventComparator {
 //----------------------------------------------------------------
 class Simulation {
 private:
+    friend class Checkpoint;  // Saves and restores the clock and the pending events.
+
     double currentTime;  // Current simulation time.
     bool running;        // Flag indicating whether the simulation is running.
+    std::uint64_t eventsProcessed;  // Number of events processed so far.
+    std::uint64_t nextSequence;     // Tie-breaker for events scheduled at the same time.
+    std::size_t pendingEvents;      // Scheduled events that have not been processed or cancelled.
+    DispatchMode dispatchMode;      // How StaticQueueEvents are processed.
+    SimulationProfiler* profiler;   // Instrumentation for run(), or null (see SimulationProfiler).
 
-    // Priority queue to store events in order of their scheduled time.
-    std::priority_queue<
-        std::shared_ptr<Event>,
-        std::vector<std::shared_ptr<Event>>,
-        EventComparator
-    > eventQueue;
+    // Source of the random number streams used by the models.
+    RandomStreamFactory randomStreams;
+
+    // Storage for the pending events.
+    EventPool eventPool;
+
+    // Future-event set storing events in order of their scheduled time.
+    std::variant<BinaryHeapEventSet, LadderEventSet> eventQueue;
 
 public:
-    // Constructor initializes simulation time to zero.
-    Simulation() : currentTime(0.0), running(false) {}
+    // Constructor initializes simulation time to zero and selects the future-event set.
+    Simulation(FutureEventSetKind kind = FutureEventSetKind::BinaryHeap)
+        : currentTime(0.0), running(false), eventsProcessed(0),
+        nextSequence(EventPool::noSequence + 1), pendingEvents(0),
+        dispatchMode(DispatchMode::Virtual), profiler(nullptr),
+        randomStreams((std::uint64_t(std::random_device{}()) << 32) ^ std::random_device{}())
+    {
+        if (kind == FutureEventSetKind::LadderQueue) {
+            eventQueue.emplace<LadderEventSet>();
+        }
+    }
+
+    // Seed the random streams directly instead of from std::random_device,
+    // which is slow enough to matter when many short simulations are built.
+    explicit Simulation(std::uint64_t masterSeed, FutureEventSetKind kind = FutureEventSetKind::BinaryHeap)
+        : currentTime(0.0), running(false), eventsProcessed(0),
+        nextSequence(EventPool::noSequence + 1), pendingEvents(0),
+        dispatchMode(DispatchMode::Virtual), profiler(nullptr),
+        randomStreams(masterSeed)
+    {
+        if (kind == FutureEventSetKind::LadderQueue) {
+            eventQueue.emplace<LadderEventSet>();
+        }
+    }
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Destroy any events that are still pending.
+    ~Simulation() {
+        std::visit([this](auto& events) {
+            while (!events.empty()) {
+                const ScheduledEvent& next = events.top();
+                if (eventPool.getSequence(next.handle) == next.sequence)
+                    eventPool.destroy(next.handle);
+                events.pop();
+            }
+        }, eventQueue);
+    }
 
     // Returns the current simulation time.
     double getCurrentTime() const {
         return currentTime;
     }
 
+    // Returns the number of events processed so far.
+    std::uint64_t getEventsProcessed() const {
+        return eventsProcessed;
+    }
+
+    // Returns the number of events waiting in the event queue.
+    std::size_t getPendingEventCount() const {
+        return pendingEvents;
+    }
+
+    // Time of the earliest pending event, or infinity if there is none.
+    double getNextEventTime() {
+        return std::visit([this](auto& events) {
+            while (!events.empty()) {
+                const ScheduledEvent& next = events.top();
+                if (eventPool.getSequence(next.handle) == next.sequence)
+                    return next.eventTime;
+                events.pop();  // Entry left behind by a cancelled or rescheduled event.
+            }
+            return std::numeric_limits<double>::infinity();
+        }, eventQueue);
+    }
+
+    // Schedule a new event of type T, constructed in place in the event pool.
+    // The first constructor argument of every event is its event time.
+    template <typename T, typename... Args>
+    EventHandle scheduleEvent(Args&&... args) {
+        EventPool::Handle handle = eventPool.create<T>(std::forward<Args>(args)...);
+        return enqueue(eventPool.get(handle)->eventTime, handle);
+    }
+
+    // Schedule an event for one of the built-in queue models.
+    EventHandle scheduleEvent(double time, const StaticQueueEvent& event) {
+        if (dispatchMode == DispatchMode::Virtual)
+            return scheduleVirtualQueueEvent(*this, time, event);
+        return enqueue(time, eventPool.createStatic(event));
+    }
+
+    // Make the run reproducible: models created after this call draw their
+    // streams from the given replication of the master seed. By default the
+    // master seed comes from std::random_device. With antithetic set, the
+    // streams are the antithetic copies of those of the plain replication.
+    void seedRandomStreams(std::uint64_t masterSeed, std::uint64_t replication = 0, bool antithetic = false) {
+        randomStreams = RandomStreamFactory(masterSeed, replication, antithetic);
+    }
+
+    // Hand out a new random number stream that does not overlap any other
+    // stream of this simulation.
+    RandomStream nextRandomStream() {
+        return randomStreams.next();
+    }
+
+    // Select how StaticQueueEvents scheduled from now on are processed.
+    void setDispatchMode(DispatchMode mode) {
+        dispatchMode = mode;
+    }
+
+    // Profile the runs from now on, or stop with nullptr. Has no effect
+    // unless the build defines QS_PROFILE.
+    void setProfiler(SimulationProfiler* newProfiler) {
+        profiler = newProfiler;
+    }
+
+    SimulationProfiler* getProfiler() const {
+        return profiler;
+    }
+
     // Schedule a new event by adding it to the event queue.
-    void scheduleEvent(const std::shared_ptr<Event>& event) {
-        eventQueue.push(event);
+    EventHandle scheduleEvent(const std::shared_ptr<Event>& event) {
+        return scheduleEvent<SharedEventAdapter>(event);
+    }
+
+    // True if the event behind the handle is still waiting to be processed.
+    bool isPending(const EventHandle& event) {
+        return event.sim == this && event.sequence != EventPool::noSequence
+            && eventPool.getSequence(event.handle) == event.sequence;
+    }
+
+    // Remove a pending event. The binary heap removes its entry in O(log n);
+    // the ladder queue leaves the entry in place and skips it when it is dequeued.
+    bool cancelEvent(const EventHandle& event) {
+        if (!isPending(event))
+            return false;
+        std::visit([&event](auto& events) {
+            if constexpr (std::decay_t<decltype(events)>::supportsRemoval)
+                events.remove(event.handle);
+        }, eventQueue);
+        eventPool.destroy(event.handle);
+        pendingEvents--;
+        return true;
+    }
+
+    // Move a pending event to a new time. The event is ordered as if it had
+    // just been scheduled, and the handle is updated to refer to the new entry.
+    bool rescheduleEvent(EventHandle& event, double newTime) {
+        if (!isPending(event))
+            return false;
+        std::uint64_t sequence = nextSequence++;
+        if (!eventPool.holdsStatic(event.handle))
+            eventPool.get(event.handle)->eventTime = newTime;
+        eventPool.setSequence(event.handle, sequence);
+        std::visit([&event, newTime, sequence](auto& events) {
+            if constexpr (std::decay_t<decltype(events)>::supportsRemoval)
+                events.update(event.handle, newTime, sequence);
+            else
+                events.push(ScheduledEvent{ newTime, sequence, event.handle });
+        }, eventQueue);
+        event.sequence = sequence;
+        return true;
     }
 
     // Run the simulation until no events remain or until the specified end time is reached.
     void run(double endTime = std::numeric_limits<double>::infinity()) {
-        running = true;
-        while (!eventQueue.empty() && running) {
-            auto event = eventQueue.top();
-            if (event->eventTime > endTime)
-                break;  // Stop if the next event is beyond the simulation end time.
-            eventQueue.pop();
-            currentTime = event->eventTime;  // Advance simulation time.
-            event->process(*this);           // Process the event.
-        }
+        std::visit([this, endTime](auto& events) { runLoop(events, endTime); }, eventQueue);
     }
 
     // Stop the simulation externally.
     void stop() {
         running = false;
     }
+
+private:
+    // Add a pooled event to the future-event set.
+    EventHandle enqueue(double time, EventPool::Handle handle) {
+        return enqueue(time, handle, nextSequence++);
+    }
+
+    // Add a pooled event with a given sequence number (used when restoring a checkpoint).
+    EventHandle enqueue(double time, EventPool::Handle handle, std::uint64_t sequence) {
+        QS_PROFILE_SCOPE(EventSet);
+        eventPool.setSequence(handle, sequence);
+        ScheduledEvent entry{ time, sequence, handle };
+        std::visit([&entry](auto& events) { events.push(entry); }, eventQueue);
+        pendingEvents++;
+        return EventHandle(this, handle, sequence);
+    }
+
+    // Event loop, instantiated once per future-event set type. Defined in
+    // Simulation.cpp, where the built-in models' handlers are visible, so
+    // that static dispatch compiles into the loop.
+    template <typename EventSet>
+    void runLoop(EventSet& events, double endTime);
+
+#ifdef QS_PROFILE
+    // runLoop with every step recorded by the profiler.
+    template <typename EventSet>
+    void profiledRunLoop(EventSet& events, double endTime);
+#endif
 };
 
-#endif // SIMULATION_H
+inline bool EventHandle::isPending() const {
+    return sim != nullptr && sim->isPending(*this);
+}
 
+inline bool EventHandle::cancel() {
+    return sim != nullptr && sim->cancelEvent(*this);
+}
+
+inline bool EventHandle::reschedule(double newTime) {
+    return sim != nullptr && sim->rescheduleEvent(*this, newTime);
+}
+
+#endif // SIMULATION_H
 
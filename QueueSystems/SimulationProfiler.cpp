@@ -0,0 +1,325 @@
+#include "SimulationProfiler.h"
+#include "Simulation.h"
+#include "DD1Queue.h"
+#include "CANQueue.h"
+#include "JacksonNetwork.h"
+#include "CompactJacksonNetwork.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <typeinfo>
+#include <variant>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace {
+    const char* const modelNames[] = {
+        "QueueModel", "MM1Queue", "MMSQueue", "DD1Queue", "CANQueue",
+        "JacksonMM1Queue", "JacksonMMSQueue", "CompactJacksonNetwork"
+    };
+    static_assert(std::size(modelNames) == std::variant_size<QueueModelRef>::value,
+        "modelNames must name every QueueModelRef alternative");
+
+    const char* const eventTypeNames[] = {
+        "ExternalArrival", "InternalArrival", "Departure", "ServiceCompletion", "ForwardAttempt"
+    };
+
+    const char* const phaseNames[] = { "event set", "handlers", "random numbers", "observers" };
+
+    std::string className(const std::type_info& type) {
+#if defined(__GNUG__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if (status == 0 && demangled != nullptr) {
+            std::string name(demangled);
+            std::free(demangled);
+            return name;
+        }
+#endif
+        std::string name = type.name();
+        const std::string prefix = "class ";  // MSVC.
+        return name.compare(0, prefix.size(), prefix) == 0 ? name.substr(prefix.size()) : name;
+    }
+
+    // Id of a model within its network, or -1.
+    int nodeIdOf(const QueueModelRef& queue, int server) {
+        if (auto node = std::get_if<JacksonMM1Queue*>(&queue))
+            return (*node)->nodeId;
+        if (auto node = std::get_if<JacksonMMSQueue*>(&queue))
+            return (*node)->nodeId;
+        if (std::holds_alternative<CompactJacksonNetwork*>(queue))
+            return server;
+        return -1;
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+SimulationProfiler::SimulationProfiler(std::uint64_t sampleInterval)
+    : sampleInterval(std::max<std::uint64_t>(sampleInterval, 1))
+{
+    reset();
+}
+
+void SimulationProfiler::reset() {
+    totalEvents = 0;
+    eventTypes.assign(std::size(modelNames) * queueEventTypes, EventTypeStats{});
+    eventClasses.clear();
+    phaseTicks.fill(0);
+    childTicks = 0;
+    queueSizes.fill(0);
+    queueSizeSum = 0;
+    maxQueueSize = 0;
+    nodes.clear();
+    samples.clear();
+    runs.clear();
+    runBeginTicks = 0;
+    runBeginTime = 0.0;
+    runBeginEvents = 0;
+    firstTicks = 0;
+    anyRun = false;
+    measuredTicks = 0;
+    measuredNanoseconds = 0.0;
+}
+
+std::size_t SimulationProfiler::bucketOf(std::uint64_t value) {
+    return static_cast<std::size_t>(std::bit_width(value));
+}
+
+void SimulationProfiler::beginRun(double simulationTime) {
+    runBeginClock = std::chrono::steady_clock::now();
+    runBeginTicks = profileTicks();
+    if (!anyRun) {
+        firstTicks = runBeginTicks;
+        anyRun = true;
+    }
+    runBeginTime = simulationTime;
+    runBeginEvents = totalEvents;
+}
+
+void SimulationProfiler::endRun(double simulationTime) {
+    std::uint64_t ticks = profileTicks();
+    double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - runBeginClock).count();
+    measuredTicks += ticks - runBeginTicks;
+    measuredNanoseconds += nanoseconds;
+    runs.push_back(RunSpan{ runBeginTicks, ticks, runBeginTime, simulationTime, totalEvents - runBeginEvents });
+}
+
+void SimulationProfiler::recordEvent(const StaticQueueEvent& event, std::uint64_t ticks, double time) {
+    std::size_t model = event.queue.index();
+    std::size_t type = static_cast<std::size_t>(event.type);
+    EventTypeStats& stats = eventTypes[model * queueEventTypes + type];
+    if (stats.count == 0)
+        stats.name = std::string(modelNames[model]) + "." + eventTypeNames[type];
+    stats.count++;
+    stats.ticks += ticks;
+    stats.histogram[bucketOf(ticks)]++;
+
+    const QueueModel* queue = std::visit([](auto* q) -> const QueueModel* { return q; }, event.queue);
+    int node = std::holds_alternative<CompactJacksonNetwork*>(event.queue) ? event.server : -1;
+    NodeStats& nodeStats = nodes[NodeKey{ queue, node }];
+    if (nodeStats.count == 0) {
+        std::ostringstream label;
+        int id = nodeIdOf(event.queue, event.server);
+        label << modelNames[model];
+        if (id >= 0)
+            label << " node " << id;
+        else
+            label << " at " << static_cast<const void*>(queue);
+        nodeStats.label = label.str();
+        nodeStats.firstTime = time;
+    }
+    nodeStats.count++;
+    nodeStats.lastTime = time;
+}
+
+void SimulationProfiler::recordEvent(const Event& event, std::uint64_t ticks, double time) {
+    // Built-in queue events dispatched virtually count as their static form,
+    // so that the per-node table does not depend on the dispatch mode.
+    StaticQueueEvent queueEvent;
+    if (describeQueueEvent(event, queueEvent)) {
+        recordEvent(queueEvent, ticks, time);
+        return;
+    }
+    std::type_index type(typeid(event));
+    auto found = eventClasses.find(type);
+    std::size_t index;
+    if (found != eventClasses.end())
+        index = found->second;
+    else {
+        index = eventTypes.size();
+        eventClasses.emplace(type, index);
+        eventTypes.push_back(EventTypeStats{});
+        eventTypes.back().name = className(typeid(event));
+    }
+    EventTypeStats& stats = eventTypes[index];
+    stats.count++;
+    stats.ticks += ticks;
+    stats.histogram[bucketOf(ticks)]++;
+}
+
+void SimulationProfiler::takeSample(std::size_t pendingEvents, double time) {
+    samples.push_back(Sample{ profileTicks(), time, pendingEvents, totalEvents, phaseTicks });
+}
+
+double SimulationProfiler::ticksToNanoseconds(double ticks) const {
+    // Before any run has ended, assume one tick per nanosecond.
+    return measuredTicks > 0 ? ticks * measuredNanoseconds / static_cast<double>(measuredTicks) : ticks;
+}
+
+double SimulationProfiler::getRunSeconds() const {
+    return measuredNanoseconds * 1.0e-9;
+}
+
+double SimulationProfiler::getPhaseSeconds(ProfilePhase phase) const {
+    return ticksToNanoseconds(static_cast<double>(phaseTicks[static_cast<std::size_t>(phase)])) * 1.0e-9;
+}
+
+void SimulationProfiler::printSummary(std::ostream& out, std::size_t topNodes) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+
+    double runNanoseconds = measuredNanoseconds;
+    out << "Profile: " << totalEvents << " events in " << runNanoseconds * 1.0e-6 << " ms over " << runs.size()
+        << " run(s), " << (totalEvents > 0 ? runNanoseconds / totalEvents : 0.0) << " ns per event\n";
+
+    out << "\n  " << std::left << std::setw(20) << "phase" << std::right << std::setw(12) << "ms" << std::setw(9) << "share"
+        << std::setw(12) << "ns/event" << "\n";
+    double phaseSum = 0.0;
+    auto phaseRow = [&](const char* name, double nanoseconds) {
+        out << "  " << std::left << std::setw(20) << name << std::right << std::setw(12) << nanoseconds * 1.0e-6
+            << std::setw(8) << (runNanoseconds > 0 ? 100.0 * nanoseconds / runNanoseconds : 0.0) << "%"
+            << std::setw(12) << (totalEvents > 0 ? nanoseconds / totalEvents : 0.0) << "\n";
+    };
+    for (std::size_t phase = 0; phase < phaseTicks.size(); phase++) {
+        double nanoseconds = ticksToNanoseconds(static_cast<double>(phaseTicks[phase]));
+        phaseSum += nanoseconds;
+        phaseRow(phaseNames[phase], nanoseconds);
+    }
+    phaseRow("loop and profiling", std::max(runNanoseconds - phaseSum, 0.0));
+
+    // Event types, most frequent first. Times include nested phases.
+    std::vector<const EventTypeStats*> types;
+    for (const EventTypeStats& stats : eventTypes) {
+        if (stats.count > 0)
+            types.push_back(&stats);
+    }
+    std::sort(types.begin(), types.end(), [](const EventTypeStats* a, const EventTypeStats* b) { return a->count > b->count; });
+    out << "\n  " << std::left << std::setw(40) << "event type" << std::right << std::setw(12) << "count" << std::setw(9) << "share"
+        << std::setw(10) << "mean ns" << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns" << "\n";
+    for (const EventTypeStats* stats : types) {
+        // Percentiles at the upper end of their log2 bucket.
+        auto percentile = [this, stats](double q) {
+            std::uint64_t target = static_cast<std::uint64_t>(q * stats->count), seen = 0;
+            for (std::size_t b = 0; b < bucketCount; b++) {
+                seen += stats->histogram[b];
+                if (seen > target)
+                    return ticksToNanoseconds(b == 0 ? 0.0 : std::ldexp(1.0, static_cast<int>(b)) - 1.0);
+            }
+            return 0.0;
+        };
+        out << "  " << std::left << std::setw(40) << stats->name << std::right << std::setw(12) << stats->count
+            << std::setw(8) << 100.0 * stats->count / totalEvents << "%"
+            << std::setw(10) << ticksToNanoseconds(static_cast<double>(stats->ticks)) / stats->count
+            << std::setw(10) << percentile(0.5) << std::setw(10) << percentile(0.99) << "\n";
+    }
+
+    out << "\n  pending events: mean " << (totalEvents > 0 ? double(queueSizeSum) / totalEvents : 0.0)
+        << ", max " << maxQueueSize << "\n";
+    for (std::size_t b = 0; b < bucketCount; b++) {
+        if (queueSizes[b] == 0)
+            continue;
+        std::uint64_t low = b == 0 ? 0 : std::uint64_t(1) << (b - 1), high = b == 0 ? 0 : (std::uint64_t(1) << b) - 1;
+        out << "    " << std::setw(10) << low << " - " << std::left << std::setw(10) << high << std::right
+            << std::setw(8) << 100.0 * queueSizes[b] / totalEvents << "%\n";
+    }
+
+    std::vector<const NodeStats*> hottest;
+    for (const auto& entry : nodes)
+        hottest.push_back(&entry.second);
+    std::size_t shown = std::min(topNodes, hottest.size());
+    std::partial_sort(hottest.begin(), hottest.begin() + shown, hottest.end(),
+        [](const NodeStats* a, const NodeStats* b) { return a->count > b->count; });
+    out << "\n  " << nodes.size() << " models with events; busiest:\n";
+    out << "  " << std::left << std::setw(40) << "model" << std::right << std::setw(12) << "events" << std::setw(9) << "share"
+        << std::setw(14) << "per time unit" << "\n";
+    for (std::size_t i = 0; i < shown; i++) {
+        const NodeStats* node = hottest[i];
+        double span = node->lastTime - node->firstTime;
+        out << "  " << std::left << std::setw(40) << node->label << std::right << std::setw(12) << node->count
+            << std::setw(8) << 100.0 * node->count / totalEvents << "%"
+            << std::setw(14) << std::setprecision(3) << (span > 0 ? node->count / span : 0.0) << std::setprecision(1) << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool SimulationProfiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+    out.precision(15);
+    auto micros = [this](std::uint64_t ticks) { return ticksToNanoseconds(static_cast<double>(ticks - firstTicks)) * 1.0e-3; };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Simulation\"}}";
+    for (const RunSpan& run : runs) {
+        out << ",\n{\"name\":\"run\",\"cat\":\"simulation\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << micros(run.beginTicks)
+            << ",\"dur\":" << micros(run.endTicks) - micros(run.beginTicks)
+            << ",\"args\":{\"events\":" << run.events << ",\"from time\":" << run.beginTime << ",\"to time\":" << run.endTime << "}}";
+    }
+
+    // Counters per sample interval: queue size, event rate, simulated time
+    // and the share of each phase.
+    const Sample* previous = nullptr;
+    for (const Sample& sample : samples) {
+        double ts = micros(sample.ticks);
+        out << ",\n{\"name\":\"pending events\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+            << ",\"args\":{\"pending\":" << sample.pendingEvents << "}}";
+        out << ",\n{\"name\":\"simulated time\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+            << ",\"args\":{\"time\":" << sample.simulationTime << "}}";
+        if (previous != nullptr && sample.ticks > previous->ticks) {
+            double elapsedTicks = static_cast<double>(sample.ticks - previous->ticks);
+            double seconds = ticksToNanoseconds(elapsedTicks) * 1.0e-9;
+            out << ",\n{\"name\":\"events per second\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts
+                << ",\"args\":{\"events/s\":" << (sample.events - previous->events) / seconds << "}}";
+            out << ",\n{\"name\":\"phase share %\",\"ph\":\"C\",\"pid\":1,\"ts\":" << ts << ",\"args\":{";
+            for (std::size_t phase = 0; phase < sample.phaseTicks.size(); phase++) {
+                double share = 100.0 * (sample.phaseTicks[phase] - previous->phaseTicks[phase]) / elapsedTicks;
+                out << (phase > 0 ? "," : "") << jsonString(phaseNames[phase]) << ":" << share;
+            }
+            out << "}}";
+        }
+        previous = &sample;
+    }
+
+    // The busiest models as instant events with their counts.
+    std::vector<const NodeStats*> hottest;
+    for (const auto& entry : nodes)
+        hottest.push_back(&entry.second);
+    std::size_t shown = std::min<std::size_t>(20, hottest.size());
+    std::partial_sort(hottest.begin(), hottest.begin() + shown, hottest.end(),
+        [](const NodeStats* a, const NodeStats* b) { return a->count > b->count; });
+    double end = runs.empty() ? 0.0 : micros(runs.back().endTicks);
+    out << ",\n{\"name\":\"busiest models\",\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":1,\"ts\":" << end << ",\"args\":{";
+    for (std::size_t i = 0; i < shown; i++)
+        out << (i > 0 ? "," : "") << jsonString(hottest[i]->label) << ":" << hottest[i]->count;
+    out << "}}\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,229 @@
+#ifndef SIMULATION_PROFILER_H
+#define SIMULATION_PROFILER_H
+
+#include "StaticQueueEvent.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class Event;
+class QueueModel;
+
+// Where the time of a profiled run goes. Each phase is measured exclusive
+// of the phases nested in it (a handler that schedules an event spends that
+// time in EventSet, not in Handlers).
+enum class ProfilePhase : std::uint8_t {
+    EventSet,       // Taking events from and adding them to the future-event set.
+    Handlers,       // The models' event handlers.
+    RandomNumbers,  // Refilling blocks of variates.
+    Observers,      // Observer and change listener notification.
+    Count
+};
+
+// Timestamp counter: rdtsc on x86, steady_clock nanoseconds elsewhere.
+// SimulationProfiler converts ticks to time with a rate measured per run.
+inline std::uint64_t profileTicks() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+//----------------------------------------------------------------
+// SimulationProfiler: hot-path counters for Simulation::run
+//----------------------------------------------------------------
+// Instrumentation is compiled in only when QS_PROFILE is defined (e.g.
+// -DQS_PROFILE); otherwise Simulation::setProfiler has no effect and the
+// event loop and handlers are unchanged. With it compiled in, a simulation
+// with a profiler attached runs a separate instrumented event loop that
+// records:
+// - the count and a log2 histogram of the handling time of each event type
+//   (model type and QueueEventType for built-in events, the Event class
+//   otherwise),
+// - the exclusive time of each ProfilePhase,
+// - a log2 histogram of the number of pending events, sampled per event,
+// - the events of each model (each node of a CompactJacksonNetwork),
+//   counted for built-in events only,
+// - every sampleInterval events, a timeline sample for the trace.
+//
+// printSummary writes a table, writeChromeTrace a JSON trace for
+// chrome://tracing or ui.perfetto.dev with each run as a span and the
+// timeline samples as counters. One profiler may be attached to one
+// simulation at a time; it accumulates over runs until reset().
+class SimulationProfiler {
+public:
+    static constexpr bool compiledIn =
+#ifdef QS_PROFILE
+        true;
+#else
+        false;
+#endif
+
+    explicit SimulationProfiler(std::uint64_t sampleInterval = 16384);
+
+    void reset();
+
+    std::uint64_t getEventCount() const { return totalEvents; }
+    // Seconds of wall-clock time spent in profiled runs.
+    double getRunSeconds() const;
+    // Seconds spent exclusively in a phase.
+    double getPhaseSeconds(ProfilePhase phase) const;
+
+    void printSummary(std::ostream& out, std::size_t topNodes = 10) const;
+    bool writeChromeTrace(const std::string& path) const;
+
+    // Called by the instrumented event loop.
+    void beginRun(double simulationTime);
+    void endRun(double simulationTime);
+    void recordEvent(const StaticQueueEvent& event, std::uint64_t ticks, double time);
+    void recordEvent(const Event& event, std::uint64_t ticks, double time);
+    void recordQueueSize(std::size_t pendingEvents) {
+        queueSizes[bucketOf(pendingEvents)]++;
+        queueSizeSum += pendingEvents;
+        if (pendingEvents > maxQueueSize)
+            maxQueueSize = pendingEvents;
+    }
+    void endEvent(std::size_t pendingEvents, double time) {
+        if (++totalEvents % sampleInterval == 0)
+            takeSample(pendingEvents, time);
+    }
+
+    // Phase bookkeeping for ProfileScope.
+    std::uint64_t enterPhase() {
+        std::uint64_t saved = childTicks;
+        childTicks = 0;
+        return saved;
+    }
+    void leavePhase(ProfilePhase phase, std::uint64_t elapsed, std::uint64_t savedChildTicks) {
+        phaseTicks[static_cast<std::size_t>(phase)] += elapsed - childTicks;
+        childTicks = savedChildTicks + elapsed;
+    }
+
+private:
+    static constexpr std::size_t bucketCount = 65;
+    using Histogram = std::array<std::uint64_t, bucketCount>;
+
+    // Bucket b holds values with bit width b: 0, 1, 2-3, 4-7, ...
+    static std::size_t bucketOf(std::uint64_t value);
+
+    struct EventTypeStats {
+        std::string name;
+        std::uint64_t count = 0;
+        std::uint64_t ticks = 0;
+        Histogram histogram{};
+    };
+
+    struct NodeKey {
+        const QueueModel* model;
+        int node;
+        bool operator==(const NodeKey& other) const { return model == other.model && node == other.node; }
+    };
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey& key) const {
+            return std::hash<const void*>()(key.model) ^ (std::hash<int>()(key.node) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+    struct NodeStats {
+        std::string label;
+        std::uint64_t count = 0;
+        double firstTime = 0.0;
+        double lastTime = 0.0;
+    };
+
+    struct Sample {
+        std::uint64_t ticks;
+        double simulationTime;
+        std::size_t pendingEvents;
+        std::uint64_t events;
+        std::array<std::uint64_t, static_cast<std::size_t>(ProfilePhase::Count)> phaseTicks;
+    };
+
+    struct RunSpan {
+        std::uint64_t beginTicks, endTicks;
+        double beginTime, endTime;
+        std::uint64_t events;
+    };
+
+    std::uint64_t sampleInterval;
+    std::uint64_t totalEvents;
+
+    // Built-in events by model type and QueueEventType; Event classes after them.
+    static constexpr std::size_t queueEventTypes = 8;
+    std::vector<EventTypeStats> eventTypes;
+    std::unordered_map<std::type_index, std::size_t> eventClasses;
+
+    std::array<std::uint64_t, static_cast<std::size_t>(ProfilePhase::Count)> phaseTicks;
+    std::uint64_t childTicks;
+
+    Histogram queueSizes;
+    std::uint64_t queueSizeSum;
+    std::size_t maxQueueSize;
+
+    std::unordered_map<NodeKey, NodeStats, NodeKeyHash> nodes;
+
+    std::vector<Sample> samples;
+    std::vector<RunSpan> runs;
+    std::uint64_t runBeginTicks;
+    std::chrono::steady_clock::time_point runBeginClock;
+    double runBeginTime;
+    std::uint64_t runBeginEvents;
+    std::uint64_t firstTicks;
+    bool anyRun;
+    // Ticks and nanoseconds over all runs, for converting ticks to time.
+    std::uint64_t measuredTicks;
+    double measuredNanoseconds;
+
+    double ticksToNanoseconds(double ticks) const;
+    void takeSample(std::size_t pendingEvents, double time);
+};
+
+// The profiler of the simulation running on this thread, if it has one.
+inline thread_local SimulationProfiler* activeProfiler = nullptr;
+
+// Times the enclosing block as a phase of the active profiler, if any.
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase) : profiler(activeProfiler), phase(phase) {
+        if (profiler != nullptr) {
+            savedChildTicks = profiler->enterPhase();
+            start = profileTicks();
+        }
+    }
+    ~ProfileScope() { finish(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    // End the phase before the end of the block. Returns its inclusive ticks.
+    std::uint64_t finish() {
+        if (profiler == nullptr)
+            return elapsed;
+        elapsed = profileTicks() - start;
+        profiler->leavePhase(phase, elapsed, savedChildTicks);
+        profiler = nullptr;
+        return elapsed;
+    }
+
+private:
+    SimulationProfiler* profiler;
+    ProfilePhase phase;
+    std::uint64_t start = 0;
+    std::uint64_t savedChildTicks = 0;
+    std::uint64_t elapsed = 0;
+};
+
+#endif // SIMULATION_PROFILER_H
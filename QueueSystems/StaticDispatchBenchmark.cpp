@@ -0,0 +1,83 @@
+#include "Simulation.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include "DD1Queue.h"
+#include "JacksonNetwork.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
+// Builds a model on a simulation and returns an owner that keeps it alive.
+using ModelBuilder = std::function<std::shared_ptr<void>(Simulation&)>;
+
+// Build a model on a fresh simulation, run it to endTime and return events/sec.
+double eventsPerSecond(DispatchMode mode, double endTime, const ModelBuilder& build) {
+    Simulation sim;
+    sim.setDispatchMode(mode);
+    std::shared_ptr<void> model = build(sim);
+
+    auto begin = std::chrono::steady_clock::now();
+    sim.run(endTime);
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    return static_cast<double>(sim.getEventsProcessed()) / seconds;
+}
+
+// Best of several interleaved runs of each mode, so that a slow spell of
+// the machine does not decide the comparison.
+void compare(const char* label, double endTime, const ModelBuilder& build) {
+    const int trials = 5;
+    double virtualRate = 0.0, staticRate = 0.0;
+    for (int trial = 0; trial < trials; trial++) {
+        virtualRate = std::max(virtualRate, eventsPerSecond(DispatchMode::Virtual, endTime, build));
+        staticRate = std::max(staticRate, eventsPerSecond(DispatchMode::Static, endTime, build));
+    }
+    std::cout << std::setw(22) << std::left << label << std::right
+              << std::setw(16) << std::fixed << std::setprecision(0) << virtualRate
+              << std::setw(16) << staticRate
+              << std::setw(10) << std::setprecision(2) << staticRate / virtualRate << "x\n";
+}
+
+int main() {
+    std::cout << "Event dispatch benchmark (events/sec)\n\n";
+    std::cout << std::setw(22) << std::left << "scenario" << std::right
+              << std::setw(16) << "virtual" << std::setw(16) << "static" << std::setw(11) << "speedup" << "\n";
+
+    compare("M/M/1", 1.0e6, [](Simulation& sim) {
+        auto queue = std::make_shared<MM1Queue>(sim, 5.0, 10.0);
+        queue->start();
+        return queue;
+    });
+
+    compare("M/M/4", 5.0e5, [](Simulation& sim) {
+        auto queue = std::make_shared<MMSQueue>(sim, 30.0, 10.0, 4);
+        queue->start();
+        return queue;
+    });
+
+    compare("D/D/1", 1.0e6, [](Simulation& sim) {
+        auto queue = std::make_shared<DD1Queue>(sim, 0.2, 0.1);
+        queue->start();
+        return queue;
+    });
+
+    compare("Jackson (3 nodes)", 2.0e5, [](Simulation& sim) {
+        auto network = std::make_shared<JacksonNetwork>(sim);
+        network->addMM1Queue(4, 8);
+        network->addMMSQueue(1, 10, 2);
+        network->addMM1Queue(0, 6);
+        network->setRoutingMatrix({
+            { 0.0, 0.2, 0.1 },
+            { 0.2, 0.0, 0.3 },
+            { 0.1, 0.2, 0.0 }
+        });
+        network->start();
+        return network;
+    });
+
+    return 0;
+}
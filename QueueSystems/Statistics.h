@@ -0,0 +1,313 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <optional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Quantile of the standard normal distribution (Acklam's rational
+// approximation, relative error below 1.2e-9).
+inline double normalQuantile(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    const double low = 0.02425;
+
+    if (p <= 0.0)
+        return -std::numeric_limits<double>::infinity();
+    if (p >= 1.0)
+        return std::numeric_limits<double>::infinity();
+    if (p < low) {
+        double q = std::sqrt(-2.0 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+            / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - low) {
+        double q = std::sqrt(-2.0 * std::log(1.0 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+            / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+        / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// Upper quantile of Student's t distribution: returns t with
+// P(T <= t) = p for p > 0.5 and the given degrees of freedom
+// (Hill, 1970, Algorithm 396).
+inline double studentTQuantile(double p, double degreesOfFreedom) {
+    const double pi = 3.14159265358979323846;
+    double n = degreesOfFreedom;
+    if (!(n >= 1.0))
+        return std::numeric_limits<double>::quiet_NaN();
+    double twoSided = 2.0 * (1.0 - p);  // P(|T| > t)
+
+    if (n == 1.0)
+        return std::tan(pi * (p - 0.5));
+    if (n == 2.0)
+        return std::sqrt(2.0 / (twoSided * (2.0 - twoSided)) - 2.0);
+
+    double a = 1.0 / (n - 0.5);
+    double b = 48.0 / (a * a);
+    double c = ((20700.0 * a / b - 98.0) * a - 16.0) * a + 96.36;
+    double d = ((94.5 / (b + c) - 3.0) / b + 1.0) * std::sqrt(a * pi / 2.0) * n;
+    double y = std::pow(d * twoSided, 2.0 / n);
+
+    if (y > 0.05 + a) {
+        // Asymptotic inverse expansion about the normal distribution.
+        double x = normalQuantile(0.5 * twoSided);
+        y = x * x;
+        if (n < 5.0)
+            c += 0.3 * (n - 4.5) * (x + 0.6);
+        c = (((0.05 * d * x - 5.0) * x - 7.0) * x - 2.0) * x + b + c;
+        y = (((((0.4 * y + 6.3) * y + 36.0) * y + 94.5) / c - y - 3.0) / b + 1.0) * x;
+        y = std::expm1(a * y * y);
+    }
+    else {
+        y = ((1.0 / (((n + 6.0) / (n * y) - 0.089 * d - 0.822) * (n + 2.0) * 3.0)
+            + 0.5 / (n + 4.0)) * y - 1.0) * (n + 1.0) / (n + 2.0) + 1.0 / y;
+    }
+    return std::sqrt(n * y);
+}
+
+// A point estimate with a symmetric confidence interval.
+struct ConfidenceInterval {
+    double mean;
+    double halfWidth;
+
+    double lower() const { return mean - halfWidth; }
+    double upper() const { return mean + halfWidth; }
+    // Half-width relative to the magnitude of the mean.
+    double relativeHalfWidth() const {
+        return (mean != 0.0) ? halfWidth / std::fabs(mean) : std::numeric_limits<double>::infinity();
+    }
+};
+
+// Running mean, variance, minimum and maximum (Welford's method).
+class SummaryStatistics {
+public:
+    SummaryStatistics()
+        : count(0), mean(0.0), sumSquares(0.0),
+        minimum(std::numeric_limits<double>::infinity()),
+        maximum(-std::numeric_limits<double>::infinity()) {}
+
+    void add(double value) {
+        count++;
+        double delta = value - mean;
+        mean += delta / static_cast<double>(count);
+        sumSquares += delta * (value - mean);
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+    }
+
+    std::uint64_t getCount() const { return count; }
+    double getMean() const { return mean; }
+    double getMin() const { return minimum; }
+    double getMax() const { return maximum; }
+
+    // Sample variance (n - 1 denominator).
+    double getVariance() const {
+        return (count > 1) ? sumSquares / static_cast<double>(count - 1) : 0.0;
+    }
+
+    // t-based confidence interval for the mean of independent observations.
+    ConfidenceInterval getConfidenceInterval(double confidence = 0.95) const {
+        if (count < 2)
+            return ConfidenceInterval{ mean, std::numeric_limits<double>::infinity() };
+        double t = studentTQuantile(0.5 + confidence / 2.0, static_cast<double>(count - 1));
+        return ConfidenceInterval{ mean, t * std::sqrt(getVariance() / static_cast<double>(count)) };
+    }
+
+private:
+    std::uint64_t count;
+    double mean;
+    double sumSquares;  // Sum of squared deviations from the mean.
+    double minimum;
+    double maximum;
+};
+
+// Non-overlapping batch means in constant memory. Observations are grouped
+// into batches; when maxBatches batches are complete, adjacent pairs are
+// merged and the batch size doubles. The batch size therefore keeps growing
+// with the run length, which makes the batch means increasingly independent.
+class BatchMeans {
+public:
+    // maxBatches must be even; the estimate uses between maxBatches/2 and maxBatches batches.
+    explicit BatchMeans(std::size_t maxBatches = 40)
+        : maxBatches(std::max<std::size_t>(4, maxBatches & ~std::size_t(1))),
+        batchSize(1), partialSum(0.0), partialCount(0), count(0), sum(0.0)
+    {
+        batches.reserve(this->maxBatches);
+    }
+
+    void add(double value) {
+        count++;
+        sum += value;
+        partialSum += value;
+        if (++partialCount < batchSize)
+            return;
+        batches.push_back(partialSum / static_cast<double>(batchSize));
+        partialSum = 0.0;
+        partialCount = 0;
+        if (batches.size() == maxBatches) {
+            for (std::size_t i = 0; i < maxBatches / 2; i++)
+                batches[i] = 0.5 * (batches[2 * i] + batches[2 * i + 1]);
+            batches.resize(maxBatches / 2);
+            batchSize *= 2;
+        }
+    }
+
+    std::uint64_t getCount() const { return count; }
+    double getMean() const { return (count > 0) ? sum / static_cast<double>(count) : 0.0; }
+    std::size_t getBatchCount() const { return batches.size(); }
+    std::uint64_t getBatchSize() const { return batchSize; }
+    const std::vector<double>& getBatches() const { return batches; }
+
+    // t-based confidence interval over the complete batches.
+    ConfidenceInterval getConfidenceInterval(double confidence = 0.95) const {
+        SummaryStatistics statistics;
+        for (double batch : batches)
+            statistics.add(batch);
+        return statistics.getConfidenceInterval(confidence);
+    }
+
+private:
+    std::size_t maxBatches;
+    std::uint64_t batchSize;     // Observations per batch.
+    double partialSum;           // Sum of the batch being filled.
+    std::uint64_t partialCount;  // Observations in the batch being filled.
+    std::uint64_t count;
+    double sum;
+    std::vector<double> batches;
+};
+
+// Overlapping batch means (Meketon and Schmeiser, 1984) in constant memory.
+// Observations are kept as at most maxMicroBatches micro-batch means, with
+// the same pairwise merging and size doubling as BatchMeans. The variance is
+// estimated from every window of windowLength consecutive micro-batches,
+// where the window is a fixed fraction (1/windowDivisor) of the micro-batch
+// count. This uses about 1.5 times the degrees of freedom of
+// non-overlapping batches of the same size.
+class OverlappingBatchMeans {
+public:
+    explicit OverlappingBatchMeans(std::size_t maxMicroBatches = 128, std::size_t windowDivisor = 8)
+        : microBatches(std::max<std::size_t>(16, maxMicroBatches & ~std::size_t(1))),
+        windowDivisor(std::max<std::size_t>(2, windowDivisor))
+    {}
+
+    void add(double value) { microBatches.add(value); }
+
+    std::uint64_t getCount() const { return microBatches.getCount(); }
+    double getMean() const { return microBatches.getMean(); }
+
+    // Observations per overlapping batch.
+    std::uint64_t getBatchSize() const {
+        return microBatches.getBatchSize() * windowLength();
+    }
+
+    ConfidenceInterval getConfidenceInterval(double confidence = 0.95) const {
+        const std::vector<double>& micro = microBatches.getBatches();
+        std::size_t k = micro.size();
+        std::size_t w = windowLength();
+        if (k < 2 * w || k < 4)
+            return ConfidenceInterval{ getMean(), std::numeric_limits<double>::infinity() };
+
+        double mean = 0.0;
+        for (double x : micro)
+            mean += x;
+        mean /= static_cast<double>(k);
+
+        // Slide a window of w micro-batches over the series.
+        double windowSum = 0.0;
+        for (std::size_t i = 0; i < w; i++)
+            windowSum += micro[i];
+        double squares = 0.0;
+        for (std::size_t j = 0;; j++) {
+            double deviation = windowSum / static_cast<double>(w) - mean;
+            squares += deviation * deviation;
+            if (j + w == k)
+                break;
+            windowSum += micro[j + w] - micro[j];
+        }
+
+        double n = static_cast<double>(k), m = static_cast<double>(w);
+        double varianceConstant = n * m * squares / ((n - m + 1.0) * (n - m));
+        double degreesOfFreedom = 1.5 * (n / m - 1.0);
+        double t = studentTQuantile(0.5 + confidence / 2.0, std::max(1.0, degreesOfFreedom));
+        return ConfidenceInterval{ mean, t * std::sqrt(varianceConstant / n) };
+    }
+
+private:
+    BatchMeans microBatches;
+    std::size_t windowDivisor;
+
+    std::size_t windowLength() const {
+        return std::max<std::size_t>(1, microBatches.getBatchCount() / windowDivisor);
+    }
+};
+
+// MSER on series already averaged in groups (see mserTruncation), for
+// callers that keep the group means as the series grows. Returns the
+// number of leading groups to delete.
+inline std::optional<std::size_t> mserGroupTruncation(const std::vector<double>& means,
+    std::size_t minGroups = 10)
+{
+    std::size_t groups = means.size();
+    if (groups < minGroups)
+        return std::nullopt;
+
+    // Walk d from the end so that the suffix sums build up incrementally.
+    double suffixSum = 0.0, suffixSquares = 0.0;
+    double bestValue = std::numeric_limits<double>::infinity();
+    std::size_t best = groups;
+    std::size_t limit = groups / 2;
+    for (std::size_t d = groups; d-- > 0;) {
+        suffixSum += means[d];
+        suffixSquares += means[d] * means[d];
+        if (d > limit)
+            continue;
+        double m = static_cast<double>(groups - d);
+        double value = (suffixSquares - suffixSum * suffixSum / m) / (m * m);
+        if (value <= bestValue) {
+            bestValue = value;
+            best = d;
+        }
+    }
+    if (best >= limit)
+        return std::nullopt;
+    return best;
+}
+
+// MSER warm-up detection (White, 1997). The series is averaged in groups of
+// groupSize (MSER-5 by default) and d groups are deleted, with d chosen to
+// minimize the squared standard error of the remaining mean. Returns the
+// number of leading observations to delete, or nothing while the run is too
+// short to tell: fewer than minGroups groups, or the minimum falls in the
+// second half of the series.
+inline std::optional<std::size_t> mserTruncation(const std::vector<double>& series,
+    std::size_t groupSize = 5, std::size_t minGroups = 10)
+{
+    std::vector<double> means(series.size() / groupSize);
+    for (std::size_t g = 0; g < means.size(); g++) {
+        double total = 0.0;
+        for (std::size_t i = 0; i < groupSize; i++)
+            total += series[g * groupSize + i];
+        means[g] = total / static_cast<double>(groupSize);
+    }
+    std::optional<std::size_t> groups = mserGroupTruncation(means, minGroups);
+    if (!groups)
+        return std::nullopt;
+    return *groups * groupSize;
+}
+
+#endif // STATISTICS_H
@@ -0,0 +1,160 @@
+#include "SteadyStateAnalyzer.h"
+#include "MM1Queue.h"
+#include "MMSQueue.h"
+#include <algorithm>
+
+// Periodic observation of all metrics of an analyzer.
+class SteadyStateEvent : public Event {
+public:
+    SteadyStateAnalyzer* analyzer;
+    double interval;
+    SteadyStateEvent(double time, SteadyStateAnalyzer* analyzer, double interval)
+        : Event(time), analyzer(analyzer), interval(interval) {}
+
+    virtual void process(Simulation& sim) override {
+        analyzer->observe();
+        if (!analyzer->hasConverged())
+            sim.scheduleEvent<SteadyStateEvent>(sim.getCurrentTime() + interval, analyzer, interval);
+    }
+};
+
+SteadyStateAnalyzer::SteadyStateAnalyzer(Simulation& sim, double batchInterval)
+    : sim(sim), batchInterval(batchInterval), relativeHalfWidth(0.05), confidence(0.95),
+    minBatches(20), nextWarmUpCheck(0), startTime(0.0), warmedUp(false), warmUpEnd(0.0), converged(false), stopTime(0.0)
+{
+}
+
+int SteadyStateAnalyzer::addMetric(const std::string& name, AreaFunction area, ResetFunction reset) {
+    Metric metric;
+    metric.name = name;
+    metric.area = std::move(area);
+    metric.reset = std::move(reset);
+    metrics.push_back(std::move(metric));
+    return static_cast<int>(metrics.size()) - 1;
+}
+
+int SteadyStateAnalyzer::addAverageNumberInSystem(MM1Queue& queue, const std::string& name) {
+    return addMetric(name,
+        [&queue](double time) { return queue.getTimeWeightedCustomers(time); },
+        [&queue](double time) { queue.resetStatistics(time); });
+}
+
+int SteadyStateAnalyzer::addAverageNumberInSystem(MMSQueue& queue, const std::string& name) {
+    return addMetric(name,
+        [&queue](double time) { return queue.getTimeWeightedCustomers(time); },
+        [&queue](double time) { queue.resetStatistics(time); });
+}
+
+void SteadyStateAnalyzer::setPrecision(double relativeHalfWidth, double confidence) {
+    this->relativeHalfWidth = relativeHalfWidth;
+    this->confidence = confidence;
+}
+
+void SteadyStateAnalyzer::setMinBatches(std::size_t batches) {
+    minBatches = std::max<std::size_t>(2, batches);
+}
+
+void SteadyStateAnalyzer::start() {
+    startTime = sim.getCurrentTime();
+    nextWarmUpCheck = 0;
+    for (Metric& metric : metrics)
+        metric.lastArea = metric.area(startTime);
+    sim.scheduleEvent<SteadyStateEvent>(startTime + batchInterval, this, batchInterval);
+}
+
+void SteadyStateAnalyzer::observe() {
+    double now = sim.getCurrentTime();
+    for (Metric& metric : metrics) {
+        double area = metric.area(now);
+        double average = (area - metric.lastArea) / batchInterval;
+        metric.lastArea = area;
+        if (warmedUp)
+            metric.batchMeans.add(average);
+        else {
+            metric.warmUpSeries.push_back(average);
+            metric.groupTotal += average;
+            if (metric.warmUpSeries.size() % warmUpGroupSize == 0) {
+                metric.groupMeans.push_back(metric.groupTotal / static_cast<double>(warmUpGroupSize));
+                metric.groupTotal = 0.0;
+            }
+        }
+    }
+
+    if (!warmedUp) {
+        detectWarmUp(now);
+        return;
+    }
+    if (precise()) {
+        converged = true;
+        stopTime = now;
+        sim.stop();
+    }
+}
+
+void SteadyStateAnalyzer::detectWarmUp(double now) {
+    // Rerunning MSER on every batch would be quadratic in the warm-up length.
+    std::size_t groups = metrics.empty() ? 0 : metrics.front().groupMeans.size();
+    if (groups < nextWarmUpCheck)
+        return;
+    nextWarmUpCheck = groups + std::max<std::size_t>(1, groups / 10);
+
+    // Every metric must have passed its transient; truncate at the latest point.
+    std::size_t truncation = 0;
+    for (const Metric& metric : metrics) {
+        std::optional<std::size_t> point = mserGroupTruncation(metric.groupMeans);
+        if (!point)
+            return;
+        truncation = std::max(truncation, *point * warmUpGroupSize);
+    }
+
+    warmedUp = true;
+    warmUpEnd = startTime + static_cast<double>(truncation) * batchInterval;
+    for (Metric& metric : metrics) {
+        for (std::size_t i = truncation; i < metric.warmUpSeries.size(); i++)
+            metric.batchMeans.add(metric.warmUpSeries[i]);
+        std::vector<double>().swap(metric.warmUpSeries);
+        std::vector<double>().swap(metric.groupMeans);
+        if (metric.reset) {
+            metric.reset(now);
+            metric.lastArea = metric.area(now);
+        }
+    }
+}
+
+bool SteadyStateAnalyzer::precise() const {
+    for (const Metric& metric : metrics) {
+        if (metric.batchMeans.getBatchCount() < minBatches)
+            return false;
+        if (metric.batchMeans.getConfidenceInterval(confidence).relativeHalfWidth() > relativeHalfWidth)
+            return false;
+    }
+    return true;
+}
+
+bool SteadyStateAnalyzer::isWarmedUp() const {
+    return warmedUp;
+}
+
+double SteadyStateAnalyzer::getWarmUpEnd() const {
+    return warmUpEnd;
+}
+
+bool SteadyStateAnalyzer::hasConverged() const {
+    return converged;
+}
+
+double SteadyStateAnalyzer::getStopTime() const {
+    return stopTime;
+}
+
+std::size_t SteadyStateAnalyzer::getMetricCount() const {
+    return metrics.size();
+}
+
+const std::string& SteadyStateAnalyzer::getName(int metric) const {
+    return metrics[metric].name;
+}
+
+ConfidenceInterval SteadyStateAnalyzer::getEstimate(int metric) const {
+    return metrics[metric].batchMeans.getConfidenceInterval(confidence);
+}
@@ -0,0 +1,103 @@
+#ifndef STEADY_STATE_ANALYZER_H
+#define STEADY_STATE_ANALYZER_H
+
+#include "Simulation.h"
+#include "Statistics.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+class MM1Queue;
+class MMSQueue;
+
+// SteadyStateAnalyzer watches time-average metrics while the simulation
+// runs, removes the initial transient and stops the run once the estimates
+// are precise enough.
+//
+// Every batchInterval of simulated time it reads each metric's time-weighted
+// accumulator (the area maintained by updateMetrics) and forms the batch
+// average over the interval.
+//  - Warm-up: the batch averages are kept until MSER-5 finds a truncation
+//    point for every metric. The batches before that point are discarded,
+//    and the models' own statistics are reset at the moment of detection.
+//    The group means are kept as the batches arrive, and MSER is rerun each
+//    time their number has grown by a tenth, so detection costs time
+//    linear in the length of the warm-up (and is at most a tenth late).
+//  - Estimation: later batch averages go into constant-memory batch means
+//    (BatchMeans), which supply the confidence intervals.
+//  - Stopping: once every metric's relative half-width is at most the
+//    requested precision, the analyzer calls Simulation::stop().
+// Run the simulation with sim.run(maxTime) as a safety limit.
+class SteadyStateAnalyzer {
+public:
+    // Area under the metric's curve since its last reset, up to the given time.
+    using AreaFunction = std::function<double(double time)>;
+    // Restart the metric's own statistics at the given time.
+    using ResetFunction = std::function<void(double time)>;
+
+    SteadyStateAnalyzer(Simulation& sim, double batchInterval);
+
+    // Watch a time-average metric. Returns its index.
+    int addMetric(const std::string& name, AreaFunction area, ResetFunction reset = nullptr);
+
+    // Watch the average number in system of a queue.
+    int addAverageNumberInSystem(MM1Queue& queue, const std::string& name);
+    int addAverageNumberInSystem(MMSQueue& queue, const std::string& name);
+
+    // Stop when every confidence interval's half-width is at most
+    // relativeHalfWidth times its mean (default 5% at 95% confidence).
+    void setPrecision(double relativeHalfWidth, double confidence = 0.95);
+
+    // Minimum number of batch means before the run may stop (default 20).
+    void setMinBatches(std::size_t batches);
+
+    // Begin observing at the current simulation time.
+    void start();
+
+    bool isWarmedUp() const;
+    // Time at which the retained observations begin (valid once warmed up).
+    double getWarmUpEnd() const;
+    bool hasConverged() const;
+    // Time at which the run was stopped (valid once converged).
+    double getStopTime() const;
+
+    std::size_t getMetricCount() const;
+    const std::string& getName(int metric) const;
+    // Point estimate and confidence interval of a metric after the warm-up.
+    ConfidenceInterval getEstimate(int metric) const;
+
+    // Take one observation of every metric. Called by the analyzer's event.
+    void observe();
+
+private:
+    struct Metric {
+        std::string name;
+        AreaFunction area;
+        ResetFunction reset;
+        double lastArea = 0.0;
+        std::vector<double> warmUpSeries;  // Batch averages kept until warm-up is detected.
+        std::vector<double> groupMeans;    // Their MSER-5 group means,
+        double groupTotal = 0.0;           // and the sum of the group being filled.
+        BatchMeans batchMeans;
+    };
+
+    Simulation& sim;
+    double batchInterval;
+    double relativeHalfWidth;
+    double confidence;
+    std::size_t minBatches;
+    std::vector<Metric> metrics;
+    static constexpr std::size_t warmUpGroupSize = 5;  // MSER-5.
+    std::size_t nextWarmUpCheck;  // Group count at which MSER is next run.
+
+    double startTime;
+    bool warmedUp;
+    double warmUpEnd;
+    bool converged;
+    double stopTime;
+
+    void detectWarmUp(double now);
+    bool precise() const;
+};
+
+#endif // STEADY_STATE_ANALYZER_H
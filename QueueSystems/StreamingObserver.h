@@ -0,0 +1,57 @@
+#ifndef STREAMING_OBSERVER_H
+#define STREAMING_OBSERVER_H
+
+#include "StateObserver.h"
+#include "Statistics.h"
+
+// Observer that summarizes the state it receives in constant memory,
+// instead of logging every update like StateLogger. It keeps the mean,
+// variance, minimum and maximum, and two batch-means estimators for
+// confidence intervals on the mean of a correlated series: non-overlapping
+// and overlapping batch means, both with automatic batch-size doubling.
+// Estimates are available at any time during the run.
+//
+// The batch-means intervals assume equally spaced samples, such as those
+// produced by MeasurementEvent.
+class StreamingStatisticsObserver : public StateObserver {
+public:
+    StreamingStatisticsObserver(std::size_t maxBatches = 40, std::size_t maxMicroBatches = 128)
+        : lastTime(0.0), batchMeans(maxBatches), overlappingBatchMeans(maxMicroBatches) {}
+
+    virtual void update(const StateData& data) override {
+        double value = static_cast<double>(data.state);
+        lastTime = data.time;
+        summary.add(value);
+        batchMeans.add(value);
+        overlappingBatchMeans.add(value);
+    }
+
+    std::uint64_t getCount() const { return summary.getCount(); }
+    double getMean() const { return summary.getMean(); }
+    double getVariance() const { return summary.getVariance(); }
+    double getMin() const { return summary.getMin(); }
+    double getMax() const { return summary.getMax(); }
+    // Time of the most recent update.
+    double getLastTime() const { return lastTime; }
+
+    // Confidence interval for the steady-state mean from non-overlapping batch means.
+    ConfidenceInterval getBatchMeansInterval(double confidence = 0.95) const {
+        return batchMeans.getConfidenceInterval(confidence);
+    }
+
+    // Confidence interval for the steady-state mean from overlapping batch means.
+    ConfidenceInterval getOverlappingBatchMeansInterval(double confidence = 0.95) const {
+        return overlappingBatchMeans.getConfidenceInterval(confidence);
+    }
+
+    const BatchMeans& getBatchMeans() const { return batchMeans; }
+    const OverlappingBatchMeans& getOverlappingBatchMeans() const { return overlappingBatchMeans; }
+
+private:
+    double lastTime;
+    SummaryStatistics summary;
+    BatchMeans batchMeans;
+    OverlappingBatchMeans overlappingBatchMeans;
+};
+
+#endif // STREAMING_OBSERVER_H
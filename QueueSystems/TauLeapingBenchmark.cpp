@@ -0,0 +1,207 @@
+#include "Simulation.h"
+#include "JacksonNetwork.h"
+#include "MarkovJacksonNetwork.h"
+#include "ProductForm.h"
+#include "BenchmarkNetworks.h"
+#include "RandomStream.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Accuracy of tau-leaping against the event-driven simulation
+// (JacksonNetwork under Simulation::run) and the product form, on
+// networks from light to heavy traffic.
+namespace {
+    struct NetworkSpec {
+        std::string name;
+        std::vector<ProductFormNode> nodes;
+        std::vector<RoutingEntry> routing;
+        double warmUp;
+        double endTime;
+    };
+
+    struct RunResult {
+        std::vector<double> averages;  // L of every node.
+        double seconds;
+        std::uint64_t events;
+        std::uint64_t leaps = 0;
+        double leaptFraction = 0.0;
+    };
+
+    RunResult runEventDriven(const NetworkSpec& spec) {
+        Simulation sim(20241024);
+        JacksonNetwork network(sim);
+        for (const ProductFormNode& node : spec.nodes)
+            network.addMMSQueue(node.externalArrivalRate, node.serviceRate, node.servers);
+        network.setRouting(spec.routing);
+        network.start();
+        auto begin = std::chrono::steady_clock::now();
+        sim.run(spec.warmUp);
+        for (int node = 0; node < network.getNodeCount(); node++)
+            static_cast<MMSQueue*>(network.getNode(node))->resetStatistics(spec.warmUp);
+        sim.run(spec.endTime);
+        RunResult result;
+        result.seconds = secondsSince(begin);
+        result.events = sim.getEventsProcessed();
+        for (int node = 0; node < network.getNodeCount(); node++)
+            result.averages.push_back(static_cast<MMSQueue*>(network.getNode(node))->getAverageNumberInSystem());
+        return result;
+    }
+
+    // errorBound 0 is the exact Markov chain simulation.
+    RunResult runMarkov(const NetworkSpec& spec, double errorBound) {
+        MarkovJacksonNetwork network(20241024);
+        for (const ProductFormNode& node : spec.nodes)
+            network.addMMSQueue(node.externalArrivalRate, node.serviceRate, node.servers);
+        network.setRouting(spec.routing);
+        network.setTauLeaping(errorBound);
+        auto begin = std::chrono::steady_clock::now();
+        network.run(spec.warmUp);
+        network.resetStatistics();
+        network.run(spec.endTime);
+        RunResult result;
+        result.seconds = secondsSince(begin);
+        result.events = network.getTransitionCount();
+        result.leaps = network.getLeapCount();
+        result.leaptFraction = network.getTransitionCount() > 0
+            ? double(network.getLeaptTransitionCount()) / network.getTransitionCount() : 0.0;
+        for (int node = 0; node < network.getNodeCount(); node++)
+            result.averages.push_back(network.getAverageNumberInSystem(node));
+        return result;
+    }
+
+    // Mean and worst relative difference of the nodes' L from reference.
+    void compare(const std::vector<double>& values, const std::vector<double>& reference, double& mean, double& worst) {
+        mean = worst = 0.0;
+        for (std::size_t node = 0; node < values.size(); node++) {
+            double error = std::abs(values[node] - reference[node]) / reference[node];
+            mean += error;
+            worst = std::max(worst, error);
+        }
+        mean /= values.size();
+    }
+
+    void printRow(const std::string& label, const RunResult& run, const std::vector<double>& analytic,
+        const std::vector<double>& eventDriven)
+    {
+        double analyticMean, analyticWorst, eventMean, eventWorst;
+        compare(run.averages, analytic, analyticMean, analyticWorst);
+        compare(run.averages, eventDriven, eventMean, eventWorst);
+        std::cout << "  " << std::left << std::setw(14) << label << std::right
+                  << std::setw(8) << run.seconds << std::setw(11) << run.events
+                  << std::setw(10) << 100.0 * analyticMean << std::setw(9) << 100.0 * analyticWorst
+                  << std::setw(10) << 100.0 * eventMean << std::setw(9) << 100.0 * eventWorst;
+        if (run.leaps > 0)
+            std::cout << std::setw(9) << run.leaps << std::setw(8) << 100.0 * run.leaptFraction << "%";
+        std::cout << "\n";
+    }
+
+    // Returns the mean relative error of L against the product form at the
+    // checked error bound.
+    double report(const NetworkSpec& spec, double checkedBound) {
+        NetworkSolution solution = solveProductForm(spec.nodes, spec.routing);
+        std::vector<double> analytic;
+        double meanL = 0.0;
+        for (const NodeSolution& node : solution.nodes) {
+            analytic.push_back(node.averageNumberInSystem);
+            meanL += node.averageNumberInSystem / solution.nodes.size();
+        }
+        std::cout << spec.name << ": " << spec.nodes.size() << " nodes, mean L " << meanL
+                  << ", T = " << spec.endTime << "\n"
+                  << "  engine          wall s     events  err vs analytic %  err vs events %     leaps  leapt\n"
+                  << "                                         mean    worst      mean    worst\n";
+
+        RunResult events = runEventDriven(spec);
+        printRow("event-driven", events, analytic, events.averages);
+        printRow("exact Markov", runMarkov(spec, 0.0), analytic, events.averages);
+        double checkedError = 0.0;
+        for (double bound : { 0.01, 0.03, 0.1 }) {
+            RunResult leaping = runMarkov(spec, bound);
+            std::ostringstream label;
+            label << "tau " << bound;
+            printRow(label.str(), leaping, analytic, events.averages);
+            if (bound == checkedBound) {
+                double worst;
+                compare(leaping.averages, analytic, checkedError, worst);
+            }
+        }
+        std::cout << "\n";
+        return checkedError;
+    }
+
+    NetworkSpec mainNetwork() {
+        NetworkSpec spec{ "Main.cpp network (light traffic)", { { 4, 8, 1 }, { 1, 10, 2 }, { 0, 6, 1 } }, {}, 1000.0, 2.0e5 };
+        spec.routing = RoutingTable::fromDense({ { 0.0, 0.2, 0.1 }, { 0.2, 0.0, 0.3 }, { 0.1, 0.2, 0.0 } }).getEntries();
+        return spec;
+    }
+
+    // Call centres: M/M/s nodes with hundreds of agents each, forwarding a
+    // fraction of their calls at random, each given the servers that load
+    // it to about rho.
+    NetworkSpec callCentres(int nodeCount, double rho) {
+        NetworkSpec spec{ "Call centres, rho " + std::to_string(rho).substr(0, 4), {}, {}, 20.0, 200.0 };
+        RandomStream rng(31);
+        std::vector<double> external;
+        for (int node = 0; node < nodeCount; node++) {
+            external.push_back(150.0 + static_cast<double>(rng() % 601));
+            for (int k = 0; k < 3; k++)
+                spec.routing.push_back({ node, static_cast<int>(rng() % nodeCount), 0.1 });
+        }
+        int iterations;
+        std::vector<double> total = solveTrafficEquations(external, spec.routing, iterations);
+        for (int node = 0; node < nodeCount; node++)
+            spec.nodes.push_back({ external[node], 1.0, static_cast<int>(std::ceil(total[node] / rho)) });
+        return spec;
+    }
+
+    // The sparse random network of the other benchmarks in light traffic,
+    // started empty and measured from the start: most nodes are idle, so
+    // leaps must not let arrivals wait out the leap unserved.
+    NetworkSpec emptyStart(int nodeCount) {
+        NetworkSpec spec{ "Random M/M/1, started empty", {}, randomRouting(nodeCount, 7), 0.0, 200.0 };
+        spec.nodes.assign(nodeCount, ProductFormNode{ 0.05, 1.0, 1 });
+        return spec;
+    }
+
+    double meanOf(const std::vector<double>& values) {
+        double sum = 0.0;
+        for (double value : values)
+            sum += value;
+        return values.empty() ? 0.0 : sum / values.size();
+    }
+
+    // A tandem of M/M/1 queues in heavy traffic: long queues, but each
+    // empties now and then, where leaping has to give way to exact steps.
+    NetworkSpec tandem(int nodeCount, double rho) {
+        NetworkSpec spec{ "M/M/1 tandem, rho " + std::to_string(rho).substr(0, 4), {}, {}, 2000.0, 2.0e5 };
+        for (int node = 0; node < nodeCount; node++) {
+            spec.nodes.push_back({ node == 0 ? rho : 0.0, 1.0, 1 });
+            if (node + 1 < nodeCount)
+                spec.routing.push_back({ node, node + 1, 1.0 });
+        }
+        return spec;
+    }
+}
+
+int main() {
+    std::cout << std::setprecision(3);
+    const double checkedBound = 0.03;
+    bool passed = true;
+    report(mainNetwork(), checkedBound);
+    passed &= report(callCentres(50, 0.95), checkedBound) < 0.02;
+    report(tandem(10, 0.98), checkedBound);
+    NetworkSpec empty = emptyStart(10000);
+    report(empty, checkedBound);
+    double exactL = meanOf(runMarkov(empty, 0.0).averages), leapingL = meanOf(runMarkov(empty, checkedBound).averages);
+    bool emptyPassed = std::abs(leapingL - exactL) < 0.02 * exactL;
+    std::cout << "Error bound " << checkedBound << " on the call centres: "
+              << (passed ? "within 2% of the product form." : "FAILED, over 2% from the product form.") << "\n";
+    std::cout << "Error bound " << checkedBound << " from empty: mean L " << leapingL << " vs " << exactL << " exact, "
+              << (emptyPassed ? "within 2%." : "FAILED, over 2% apart.") << "\n";
+    return passed && emptyPassed ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#include "TimeWarpJacksonNetwork.h"
+#include "BenchmarkNetworks.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+// A 1,000-node network with random routing (randomRouting): every node
+// sends 80% of its departures to five random nodes and the rest leave the
+// network. The routing delay is far too small for the conservative mode.
+void buildNetwork(TimeWarpJacksonNetwork& network, int nodeCount, std::uint64_t seed) {
+    for (int i = 0; i < nodeCount; i++)
+        network.addMM1Queue(0.5, 4.0);
+    network.setRouting(randomRouting(nodeCount, seed));
+    network.setRoutingDelay(1.0e-6);
+    // Keep LPs within 0.05 time units of GVT; unbounded optimism mostly rolls back.
+    network.setOptimismWindow(0.05);
+}
+
+int main(int argc, char* argv[]) {
+    const int nodeCount = 1000;
+    const double endTime = 200.0;
+    const std::uint64_t seed = 20240701;
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1)
+        maxThreads = static_cast<unsigned>(std::max(1, std::atoi(argv[1])));
+
+    std::cout << "Time Warp: " << nodeCount << "-node random-routing network, T = " << endTime
+              << ", routing delay 1e-6, optimism window 0.05\n\n";
+    std::cout << std::setw(8) << "threads" << std::setw(10) << "seconds" << std::setw(14) << "events/sec"
+              << std::setw(9) << "speedup" << std::setw(12) << "rollbacks" << std::setw(12) << "efficiency"
+              << std::setw(8) << "GVTs" << std::setw(14) << "max |dL|" << "\n";
+
+    std::vector<double> reference;
+    double singleThreadSeconds = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        TimeWarpJacksonNetwork network(threads, seed);
+        buildNetwork(network, nodeCount, seed);
+
+        auto begin = std::chrono::steady_clock::now();
+        network.run(endTime);
+        double seconds = secondsSince(begin);
+        if (threads == 1)
+            singleThreadSeconds = seconds;
+
+        // Committed results must not depend on the number of LPs.
+        double maxDifference = 0.0;
+        for (int node = 0; node < nodeCount; node++) {
+            double average = network.getAverageNumberInSystem(node);
+            if (threads == 1)
+                reference.push_back(average);
+            else
+                maxDifference = std::max(maxDifference, std::fabs(average - reference[node]));
+        }
+
+        double committed = static_cast<double>(network.getCommittedEvents());
+        double efficiency = committed / (committed + static_cast<double>(network.getRolledBackEvents()));
+        std::cout << std::setw(8) << threads << std::fixed
+                  << std::setw(10) << std::setprecision(3) << seconds
+                  << std::setw(14) << std::setprecision(0) << committed / seconds
+                  << std::setw(9) << std::setprecision(2) << singleThreadSeconds / seconds
+                  << std::setw(12) << network.getRollbacks()
+                  << std::setw(12) << std::setprecision(3) << efficiency
+                  << std::setw(8) << network.getGvtRounds();
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setw(14) << maxDifference << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,345 @@
+#include "TimeWarpJacksonNetwork.h"
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    // Time of an event scheduled delay after t, strictly later than t so that
+    // an event always sorts after the event that scheduled it.
+    double after(double t, double delay) {
+        double next = t + delay;
+        return (next > t) ? next : std::nextafter(t, std::numeric_limits<double>::infinity());
+    }
+}
+
+TimeWarpJacksonNetwork::TimeWarpJacksonNetwork(unsigned threads, std::uint64_t masterSeed)
+    : threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+    masterSeed(masterSeed), routingDelay(epsilon), gvtInterval(4096),
+    optimismWindow(std::numeric_limits<double>::infinity()),
+    gvtRequested(false), gvt(0.0), gvtRounds(0)
+{
+}
+
+int TimeWarpJacksonNetwork::addMM1Queue(double arrivalRate, double serviceRate) {
+    return addMMSQueue(arrivalRate, serviceRate, 1);
+}
+
+int TimeWarpJacksonNetwork::addMMSQueue(double arrivalRate, double serviceRate, int servers) {
+    Node node;
+    node.arrivalRate = arrivalRate;
+    node.serviceRate = serviceRate;
+    node.servers = std::max(1, servers);
+    node.lp = 0;
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+void TimeWarpJacksonNetwork::setRoutingMatrix(const std::vector<std::vector<double>>& matrix) {
+    routing = RoutingTable::fromDense(matrix);
+}
+
+void TimeWarpJacksonNetwork::setRouting(const std::vector<RoutingEntry>& entries) {
+    routing = RoutingTable::fromEntries(static_cast<int>(nodes.size()), entries);
+}
+
+void TimeWarpJacksonNetwork::setRouting(RoutingTable table) {
+    routing = std::move(table);
+}
+
+void TimeWarpJacksonNetwork::setRoutingDelay(double delay) {
+    routingDelay = delay;
+}
+
+void TimeWarpJacksonNetwork::setGvtInterval(std::uint64_t events) {
+    gvtInterval = std::max<std::uint64_t>(1, events);
+}
+
+void TimeWarpJacksonNetwork::setOptimismWindow(double window) {
+    optimismWindow = window;
+}
+
+double TimeWarpJacksonNetwork::exponential(RandomStream& rng, double rate) {
+    return -std::log(rng.nextUniform()) / rate;
+}
+
+std::uint64_t TimeWarpJacksonNetwork::newEventId(LogicalProcess& lp) {
+    return (static_cast<std::uint64_t>(lp.index) << 48) | lp.nextId++;
+}
+
+void TimeWarpJacksonNetwork::build() {
+    int nodeCount = static_cast<int>(nodes.size());
+    int lpCount = static_cast<int>(std::min<std::size_t>(threads, std::max<std::size_t>(1, nodes.size())));
+
+    lps.clear();
+    for (int index = 0; index < lpCount; index++) {
+        auto lp = std::make_unique<LogicalProcess>();
+        lp->index = index;
+        lps.push_back(std::move(lp));
+    }
+
+    // Each node has its own random stream, so the trajectory does not depend
+    // on how the nodes are split among LPs.
+    RandomStreamFactory streams(masterSeed);
+    for (int i = 0; i < nodeCount; i++) {
+        Node& node = nodes[i];
+        node.lp = static_cast<int>(static_cast<long long>(i) * lpCount / nodeCount);
+        node.state = NodeState();
+        node.state.rng = streams.next();
+
+        if (node.arrivalRate > 0.0) {
+            LogicalProcess& lp = *lps[node.lp];
+            lp.pending.insert(TimeWarpEvent{ exponential(node.state.rng, node.arrivalRate),
+                newEventId(lp), i, EventType::ExternalArrival });
+        }
+    }
+    gvt = 0.0;
+    gvtRounds = 0;
+    gvtRequested.store(false);
+}
+
+void TimeWarpJacksonNetwork::send(LogicalProcess& lp, ProcessedEvent& record, const TimeWarpEvent& event) {
+    record.sent[record.sentCount++] = event;
+    int target = nodes[event.node].lp;
+    if (target == lp.index) {
+        lp.pending.insert(event);
+        return;
+    }
+    LogicalProcess& destination = *lps[target];
+    std::lock_guard<std::mutex> lock(destination.inboxMutex);
+    destination.inbox.push_back(Message{ event, false });
+    destination.hasMail.store(true, std::memory_order_release);
+}
+
+void TimeWarpJacksonNetwork::processNext(LogicalProcess& lp) {
+    TimeWarpEvent event = *lp.pending.begin();
+    lp.pending.erase(lp.pending.begin());
+
+    Node& node = nodes[event.node];
+    NodeState& state = node.state;
+    lp.processed.emplace_back();
+    ProcessedEvent& record = lp.processed.back();
+    record.event = event;
+    record.savedState = state;
+    record.sentCount = 0;
+
+    // Same bookkeeping as updateMetrics in the queue models.
+    state.cumulativeTimeWeightedCustomers += state.numInSystem * (event.time - state.lastEventTime);
+    state.lastEventTime = event.time;
+
+    switch (event.type) {
+    case EventType::ExternalArrival:
+        send(lp, record, TimeWarpEvent{ after(event.time, exponential(state.rng, node.arrivalRate)),
+            newEventId(lp), event.node, EventType::ExternalArrival });
+        [[fallthrough]];
+    case EventType::InternalArrival:
+        state.totalArrivals++;
+        state.numInSystem++;
+        if (state.busyServers < node.servers) {
+            state.busyServers++;
+            send(lp, record, TimeWarpEvent{ after(event.time, exponential(state.rng, node.serviceRate)),
+                newEventId(lp), event.node, EventType::Departure });
+        }
+        break;
+    case EventType::Departure: {
+        state.totalDepartures++;
+        state.numInSystem--;
+        state.busyServers--;
+        if (state.numInSystem > state.busyServers) {
+            state.busyServers++;
+            send(lp, record, TimeWarpEvent{ after(event.time, exponential(state.rng, node.serviceRate)),
+                newEventId(lp), event.node, EventType::Departure });
+        }
+        // Routed with the node's own stream, like its other draws.
+        if (event.node < routing.getRowCount()) {
+            int destination = routing.sample(event.node, state.rng.nextUniform());
+            if (destination >= 0 && destination < static_cast<int>(nodes.size()))
+                send(lp, record, TimeWarpEvent{ after(event.time, routingDelay),
+                    newEventId(lp), destination, EventType::InternalArrival });
+        }
+        break;
+    }
+    }
+    lp.processedEvents++;
+}
+
+void TimeWarpJacksonNetwork::rollback(LogicalProcess& lp, const TimeWarpEvent& straggler) {
+    lp.rollbacks++;
+    EventOrder before;
+    // Undo, latest first, every processed event that does not precede the straggler.
+    while (!lp.processed.empty() && !before(lp.processed.back().event, straggler)) {
+        ProcessedEvent& record = lp.processed.back();
+        nodes[record.event.node].state = record.savedState;
+        for (int i = 0; i < record.sentCount; i++) {
+            const TimeWarpEvent& sent = record.sent[i];
+            int target = nodes[sent.node].lp;
+            if (target == lp.index) {
+                // Later local events were undone first, so this one is pending again.
+                lp.pending.erase(sent);
+                continue;
+            }
+            LogicalProcess& destination = *lps[target];
+            std::lock_guard<std::mutex> lock(destination.inboxMutex);
+            destination.inbox.push_back(Message{ sent, true });
+            destination.hasMail.store(true, std::memory_order_release);
+            lp.antiMessages++;
+        }
+        lp.pending.insert(record.event);
+        lp.processed.pop_back();
+        lp.rolledBackEvents++;
+    }
+}
+
+void TimeWarpJacksonNetwork::receive(LogicalProcess& lp) {
+    if (!lp.hasMail.load(std::memory_order_acquire))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(lp.inboxMutex);
+        lp.received.swap(lp.inbox);
+        lp.hasMail.store(false, std::memory_order_relaxed);
+    }
+
+    EventOrder before;
+    for (const Message& message : lp.received) {
+        // Messages from one LP arrive in the order they were sent, so an
+        // anti-message always finds its customer here, pending or processed.
+        bool inPast = !lp.processed.empty() && !before(lp.processed.back().event, message.event);
+        if (inPast)
+            rollback(lp, message.event);
+        if (message.anti)
+            lp.pending.erase(message.event);
+        else
+            lp.pending.insert(message.event);
+    }
+    lp.received.clear();
+}
+
+bool TimeWarpJacksonNetwork::synchronizeGvt(LogicalProcess& lp, std::barrier<>& sync, double endTime) {
+    // Every LP has stopped processing events.
+    sync.arrive_and_wait();
+
+    // Deliver messages until none are in transit. Receiving can roll an LP
+    // back, and the rollback can send anti-messages, so this may take more
+    // than one round.
+    for (;;) {
+        receive(lp);
+        sync.arrive_and_wait();
+        lp.inboxWasEmpty = !lp.hasMail.load(std::memory_order_acquire);
+        sync.arrive_and_wait();
+        bool quiet = std::all_of(lps.begin(), lps.end(),
+            [](const std::unique_ptr<LogicalProcess>& other) { return other->inboxWasEmpty; });
+        if (quiet)
+            break;
+    }
+
+    // With nothing in transit, GVT is the earliest pending event anywhere.
+    lp.localMinimum = lp.pending.empty() ? std::numeric_limits<double>::infinity() : lp.pending.begin()->time;
+    sync.arrive_and_wait();
+    double newGvt = std::numeric_limits<double>::infinity();
+    for (const auto& other : lps)
+        newGvt = std::min(newGvt, other->localMinimum);
+
+    // Fossil collection: nothing can roll back before GVT.
+    while (!lp.processed.empty() && lp.processed.front().event.time < newGvt) {
+        lp.processed.pop_front();
+        lp.committedEvents++;
+    }
+    if (lp.index == 0) {
+        gvt = newGvt;
+        gvtRounds++;
+        gvtRequested.store(false);
+    }
+    sync.arrive_and_wait();
+    return newGvt > endTime;
+}
+
+void TimeWarpJacksonNetwork::run(double endTime) {
+    build();
+    std::barrier<> sync(static_cast<std::ptrdiff_t>(lps.size()));
+
+    auto worker = [&](int index) {
+        LogicalProcess& lp = *lps[index];
+        std::uint64_t sinceGvt = 0;
+        int idleSpins = 0;
+        for (;;) {
+            receive(lp);
+            if (gvtRequested.load(std::memory_order_acquire)) {
+                if (synchronizeGvt(lp, sync, endTime))
+                    break;
+                sinceGvt = 0;
+                continue;
+            }
+
+            if (!lp.pending.empty() && lp.pending.begin()->time <= endTime
+                && lp.pending.begin()->time <= gvt + optimismWindow) {
+                processNext(lp);
+                idleSpins = 0;
+                if (++sinceGvt >= gvtInterval)
+                    gvtRequested.store(true, std::memory_order_release);
+            }
+            else if (++idleSpins >= 64) {
+                // Nothing to do: a new GVT either frees the optimism window or ends the run.
+                gvtRequested.store(true, std::memory_order_release);
+                idleSpins = 0;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int index = 1; index < static_cast<int>(lps.size()); index++) {
+        workers.emplace_back(worker, index);
+    }
+    worker(0);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+double TimeWarpJacksonNetwork::getAverageNumberInSystem(int nodeId) const {
+    if (nodeId < 0 || nodeId >= static_cast<int>(nodes.size()))
+        return 0.0;
+    const NodeState& state = nodes[nodeId].state;
+    return (state.lastEventTime > 0) ? state.cumulativeTimeWeightedCustomers / state.lastEventTime : 0.0;
+}
+
+int TimeWarpJacksonNetwork::getTotalArrivals(int nodeId) const {
+    return (nodeId >= 0 && nodeId < static_cast<int>(nodes.size())) ? nodes[nodeId].state.totalArrivals : 0;
+}
+
+int TimeWarpJacksonNetwork::getTotalDepartures(int nodeId) const {
+    return (nodeId >= 0 && nodeId < static_cast<int>(nodes.size())) ? nodes[nodeId].state.totalDepartures : 0;
+}
+
+std::uint64_t TimeWarpJacksonNetwork::getCommittedEvents() const {
+    std::uint64_t events = 0;
+    for (const auto& lp : lps)
+        events += lp->committedEvents + lp->processed.size();
+    return events;
+}
+
+std::uint64_t TimeWarpJacksonNetwork::getRolledBackEvents() const {
+    std::uint64_t events = 0;
+    for (const auto& lp : lps)
+        events += lp->rolledBackEvents;
+    return events;
+}
+
+std::uint64_t TimeWarpJacksonNetwork::getRollbacks() const {
+    std::uint64_t rollbacks = 0;
+    for (const auto& lp : lps)
+        rollbacks += lp->rollbacks;
+    return rollbacks;
+}
+
+std::uint64_t TimeWarpJacksonNetwork::getAntiMessages() const {
+    std::uint64_t messages = 0;
+    for (const auto& lp : lps)
+        messages += lp->antiMessages;
+    return messages;
+}
+
+std::uint64_t TimeWarpJacksonNetwork::getGvtRounds() const {
+    return gvtRounds;
+}
@@ -0,0 +1,169 @@
+#ifndef TIME_WARP_JACKSON_NETWORK_H
+#define TIME_WARP_JACKSON_NETWORK_H
+
+#include "RandomStream.h"
+#include "JacksonNetwork.h"
+#include "RoutingTable.h"
+#include <vector>
+#include <deque>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <barrier>
+#include <memory>
+#include <limits>
+#include <cstdint>
+
+// TimeWarpJacksonNetwork runs a Jackson network with optimistic parallel
+// simulation (Time Warp, Jefferson 1985).
+//
+// The nodes are split among logical processes (LPs), one per thread. Each
+// LP processes its events speculatively without waiting for the others. A
+// customer that arrives from another LP with a time stamp in the LP's past
+// (a straggler) makes the LP roll back: the events after the straggler are
+// undone in reverse order, and anti-messages cancel the customers they had
+// routed to other LPs.
+//
+// State saving is incremental: an event only changes the node it happens
+// at, so only that node's state (numInSystem, busyServers, arrival and
+// departure counters, the updateMetrics accumulators and the node's random
+// stream) is saved with the event. Undoing the event restores it, which
+// also discards any metrics accumulated by rolled-back work.
+//
+// Periodically the LPs stop and compute global virtual time (GVT), the
+// earliest time any LP can still roll back to. Saved states older than GVT
+// are discarded (fossil collection). The run ends when GVT passes endTime.
+class TimeWarpJacksonNetwork {
+public:
+    // threads = 0 uses one LP per hardware core.
+    TimeWarpJacksonNetwork(unsigned threads, std::uint64_t masterSeed);
+
+    // Add nodes; node ids are numbered in order of addition.
+    int addMM1Queue(double arrivalRate, double serviceRate);
+    int addMMSQueue(double arrivalRate, double serviceRate, int servers);
+
+    // Same meaning as JacksonNetwork::setRoutingMatrix and both setRouting.
+    void setRoutingMatrix(const std::vector<std::vector<double>>& routingMatrix);
+    void setRouting(const std::vector<RoutingEntry>& entries);
+    void setRouting(RoutingTable table);
+    const RoutingTable& getRouting() const { return routing; }
+
+    // Delay between a departure and the routed arrival (default: epsilon).
+    // Unlike the conservative mode, this may be arbitrarily close to zero.
+    void setRoutingDelay(double delay);
+
+    // Number of processed events between GVT computations.
+    void setGvtInterval(std::uint64_t events);
+
+    // Limit how far (in simulated time) an LP may run ahead of GVT.
+    void setOptimismWindow(double window);
+
+    // Simulate until endTime.
+    void run(double endTime);
+
+    // Metrics of a node after run().
+    double getAverageNumberInSystem(int nodeId) const;
+    int getTotalArrivals(int nodeId) const;
+    int getTotalDepartures(int nodeId) const;
+
+    // Statistics about the last run.
+    std::uint64_t getCommittedEvents() const;
+    std::uint64_t getRolledBackEvents() const;
+    std::uint64_t getRollbacks() const;
+    std::uint64_t getAntiMessages() const;
+    std::uint64_t getGvtRounds() const;
+
+private:
+    enum class EventType : std::uint8_t { ExternalArrival, InternalArrival, Departure };
+
+    struct TimeWarpEvent {
+        double time;
+        std::uint64_t id;   // Globally unique; breaks ties between equal times.
+        int node;
+        EventType type;
+    };
+
+    struct EventOrder {
+        bool operator()(const TimeWarpEvent& a, const TimeWarpEvent& b) const {
+            return a.time < b.time || (a.time == b.time && a.id < b.id);
+        }
+    };
+
+    // State of one node that an event can change.
+    struct NodeState {
+        int numInSystem = 0;
+        int busyServers = 0;
+        int totalArrivals = 0;
+        int totalDepartures = 0;
+        double cumulativeTimeWeightedCustomers = 0.0;
+        double lastEventTime = 0.0;
+        RandomStream rng;
+    };
+
+    struct Node {
+        double arrivalRate;
+        double serviceRate;
+        int servers;
+        int lp;
+        NodeState state;
+    };
+
+    // A message between LPs: a routed customer, or an anti-message cancelling one.
+    struct Message {
+        TimeWarpEvent event;
+        bool anti;
+    };
+
+    // Record of a processed event: enough to undo it.
+    struct ProcessedEvent {
+        TimeWarpEvent event;
+        NodeState savedState;                 // State of event.node before the event.
+        TimeWarpEvent sent[2];                // Events scheduled by this event.
+        int sentCount = 0;
+    };
+
+    struct LogicalProcess {
+        int index = 0;
+        std::set<TimeWarpEvent, EventOrder> pending;
+        std::deque<ProcessedEvent> processed;
+        std::uint64_t nextId = 0;
+
+        std::mutex inboxMutex;
+        std::vector<Message> inbox;
+        std::atomic<bool> hasMail{ false };
+        std::vector<Message> received;    // Inbox contents being handled.
+
+        double localMinimum = 0.0;        // Published during GVT computation.
+        bool inboxWasEmpty = true;        // Published during GVT computation.
+
+        std::uint64_t processedEvents = 0;
+        std::uint64_t committedEvents = 0;
+        std::uint64_t rolledBackEvents = 0;
+        std::uint64_t rollbacks = 0;
+        std::uint64_t antiMessages = 0;
+    };
+
+    unsigned threads;
+    std::uint64_t masterSeed;
+    std::vector<Node> nodes;
+    RoutingTable routing;
+    double routingDelay;
+    std::uint64_t gvtInterval;
+    double optimismWindow;
+
+    std::vector<std::unique_ptr<LogicalProcess>> lps;
+    std::atomic<bool> gvtRequested;
+    double gvt;
+    std::uint64_t gvtRounds;
+
+    void build();
+    std::uint64_t newEventId(LogicalProcess& lp);
+    void send(LogicalProcess& lp, ProcessedEvent& record, const TimeWarpEvent& event);
+    void processNext(LogicalProcess& lp);
+    void rollback(LogicalProcess& lp, const TimeWarpEvent& straggler);
+    void receive(LogicalProcess& lp);
+    bool synchronizeGvt(LogicalProcess& lp, std::barrier<>& sync, double endTime);
+    double exponential(RandomStream& rng, double rate);
+};
+
+#endif // TIME_WARP_JACKSON_NETWORK_H
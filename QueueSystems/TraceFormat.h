@@ -0,0 +1,41 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <cstdint>
+
+// Layout of a binary state trace written by TraceWriter.
+//
+// The file starts with a TraceFileHeader, followed by any number of blocks.
+// Each block holds consecutive observations of one node in two columns: a
+// TraceBlockHeader, then recordCount doubles (times), then recordCount
+// int32 values (states), padded with zeros to a multiple of 8 bytes so that
+// every column stays aligned in a memory mapping. Blocks of different nodes
+// are interleaved in the order they filled up; within a node, blocks are in
+// time order. Values are stored in the machine's native byte order.
+//
+// complete is 0 while the trace is being written and is set to 1 when the
+// writer closes it with every block on disk, so a trace cut short by a
+// write error or a crash can be told apart from a finished one.
+
+const char traceMagic[8] = { 'Q', 'S', 'T', 'R', 'A', 'C', 'E', '\0' };
+const std::uint32_t traceVersion = 2;
+
+struct TraceFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nodeCount;
+    std::uint32_t blockRecords;  // Maximum records per block.
+    std::uint32_t complete;
+};
+
+struct TraceBlockHeader {
+    std::uint32_t node;
+    std::uint32_t recordCount;
+};
+
+// Bytes of the state column of a block, including padding.
+inline std::uint64_t traceStateColumnBytes(std::uint32_t recordCount) {
+    return (static_cast<std::uint64_t>(recordCount) * sizeof(std::int32_t) + 7) & ~std::uint64_t(7);
+}
+
+#endif // TRACE_FORMAT_H
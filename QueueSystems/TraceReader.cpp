@@ -0,0 +1,78 @@
+#include "TraceReader.h"
+#include <fstream>
+#include <cstring>
+
+bool TraceReader::open(const std::string& path) {
+    nodeBlocks.clear();
+    complete = false;
+    if (!file.open(path))
+        return false;
+
+    const unsigned char* data = file.data();
+    std::size_t size = file.size();
+    TraceFileHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, traceMagic, sizeof(header.magic)) != 0 || header.version != traceVersion)
+        return false;
+
+    complete = header.complete != 0;
+    nodeBlocks.resize(header.nodeCount);
+    std::size_t offset = sizeof(header);
+    while (offset < size) {
+        TraceBlockHeader block;
+        if (size - offset < sizeof(block))
+            return false;
+        std::memcpy(&block, data + offset, sizeof(block));
+        offset += sizeof(block);
+
+        std::uint64_t timeBytes = static_cast<std::uint64_t>(block.recordCount) * sizeof(double);
+        std::uint64_t stateBytes = traceStateColumnBytes(block.recordCount);
+        if (block.node >= header.nodeCount || size - offset < timeBytes + stateBytes)
+            return false;
+        const double* times = reinterpret_cast<const double*>(data + offset);
+        const std::int32_t* states = reinterpret_cast<const std::int32_t*>(data + offset + timeBytes);
+        nodeBlocks[block.node].push_back(Block{ times, states, block.recordCount });
+        offset += static_cast<std::size_t>(timeBytes + stateBytes);
+    }
+    return true;
+}
+
+std::uint32_t TraceReader::getNodeCount() const {
+    return static_cast<std::uint32_t>(nodeBlocks.size());
+}
+
+std::uint64_t TraceReader::getRecordCount(std::uint32_t node) const {
+    std::uint64_t count = 0;
+    if (node < nodeBlocks.size()) {
+        for (const Block& block : nodeBlocks[node])
+            count += block.count;
+    }
+    return count;
+}
+
+void TraceReader::read(std::uint32_t node, std::vector<double>& times, std::vector<std::int32_t>& states) const {
+    times.clear();
+    states.clear();
+    if (node >= nodeBlocks.size())
+        return;
+    for (const Block& block : nodeBlocks[node]) {
+        times.insert(times.end(), block.times, block.times + block.count);
+        states.insert(states.end(), block.states, block.states + block.count);
+    }
+}
+
+bool TraceReader::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+    out.precision(17);
+    out << "node,time,state\n";
+    for (std::uint32_t node = 0; node < nodeBlocks.size(); node++) {
+        forEach(node, [&out, node](double time, std::int32_t state) {
+            out << node << ',' << time << ',' << state << '\n';
+        });
+    }
+    return static_cast<bool>(out);
+}
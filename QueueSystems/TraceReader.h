@@ -0,0 +1,53 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include "TraceFormat.h"
+#include "MappedFile.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Reads a trace written by TraceWriter through a memory mapping. Opening
+// the file only indexes the blocks; the columns are read in place.
+class TraceReader {
+public:
+    // Map and index a trace file. Returns false if it is missing or malformed.
+    bool open(const std::string& path);
+
+    // False if the writer failed or never closed the trace, so blocks may be missing.
+    bool isComplete() const { return complete; }
+
+    std::uint32_t getNodeCount() const;
+    std::uint64_t getRecordCount(std::uint32_t node) const;
+
+    // Call f(time, state) for every observation of a node, in time order.
+    template <typename F>
+    void forEach(std::uint32_t node, F&& f) const {
+        if (node >= nodeBlocks.size())
+            return;
+        for (const Block& block : nodeBlocks[node]) {
+            for (std::uint32_t i = 0; i < block.count; i++)
+                f(block.times[i], block.states[i]);
+        }
+    }
+
+    // Copy a node's columns into vectors.
+    void read(std::uint32_t node, std::vector<double>& times, std::vector<std::int32_t>& states) const;
+
+    // Write the whole trace as CSV with columns node,time,state.
+    bool writeCsv(const std::string& path) const;
+
+private:
+    struct Block {
+        const double* times;
+        const std::int32_t* states;
+        std::uint32_t count;
+    };
+
+    MappedFile file;
+    bool complete = false;
+    std::vector<std::vector<Block>> nodeBlocks;
+};
+
+#endif // TRACE_READER_H
@@ -0,0 +1,25 @@
+#include "TraceReader.h"
+#include <iostream>
+
+// Convert a binary state trace written by TraceWriter to CSV.
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: TraceToCsv <trace file> <csv file>\n";
+        return 1;
+    }
+    TraceReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << "Error reading trace " << argv[1] << "\n";
+        return 1;
+    }
+    if (!reader.writeCsv(argv[2])) {
+        std::cerr << "Error writing " << argv[2] << "\n";
+        return 1;
+    }
+    if (!reader.isComplete()) {
+        // Convert what is there, but do not pass it off as the whole trace.
+        std::cerr << "Trace " << argv[1] << " is incomplete: the writer failed or was not closed\n";
+        return 1;
+    }
+    return 0;
+}
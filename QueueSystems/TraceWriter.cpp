@@ -0,0 +1,183 @@
+#include "TraceWriter.h"
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <cstddef>
+
+TraceWriter::TraceWriter(std::size_t ringCapacity, std::uint32_t blockRecords, std::size_t bufferBytes)
+    : mask(0), head(0), tail(0), cachedHead(0), dropped(0), waitWhenFull(false),
+    stopping(false), nodeCount(0), maxBlockRecords(blockRecords > 0 ? blockRecords : 1),
+    bufferBytes(bufferBytes), blockRecords(maxBlockRecords), written(0), failed(false), unwritten(0)
+{
+    std::size_t capacity = 2;
+    while (capacity < ringCapacity)
+        capacity *= 2;
+    ring.resize(capacity);
+    mask = capacity - 1;
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const std::string& path, std::uint32_t nodes) {
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    nodeCount = nodes;
+    // Keep the blocks of all nodes within the buffer budget.
+    std::size_t recordBytes = sizeof(double) + sizeof(std::int32_t);
+    std::size_t budgetRecords = bufferBytes / recordBytes / std::max<std::size_t>(nodeCount, 1);
+    blockRecords = static_cast<std::uint32_t>(std::clamp<std::size_t>(budgetRecords, 1, maxBlockRecords));
+
+    TraceFileHeader header{};
+    std::memcpy(header.magic, traceMagic, sizeof(header.magic));
+    header.version = traceVersion;
+    header.nodeCount = nodeCount;
+    header.blockRecords = blockRecords;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file) {
+        file.close();
+        return false;
+    }
+
+    blocks.assign(nodeCount, NodeBlock());
+    for (NodeBlock& block : blocks) {
+        block.times.reserve(blockRecords);
+        block.states.reserve(blockRecords);
+    }
+    head.store(0);
+    tail.store(0);
+    cachedHead = 0;
+    dropped = 0;
+    written.store(0);
+    failed.store(false);
+    unwritten.store(0);
+    stopping.store(false);
+    worker = std::thread(&TraceWriter::run, this);
+    return true;
+}
+
+StateObserver* TraceWriter::createObserver(std::uint32_t node) {
+    observers.push_back(std::make_unique<NodeObserver>(this, node));
+    return observers.back().get();
+}
+
+void TraceWriter::setWaitWhenFull(bool wait) {
+    waitWhenFull = wait;
+}
+
+void TraceWriter::push(const Record& record) {
+    if (!worker.joinable() || record.node >= nodeCount)
+        return;
+    std::size_t position = tail.load(std::memory_order_relaxed);
+    if (position - cachedHead > mask) {
+        // Looks full: refresh the consumer's position before giving up.
+        cachedHead = head.load(std::memory_order_acquire);
+        while (position - cachedHead > mask) {
+            if (!waitWhenFull) {
+                dropped++;
+                return;
+            }
+            std::this_thread::yield();
+            cachedHead = head.load(std::memory_order_acquire);
+        }
+    }
+    ring[position & mask] = record;
+    tail.store(position + 1, std::memory_order_release);
+}
+
+void TraceWriter::writeBlock(std::uint32_t node) {
+    NodeBlock& block = blocks[node];
+    if (block.times.empty())
+        return;
+    if (failed.load(std::memory_order_relaxed)) {
+        // The file is already broken; account for the records and move on.
+        unwritten.fetch_add(block.times.size(), std::memory_order_relaxed);
+        block.times.clear();
+        block.states.clear();
+        return;
+    }
+    TraceBlockHeader header{ node, static_cast<std::uint32_t>(block.times.size()) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(block.times.data()),
+        static_cast<std::streamsize>(block.times.size() * sizeof(double)));
+    file.write(reinterpret_cast<const char*>(block.states.data()),
+        static_cast<std::streamsize>(block.states.size() * sizeof(std::int32_t)));
+    const char padding[8] = {};
+    std::uint64_t stateBytes = block.states.size() * sizeof(std::int32_t);
+    file.write(padding, static_cast<std::streamsize>(traceStateColumnBytes(header.recordCount) - stateBytes));
+    // Flush so that a failure is seen here, not when a later block is written.
+    file.flush();
+    if (file)
+        written.fetch_add(block.times.size(), std::memory_order_relaxed);
+    else {
+        failed.store(true, std::memory_order_relaxed);
+        unwritten.fetch_add(block.times.size(), std::memory_order_relaxed);
+    }
+    block.times.clear();
+    block.states.clear();
+}
+
+void TraceWriter::drain() {
+    std::size_t begin = head.load(std::memory_order_relaxed);
+    std::size_t end = tail.load(std::memory_order_acquire);
+    for (std::size_t position = begin; position != end; position++) {
+        const Record& record = ring[position & mask];
+        NodeBlock& block = blocks[record.node];
+        block.times.push_back(record.time);
+        block.states.push_back(record.state);
+        if (block.times.size() == blockRecords)
+            writeBlock(record.node);
+    }
+    head.store(end, std::memory_order_release);
+}
+
+void TraceWriter::run() {
+    for (;;) {
+        bool stop = stopping.load(std::memory_order_acquire);
+        std::size_t before = head.load(std::memory_order_relaxed);
+        drain();
+        if (stop)
+            break;  // Everything pushed before close() has been drained.
+        if (head.load(std::memory_order_relaxed) == before)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool TraceWriter::close() {
+    if (!worker.joinable())
+        return !hasFailed();
+    stopping.store(true, std::memory_order_release);
+    worker.join();
+    for (std::uint32_t node = 0; node < nodeCount; node++)
+        writeBlock(node);
+    if (!hasFailed()) {
+        // Every block is on disk: mark the trace complete.
+        std::uint32_t complete = 1;
+        file.seekp(offsetof(TraceFileHeader, complete));
+        file.write(reinterpret_cast<const char*>(&complete), sizeof(complete));
+    }
+    file.close();
+    if (!file)
+        failed.store(true, std::memory_order_relaxed);
+    return !hasFailed();
+}
+
+bool TraceWriter::hasFailed() const {
+    return failed.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TraceWriter::getRecordsWritten() const {
+    return written.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TraceWriter::getDroppedRecords() const {
+    return dropped;
+}
+
+std::uint64_t TraceWriter::getUnwrittenRecords() const {
+    return unwritten.load(std::memory_order_relaxed);
+}
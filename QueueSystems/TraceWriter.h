@@ -0,0 +1,125 @@
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include "StateObserver.h"
+#include "TraceFormat.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+// TraceWriter records state observations of many nodes into a columnar
+// binary file (see TraceFormat.h) without doing any I/O on the simulation
+// thread.
+//
+// Each node gets a StateObserver from createObserver(). Its update() only
+// appends a record to a lock-free single-producer/single-consumer ring
+// buffer. A background thread drains the ring, groups the records into
+// per-node blocks and writes full blocks to disk.
+//
+// The blocks being filled take at most bufferBytes (12 bytes per record)
+// in all, or one record per node if there are more nodes than that: open()
+// shrinks the block size below blockRecords as the node count grows, so
+// memory does not grow with the size of the network. The ring adds
+// 16 bytes per entry of its capacity.
+//
+// If the writer thread falls behind and the ring fills up, records are
+// dropped and counted (getDroppedRecords), so the simulation never waits
+// for the disk. Call setWaitWhenFull(true) for a lossless trace at the
+// cost of stalling when the ring is full.
+//
+// If writing to the file fails (a full disk, an I/O error), the writer
+// stops writing and counts the records it could not write
+// (getUnwrittenRecords); close() then returns false and the trace is left
+// marked incomplete.
+//
+// All observers of one writer must be updated from the same thread.
+class TraceWriter {
+public:
+    // ringCapacity is rounded up to a power of two.
+    explicit TraceWriter(std::size_t ringCapacity = std::size_t(1) << 20, std::uint32_t blockRecords = 4096,
+        std::size_t bufferBytes = std::size_t(64) << 20);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Create the file and start the writer thread. Returns false if the file cannot be created.
+    bool open(const std::string& path, std::uint32_t nodeCount);
+
+    // Observer that traces the given node. Owned by the writer.
+    StateObserver* createObserver(std::uint32_t node);
+
+    // Stall instead of dropping records when the ring buffer is full.
+    void setWaitWhenFull(bool wait);
+
+    // Write out everything still buffered and close the file. Returns false
+    // if any write failed.
+    bool close();
+
+    // True once a write to the file has failed.
+    bool hasFailed() const;
+
+    std::uint64_t getRecordsWritten() const;
+    std::uint64_t getDroppedRecords() const;
+    std::uint64_t getUnwrittenRecords() const;
+
+private:
+    struct Record {
+        double time;
+        std::int32_t state;
+        std::uint32_t node;
+    };
+
+    class NodeObserver : public StateObserver {
+    public:
+        NodeObserver(TraceWriter* writer, std::uint32_t node) : writer(writer), node(node) {}
+        virtual void update(const StateData& data) override {
+            writer->push(Record{ data.time, data.state, node });
+        }
+    private:
+        TraceWriter* writer;
+        std::uint32_t node;
+    };
+
+    // Columns of the block being filled for one node.
+    struct NodeBlock {
+        std::vector<double> times;
+        std::vector<std::int32_t> states;
+    };
+
+    // Ring buffer. The producer owns tail, the consumer owns head; they sit
+    // on separate cache lines so the two threads do not false-share.
+    std::vector<Record> ring;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    std::size_t cachedHead;  // Producer's last view of head.
+    std::uint64_t dropped;   // Written by the producer only.
+    bool waitWhenFull;
+
+    alignas(64) std::atomic<bool> stopping;
+    std::thread worker;
+    std::ofstream file;
+    std::uint32_t nodeCount;
+    std::uint32_t maxBlockRecords;  // Block size asked for.
+    std::size_t bufferBytes;
+    std::uint32_t blockRecords;     // Block size of the open file.
+    std::vector<NodeBlock> blocks;
+    std::vector<std::unique_ptr<NodeObserver>> observers;
+    std::atomic<std::uint64_t> written;
+    // Set by the writer thread (or close) when a write fails; sticky until the next open.
+    std::atomic<bool> failed;
+    std::atomic<std::uint64_t> unwritten;
+
+    void push(const Record& record);
+    void drain();
+    void writeBlock(std::uint32_t node);
+    void run();
+};
+
+#endif // TRACE_WRITER_H